@@ -1,14 +1,18 @@
+#ifndef ARDUINO_HOST
 #include <Arduino.h>
 #include <Wire.h>
 #include <EEPROM.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#endif
+#include "loop_timing.h"
+#include "oled_pages.h"
+#include "button_events.h"
+#include "battery_comp.h"
+#include "motor_driver.h"
 
 // OLED Display Configuration
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
-#define OLED_RESET -1
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+SSD1306Pages display;  // page renderer, no 1 KB framebuffer (see oled_pages.h)
 
 // OLED I2C Pins
 #define OLED_SDA A4
@@ -19,7 +23,7 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 #define BUTTON_LEFT 17   // A3
 #define BUTTON_OK 5      // D5
 #define BUTTON_CANCEL 6  // D6
-#define BUTTON_EXTRA 7  // D7 (used as reset)
+#define BUTTON_EXTRA 7  // D7 (tap: start/stop line follower, hold: reset)
 
 // Multiplexer Pins
 #define MUX_A 2
@@ -32,15 +36,33 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 #define MOTOR_RIGHT_IN2 9
 #define MOTOR_LEFT_IN1 10
 #define MOTOR_LEFT_IN2 11
+// Bridges run through motor_driver.h: 20 kHz Timer1 PWM on pins 9 and 10,
+// so the right motor (IN1 on D8, no PWM) now gets real duty control too
+MotorBridge motorLeft, motorRight;
+
+// Battery sense: 20k/10k divider on A7 (analog-only pin, see battery_comp.h).
+// Motor duties are scaled to BATTERY_NOMINAL_MV so baseSpeed and the gain
+// table behave the same on a full and on a nearly flat pack.
+#define BATTERY_SENSE A7
+#define BATTERY_FULL_SCALE_MV 15000
+#define BATTERY_SAMPLE_MS 20
+BatteryComp battery;
+
+// Wheel Encoder Pins (quadrature, pin-change interrupts)
+// D0/D1 are free because this sketch does not use Serial
+#define ENC_LEFT_A A1
+#define ENC_LEFT_B 13
+#define ENC_RIGHT_A 0
+#define ENC_RIGHT_B 1
 
 // Buzzer Pin
 #define BUZZER 12
 
 // Menu States
-enum MenuState { MAIN_MENU, NAVIGASI, LINE_FOLLOWER, PID_KONTROL };
+enum MenuState { MAIN_MENU, NAVIGASI, LINE_FOLLOWER, PID_KONTROL, DIAGNOSTIK };
 MenuState currentMenu = MAIN_MENU;
 int selectedBox = 0;
-const int totalBox = 3; // Including PID Control menu
+const int totalBox = 4; // Including PID Control and Diagnostics menus
 bool inSubMenu = false;
 int subMenuIndex = 0;
 bool isLoading = true;
@@ -67,26 +89,241 @@ int pwmLeft = 150;
 int pwmRight = 150;
 int baseSpeed = 120;
 bool running = false;
-byte activeParam = 0;// Save PID parameters to EEPROM
+
+// Wheel Speed Loop (inner PI under the line PID)
+#define WHEEL_LEFT 0
+#define WHEEL_RIGHT 1
+const float MM_PER_TICK = 0.25;            // wheel circumference / (CPR x 4)
+const float TICKS_PER_SEC_PER_PWM = 20.0;  // feedforward scale, ticks/s per PWM step
+const unsigned long SPEED_SAMPLE_US = 10000;
+const int8_t quadTable[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+const int8_t encoderDir[2] = {1, -1};
+
+volatile long encoderTicks[2] = {0, 0};
+volatile uint8_t encoderState[2] = {0, 0};
+volatile uint8_t* encoderPort[4];
+uint8_t encoderMask[4];
+
+// Button event queue, fed by the pin-change ISRs
+enum { BTN_RIGHT, BTN_LEFT, BTN_OK, BTN_CANCEL, BTN_EXTRA, BTN_COUNT };
+const uint8_t buttonPins[BTN_COUNT] = {BUTTON_RIGHT, BUTTON_LEFT, BUTTON_OK, BUTTON_CANCEL, BUTTON_EXTRA};
+volatile uint8_t* buttonPort[BTN_COUNT];
+uint8_t buttonMask[BTN_COUNT];
+ButtonQueue buttons;
+
+struct WheelLoop {
+  double Kp = 0.8;
+  double Ki = 6.0;
+  long lastTicks = 0;
+  double speed = 0;     // measured, PWM-equivalent units
+  double integral = 0;
+  int duty = 0;
+} wheels[2];
+unsigned long lastSpeedSampleUs = 0;
+unsigned long lastWheelLoopUs = 0;
+
+// Speed-scheduled PID gains: one Kp/Ki/Kd row per base-speed breakpoint,
+// for straight (band 0) and curved (band 1) track. The controller
+// interpolates between rows and bands every tick and writes pid.Kp/Ki/Kd.
+#define GAIN_ROWS 4
+#define GAIN_BANDS 2
+#define GAIN_CELLS (GAIN_BANDS * GAIN_ROWS * 3)
+#define EEPROM_GAIN_TABLE 512   // above the route area that starts at 0
+#define ROUTE_LEN 200           // route steps kept in EEPROM (ints from address 0, below the gain table)
+#define GAIN_TABLE_MAGIC 0x47
+
+// Checkpoints are bars across the line (all sensors black for CP_BAR_MIN_MM of travel),
+// counted during line-follower runs
+#define CP_BAR_MIN_MM 15
+byte checkpointsPassed = 0;  // live count for the current run
+double barStartMm = -1;      // distance where the current full-width bar began
+bool barCounted = false;
+
+// Fast boot: the active menu is kept in EEPROM so a reset (brown-out, reset button)
+// comes straight back to it instead of sitting through the ~5.6 s splash. The splash
+// only plays on the first power-up (the .noinit marker is random after power loss)
+// or when OK is held during reset, which also skips the resume and opens the main menu.
+#define EEPROM_BOOT_STATE 1000  // near the end of the 1 KB EEPROM, clear of the gain table
+#define BOOT_STATE_MAGIC 0x42
+#define WARM_BOOT_MAGIC 0xB0075AFEUL
+uint32_t warmBootMarker __attribute__((section(".noinit")));
+
+struct BootState {
+  int16_t baseSpeed;
+  byte magic;
+  byte menu;
+  byte selectedBox;
+  byte subMenuIndex;
+  byte navMode;
+  byte running;
+};
+BootState savedBoot;
+const int gainSpeeds[GAIN_ROWS] = {80, 120, 160, 200};
+#define GAIN_CELL_SPEED GAIN_CELLS  // extra cell after the table: baseSpeed itself
+#define BASE_SPEED_STEP 5
+const char* const gainBandNames[GAIN_BANDS] = {"LURUS", "BELOK"};
+const double GAIN_CURVE_FULL = 1500;  // filtered |error| at which the curve band fully applies
+const double defaultGains[GAIN_ROWS][3] = {
+  {12.0, 0.50, 4.0},
+  {10.0, 0.50, 5.0},
+  {8.0, 0.40, 6.0},
+  {6.5, 0.30, 7.0},
+};
+double gainTable[GAIN_BANDS][GAIN_ROWS][3];
+double curvature = 0;  // low-passed |error|, selects the gain band
+byte gainCell = 0;     // cell being edited in the table view: band, row, column, or GAIN_CELL_SPEED
+
+// Loop timing per stage (micros), shown on the DIAGNOSTIK page.
+// This sketch has no Serial (D0/D1 are encoder inputs), so the page is the only readout.
+enum { ST_SENSING, ST_PID, ST_MOTOR, ST_DISPLAY, ST_MENU, ST_LOOP, ST_COUNT };
+const char* const stageNames[ST_COUNT] = {"SENS", "PID", "MOTR", "DISP", "MENU", "LOOP"};
+StageTiming loopTiming[ST_COUNT];
+unsigned long stageStartUs = 0;
+
+// Prototypes (the Arduino IDE generates these; the host build needs them)
+void applyGainSchedule();
+double distanceTravelled();
+void playButtonTone();
+void setRunning(bool on);
+void setupButtons();
+void setupEncoders();
+void handleButton(const ButtonEvent& ev);
+void tampilLoading();
+void tampilkanNamaKelompok();
+void tampilMainMenu();
+void tampilSubMenu();
+void tampilMenuNavigasi();
+void tampilLineFollower();
+void tampilPidKontrol();
+void tampilDiagnostik();
+void updateLineFollower();
+void updateMotors();
+void brakeMotors();
+void updateWheelSpeeds();
+void pollBattery();
+void recallRoute();
+void followLeftPath();
+void followRightPath();
+bool reachedFinish();
+bool reachedStart();
+bool detectLeftLine();
+bool detectRightLine();
+void moveForward();
+void turnLeft();
+void turnRight();
+void stopMotor();
+
+// Close the current stage: time since the previous marker goes to `stage`
+void markStage(byte stage) {
+  unsigned long now = micros();
+  timing_record(&loopTiming[stage], now - stageStartUs);
+  stageStartUs = now;
+}
+
+void resetLoopTiming() {
+  for (byte i = 0; i < ST_COUNT; i++) timing_reset(&loopTiming[i]);
+}
+
+// Save PID gain table to EEPROM
 void savePIDToEEPROM() {
-  EEPROM.put(0, pid.Kp);
-  EEPROM.put(8, pid.Ki);
-  EEPROM.put(16, pid.Kd);
+  EEPROM.put(EEPROM_GAIN_TABLE, (byte)GAIN_TABLE_MAGIC);
+  EEPROM.put(EEPROM_GAIN_TABLE + 1, gainTable);
+}
+
+// Fill the table with defaults; the curve band gets 20% more Kp
+void defaultGainTable() {
+  for (byte r = 0; r < GAIN_ROWS; r++) {
+    for (byte k = 0; k < 3; k++) {
+      gainTable[0][r][k] = defaultGains[r][k];
+      gainTable[1][r][k] = defaultGains[r][k] * (k == 0 ? 1.2 : 1.0);
+    }
+  }
 }
 
-// Read PID parameters from EEPROM
+// Read PID gain table from EEPROM, defaults if it was never written
 void readPIDFromEEPROM() {
-  pid.Kp = EEPROM.get(0, pid.Kp);
-  pid.Ki = EEPROM.get(8, pid.Ki);
-  pid.Kd = EEPROM.get(16, pid.Kd);
+  byte magic = 0;
+  EEPROM.get(EEPROM_GAIN_TABLE, magic);
+  if (magic == GAIN_TABLE_MAGIC) {
+    EEPROM.get(EEPROM_GAIN_TABLE + 1, gainTable);
+  } else {
+    defaultGainTable();
+  }
+  applyGainSchedule();
 }
 
 // Reset PID parameters to default values
 void resetPID() {
-  pid.Kp = 10.0;
-  pid.Ki = 0.5;
-  pid.Kd = 5.0;
+  defaultGainTable();
   savePIDToEEPROM(); // Save default PID values to EEPROM
+  applyGainSchedule();
+}
+
+// Interpolate pid.Kp/Ki/Kd from the table for the current baseSpeed and curvature
+void applyGainSchedule() {
+  byte i = 0;
+  while (i < GAIN_ROWS - 2 && baseSpeed > gainSpeeds[i + 1]) i++;
+  double s = constrain((double)(baseSpeed - gainSpeeds[i]) / (gainSpeeds[i + 1] - gainSpeeds[i]), 0.0, 1.0);
+  double c = constrain(curvature / GAIN_CURVE_FULL, 0.0, 1.0);
+  double* out[3] = {&pid.Kp, &pid.Ki, &pid.Kd};
+  for (byte k = 0; k < 3; k++) {
+    double straight = gainTable[0][i][k] + s * (gainTable[0][i + 1][k] - gainTable[0][i][k]);
+    double curved = gainTable[1][i][k] + s * (gainTable[1][i + 1][k] - gainTable[1][i][k]);
+    *out[k] = straight + c * (curved - straight);
+  }
+}
+
+// Step the selected table cell up or down (Ki in finer steps). The base speed cell
+// moves baseSpeed along the table's speed axis; it is kept with the boot state.
+void adjustGainCell(int direction) {
+  if (gainCell == GAIN_CELL_SPEED) {
+    baseSpeed = constrain(baseSpeed + direction * BASE_SPEED_STEP, gainSpeeds[0], gainSpeeds[GAIN_ROWS - 1]);
+    applyGainSchedule();
+    return;
+  }
+  byte band = gainCell / (GAIN_ROWS * 3);
+  byte row = (gainCell / 3) % GAIN_ROWS;
+  byte col = gainCell % 3;
+  double step = (col == 1) ? 0.01 : 0.1;
+  gainTable[band][row][col] = max(0.0, gainTable[band][row][col] + direction * step);
+  savePIDToEEPROM();
+  applyGainSchedule();
+}
+
+// Snapshot of the state that a warm reset should come back to
+BootState currentBootState() {
+  BootState b;
+  b.magic = BOOT_STATE_MAGIC;
+  b.menu = currentMenu;
+  b.selectedBox = selectedBox;
+  b.subMenuIndex = subMenuIndex;
+  b.navMode = currentNavigasiMode;
+  b.running = running;
+  b.baseSpeed = baseSpeed;
+  return b;
+}
+
+// Write the boot state only when it changed, so EEPROM wear follows menu changes, not loops
+void saveBootState() {
+  BootState b = currentBootState();
+  if (memcmp(&b, &savedBoot, sizeof(b)) == 0) return;
+  EEPROM.put(EEPROM_BOOT_STATE, b);
+  savedBoot = b;
+}
+
+// Restore the last menu; a run is only resumed after a warm reset, never on power-up
+void restoreBootState(bool coldBoot) {
+  BootState b;
+  EEPROM.get(EEPROM_BOOT_STATE, b);
+  if (b.magic != BOOT_STATE_MAGIC || b.menu > DIAGNOSTIK) return;
+  currentMenu = (MenuState)b.menu;
+  selectedBox = constrain(b.selectedBox, 0, totalBox - 1);
+  subMenuIndex = b.subMenuIndex % 6;
+  currentNavigasiMode = b.navMode == LINE_MASS ? LINE_MASS : FOLLOW_LINE;
+  baseSpeed = constrain(b.baseSpeed, gainSpeeds[0], gainSpeeds[GAIN_ROWS - 1]);
+  running = b.running && !coldBoot && currentMenu == LINE_FOLLOWER;
+  savedBoot = b;
+  applyGainSchedule();
 }
 
 // Save route data to EEPROM
@@ -108,28 +345,55 @@ void resetRouteInEEPROM(int size) {
   for (int i = 0; i < size; i++) {
     EEPROM.put(i * sizeof(int), 0); // Reset all route data to 0
   }
+}
+
+// Track event: a full-width bar held for CP_BAR_MIN_MM counts once
+bool detectCheckpoint() {
+  for (int i = 0; i < numSensors; i++) {
+    if (!sensorValues[i]) {
+      barStartMm = -1;
+      barCounted = false;
+      return false;
+    }
+  }
+  double mm = distanceTravelled();
+  if (barStartMm < 0) barStartMm = mm;
+  if (barCounted || mm - barStartMm < CP_BAR_MIN_MM) return false;
+  barCounted = true;
+  return true;
+}
+
+void onCheckpoint() {
+  checkpointsPassed++;
+  playButtonTone();
 }void setup() {
+  bool coldBoot = warmBootMarker != WARM_BOOT_MAGIC;
+  warmBootMarker = WARM_BOOT_MAGIC;
+
   // Initialize button pins with internal pull-up resistors
   pinMode(BUTTON_RIGHT, INPUT_PULLUP);
   pinMode(BUTTON_LEFT, INPUT_PULLUP);
   pinMode(BUTTON_OK, INPUT_PULLUP);
   pinMode(BUTTON_CANCEL, INPUT_PULLUP);
-  pinMode(BUTTON_EXTRA, INPUT_PULLUP); // Reset button on D7
+  pinMode(BUTTON_EXTRA, INPUT_PULLUP); // Start/stop (tap) and reset (hold) on D7
 
   // Initialize multiplexer pins
   pinMode(MUX_A, OUTPUT);
   pinMode(MUX_B, OUTPUT);
   pinMode(MUX_C, OUTPUT);
 
-  // Initialize motor driver pins
-  pinMode(MOTOR_RIGHT_IN1, OUTPUT);
-  pinMode(MOTOR_RIGHT_IN2, OUTPUT);
-  pinMode(MOTOR_LEFT_IN1, OUTPUT);
-  pinMode(MOTOR_LEFT_IN2, OUTPUT);
+  // Initialize motor driver pins and 20 kHz PWM
+  motor_timer_init();
+  motor_init(&motorRight, MOTOR_RIGHT_IN1, MOTOR_RIGHT_IN2);
+  motor_init(&motorLeft, MOTOR_LEFT_IN1, MOTOR_LEFT_IN2);
 
   // Initialize buzzer pin
   pinMode(BUZZER, OUTPUT);
 
+  // Initialize button interrupts and wheel encoders
+  setupButtons();
+  setupEncoders();
+
   // Initialize OLED display
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
     for (;;); // Halt if display initialization fails
@@ -138,96 +402,35 @@ void resetRouteInEEPROM(int size) {
   display.setTextColor(SSD1306_WHITE);
   display.dim(false);
 
-  // Play startup tone and show loading screen
-  playButtonTone();
-  tampilLoading();
+  battery_init(&battery, BATTERY_FULL_SCALE_MV, BATTERY_NOMINAL_MV);
+  battery_sample(&battery, analogRead(BATTERY_SENSE));
 
   // Load PID values from EEPROM
   readPIDFromEEPROM();
+  resetLoopTiming();
+
+  // Splash only on power-up or when OK is held; otherwise resume right away
+  bool splashRequested = digitalRead(BUTTON_OK) == LOW;
+  if (coldBoot || splashRequested) {
+    playButtonTone();
+    tampilLoading();  // a held OK is ignored by the queue until it is released
+  }
+  isLoading = false;
+  if (!splashRequested) restoreBootState(coldBoot);
 }
 
 void loop() {
-  static bool lastRight = HIGH, lastLeft = HIGH, lastOK = HIGH, lastCancel = HIGH, lastExtra = HIGH;
-  static unsigned long lastButtonTime = 0;
-  const unsigned long debounceDelay = 200;
-
-  // Read button states
-  bool currentRight = digitalRead(BUTTON_RIGHT);
-  bool currentLeft = digitalRead(BUTTON_LEFT);
-  bool currentOK = digitalRead(BUTTON_OK);
-  bool currentCancel = digitalRead(BUTTON_CANCEL);
-  bool currentExtra = digitalRead(BUTTON_EXTRA);
   unsigned long currentTime = millis();
+  unsigned long loopStartUs = stageStartUs = micros();
+  ButtonEvent ev;
 
   display.clearDisplay();
 
-  // Handle RIGHT button (navigate forward or increase PID)
-  if (currentRight == LOW && lastRight == HIGH && currentTime - lastButtonTime > debounceDelay) {
-    playButtonTone();
-    if (currentMenu == MAIN_MENU) {
-      selectedBox = (selectedBox + 1) % totalBox;
-    } else if (currentMenu == NAVIGASI && inSubMenu) {
-      subMenuIndex = (subMenuIndex + 1) % 6;
-    } else if (currentMenu == PID_KONTROL) {
-      double increment = (activeParam == 1) ? 0.01 : 0.1;
-      if (activeParam == 0) pid.Kp += increment;
-      else if (activeParam == 1) pid.Ki += increment;
-      else pid.Kd += increment;
-      savePIDToEEPROM();
-    }
-    lastButtonTime = currentTime;
-  }
-
-  // Handle LEFT button (navigate backward or decrease PID)
-  if (currentLeft == LOW && lastLeft == HIGH && currentTime - lastButtonTime > debounceDelay) {
-    playButtonTone();
-    if (currentMenu == MAIN_MENU) {
-      selectedBox = (selectedBox - 1 + totalBox) % totalBox;
-    } else if (currentMenu == NAVIGASI && inSubMenu) {
-      subMenuIndex = (subMenuIndex - 1 + 6) % 6;
-    } else if (currentMenu == PID_KONTROL) {
-      double decrement = (activeParam == 1) ? 0.01 : 0.1;
-      if (activeParam == 0) pid.Kp = max(0.0, pid.Kp - decrement);
-      else if (activeParam == 1) pid.Ki = max(0.0, pid.Ki - decrement);
-      else pid.Kd = max(0.0, pid.Kd - decrement);
-      savePIDToEEPROM();
-    }
-    lastButtonTime = currentTime;
-  }
-
-  // Handle OK button (select menu or cycle PID parameter)
-  if (currentOK == LOW && lastOK == HIGH && currentTime - lastButtonTime > debounceDelay) {
-    playButtonTone();
-    if (currentMenu == MAIN_MENU) {
-      if (selectedBox == 0) currentMenu = NAVIGASI;
-      else if (selectedBox == 1) currentMenu = LINE_FOLLOWER;
-      else if (selectedBox == 2) currentMenu = PID_KONTROL;
-    } else if (currentMenu == NAVIGASI && subMenuIndex == 2) {
-      inSubMenu = true;
-    } else if (currentMenu == PID_KONTROL) {
-      activeParam = (activeParam + 1) % 3;
-    }
-    lastButtonTime = currentTime;
+  while (button_next(&buttons, (uint16_t)currentTime, &ev)) {
+    handleButton(ev);
   }
 
-  // Handle CANCEL button (exit submenu or return to main menu)
-  if (currentCancel == LOW && lastCancel == HIGH && currentTime - lastButtonTime > debounceDelay) {
-    playButtonTone();
-    if (currentMenu == NAVIGASI && inSubMenu) {
-      inSubMenu = false;
-    } else if (currentMenu != MAIN_MENU) {
-      currentMenu = MAIN_MENU;
-    }
-    lastButtonTime = currentTime;
-  }
-
-  // Handle EXTRA button (reset PID and route)
-  if (currentExtra == LOW && lastExtra == HIGH && currentTime - lastButtonTime > debounceDelay) {
-    playButtonTone();
-    resetPID();
-    resetRouteInEEPROM(100); // Reset stored route in EEPROM
-    lastButtonTime = currentTime;
-  }
+  markStage(ST_MENU);
 
   // Update display based on current menu
   switch (currentMenu) {
@@ -242,6 +445,7 @@ void loop() {
       if (running) {
         updateLineFollower();
         updateMotors();
+        markStage(ST_MOTOR);
       } else {
         display.setCursor(10, SCREEN_HEIGHT - 20);
         display.print(F("Press EXTRA to start"));
@@ -251,17 +455,111 @@ void loop() {
     case PID_KONTROL:
       tampilPidKontrol();
       break;
+    case DIAGNOSTIK:
+      tampilDiagnostik();
+      break;
   }
 
-  // Update button states
-  lastRight = currentRight;
-  lastLeft = currentLeft;
-  lastOK = currentOK;
-  lastCancel = currentCancel;
-  lastExtra = currentExtra;
-
   display.display();
-}void playButtonTone() {
+  markStage(ST_DISPLAY);
+  saveBootState();
+  timing_record(&loopTiming[ST_LOOP], micros() - loopStartUs);
+}
+
+// Menu actions for one debounced button event. Holding RIGHT/LEFT repeats,
+// so gains can be swept quickly.
+void handleButton(const ButtonEvent& ev) {
+  bool repeat = ev.type == BUTTON_LONG || ev.type == BUTTON_REPEAT;
+  // A short EXTRA tap starts or stops the line follower; a hold still resets (below)
+  if (ev.type == BUTTON_RELEASE && ev.button == BTN_EXTRA && currentMenu == LINE_FOLLOWER &&
+      ev.held < buttons.long_ms) {
+    setRunning(!running);
+    playButtonTone();
+    return;
+  }
+  if (ev.type == BUTTON_RELEASE) return;
+
+  switch (ev.button) {
+    // Navigate forward or increase PID
+    case BTN_RIGHT:
+      if (currentMenu == MAIN_MENU) {
+        if (!repeat) selectedBox = (selectedBox + 1) % totalBox;
+      } else if (currentMenu == NAVIGASI && inSubMenu) {
+        if (!repeat) subMenuIndex = (subMenuIndex + 1) % 6;
+      } else if (currentMenu == NAVIGASI) {
+        if (!repeat) subMenuIndex = (subMenuIndex + 1) % 3;
+      } else if (currentMenu == PID_KONTROL) {
+        adjustGainCell(1);
+      }
+      break;
+
+    // Navigate backward or decrease PID
+    case BTN_LEFT:
+      if (currentMenu == MAIN_MENU) {
+        if (!repeat) selectedBox = (selectedBox - 1 + totalBox) % totalBox;
+      } else if (currentMenu == NAVIGASI && inSubMenu) {
+        if (!repeat) subMenuIndex = (subMenuIndex - 1 + 6) % 6;
+      } else if (currentMenu == NAVIGASI) {
+        if (!repeat) subMenuIndex = (subMenuIndex - 1 + 3) % 3;
+      } else if (currentMenu == PID_KONTROL) {
+        adjustGainCell(-1);
+      }
+      break;
+
+    // Select menu or move to the next gain table cell
+    case BTN_OK:
+      if (repeat) return;
+      if (currentMenu == MAIN_MENU) {
+        if (selectedBox == 0) currentMenu = NAVIGASI;
+        else if (selectedBox == 1) currentMenu = LINE_FOLLOWER;
+        else if (selectedBox == 2) currentMenu = PID_KONTROL;
+        else if (selectedBox == 3) currentMenu = DIAGNOSTIK;
+      } else if (currentMenu == NAVIGASI && subMenuIndex == 2) {
+        inSubMenu = true;
+      } else if (currentMenu == PID_KONTROL) {
+        gainCell = (gainCell + 1) % (GAIN_CELLS + 1);
+      } else if (currentMenu == DIAGNOSTIK) {
+        resetLoopTiming();
+      }
+      break;
+
+    // Exit submenu or return to main menu
+    case BTN_CANCEL:
+      if (repeat) return;
+      if (currentMenu == NAVIGASI && inSubMenu) {
+        inSubMenu = false;
+      } else if (currentMenu != MAIN_MENU) {
+        if (running) setRunning(false);
+        currentMenu = MAIN_MENU;
+      }
+      break;
+
+    // Hold to reset PID and route, so a stray tap cannot wipe them
+    case BTN_EXTRA:
+      if (ev.type != BUTTON_LONG) return;
+      resetPID();
+      resetRouteInEEPROM(ROUTE_LEN); // Reset stored route in EEPROM
+      break;
+  }
+  playButtonTone();
+}
+
+// Start from a clean PID state and checkpoint count; stopping holds the brake
+void setRunning(bool on) {
+  running = on;
+  if (on) {
+    pid.integral = 0;
+    pid.lastError = 0;
+    checkpointsPassed = 0;
+    barStartMm = -1;
+    barCounted = false;
+    lastWheelLoopUs = micros();
+  } else {
+    brakeMotors();
+  }
+}
+
+void playButtonTone() {
   tone(BUZZER, 1000, 50);
 }
 
@@ -311,40 +609,51 @@ void tampilMainMenu() {
   display.setTextColor(SSD1306_WHITE);
   display.setCursor(40, 0);
   display.print("MAIN MENU");
-  display.drawLine(0, 10, SCREEN_WIDTH - 1, 10, SSD1306_WHITE);
+  display.drawLine(0, 9, SCREEN_WIDTH - 1, 9, SSD1306_WHITE);
 
   // Menu Line Mass
   if (selectedBox == 0) {
-    display.fillRect(20, 15, 88, 15, SSD1306_WHITE);
+    display.fillRect(20, 12, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_BLACK);
   } else {
-    display.drawRect(20, 15, 88, 15, SSD1306_WHITE);
+    display.drawRect(20, 12, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_WHITE);
   }
-  display.setCursor(40, 18);
+  display.setCursor(40, 14);
   display.print("LINE MASS");
 
   // Mode Line Follower
   if (selectedBox == 1) {
-    display.fillRect(20, 32, 88, 15, SSD1306_WHITE);
+    display.fillRect(20, 25, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_BLACK);
   } else {
-    display.drawRect(20, 32, 88, 15, SSD1306_WHITE);
+    display.drawRect(20, 25, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_WHITE);
   }
-  display.setCursor(25, 35);
+  display.setCursor(25, 27);
   display.print("LINE FOLLOWER");
 
   // Mode PID Control
   if (selectedBox == 2) {
-    display.fillRect(20, 49, 88, 15, SSD1306_WHITE);
+    display.fillRect(20, 38, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_BLACK);
   } else {
-    display.drawRect(20, 49, 88, 15, SSD1306_WHITE);
+    display.drawRect(20, 38, 88, 12, SSD1306_WHITE);
     display.setTextColor(SSD1306_WHITE);
   }
-  display.setCursor(30, 52);
+  display.setCursor(30, 40);
   display.print("PID KONTROL");
+
+  // Diagnostics (loop timing)
+  if (selectedBox == 3) {
+    display.fillRect(20, 51, 88, 12, SSD1306_WHITE);
+    display.setTextColor(SSD1306_BLACK);
+  } else {
+    display.drawRect(20, 51, 88, 12, SSD1306_WHITE);
+    display.setTextColor(SSD1306_WHITE);
+  }
+  display.setCursor(34, 53);
+  display.print("DIAGNOSTIK");
 }
 
 void tampilKonfirmasiMode(String mode) {
@@ -370,24 +679,89 @@ void tampilSubMenu() {
   display.display();
 }
 
+// Gain table view: one band at a time, rows = base-speed breakpoints.
+// The base speed the schedule interpolates at is the last cell, top right.
 void tampilPidKontrol() {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
-  display.setCursor(35, 0);
-  display.print("PID KONTROL");
+
+  byte band = gainCell == GAIN_CELL_SPEED ? 0 : gainCell / (GAIN_ROWS * 3);
+  display.setCursor(0, 0);
+  display.print("PID ");
+  display.print(gainBandNames[band]);
 
   const char* params[] = {"Kp", "Ki", "Kd"};
-  double* values[] = {&pid.Kp, &pid.Ki, &pid.Kd};
   const byte decimals[] = {2, 3, 2};
+  const byte columnX[] = {24, 60, 96};
+  bool speedSelected = gainCell == GAIN_CELL_SPEED;
+  display.setCursor(columnX[1], 0);
+  display.print("Base");
+  display.fillRect(columnX[2] - 1, -1, 32, 10, speedSelected ? SSD1306_WHITE : SSD1306_BLACK);
+  display.setTextColor(speedSelected ? SSD1306_BLACK : SSD1306_WHITE);
+  display.setCursor(columnX[2], 0);
+  display.print(baseSpeed);
+  display.setTextColor(SSD1306_WHITE);
+  display.setCursor(0, 12);
+  display.print("Spd");
+  for (byte k = 0; k < 3; k++) {
+    display.setCursor(columnX[k], 12);
+    display.print(params[k]);
+  }
 
-  for (byte i = 0; i < 3; i++) {
-    int yOffset = 15 + (i * 12);
-    display.setCursor(10, yOffset);
-    display.print(i == activeParam ? "> " : "  ");
-    display.print(params[i]);
-    display.print(": ");
-    display.print(*values[i], decimals[i]);
+  for (byte r = 0; r < GAIN_ROWS; r++) {
+    int yOffset = 22 + (r * 10);
+    display.setTextColor(SSD1306_WHITE);
+    display.setCursor(0, yOffset);
+    display.print(gainSpeeds[r]);
+    for (byte k = 0; k < 3; k++) {
+      bool selected = gainCell == (band * GAIN_ROWS + r) * 3 + k;
+      display.fillRect(columnX[k] - 1, yOffset - 1, 32, 10, selected ? SSD1306_WHITE : SSD1306_BLACK);
+      display.setTextColor(selected ? SSD1306_BLACK : SSD1306_WHITE);
+      display.setCursor(columnX[k], yOffset);
+      display.print(gainTable[band][r][k], decimals[k]);
+    }
+  }
+}
+
+// Print a duration in at most 5 characters: microseconds, or milliseconds with an 'm' suffix
+void printDuration(unsigned long us) {
+  if (us < 10000) {
+    display.print(us);
+  } else {
+    display.print(us / 1000);
+    display.print('m');
+  }
+}
+
+// Loop timing table: min / p99 / max per stage in microseconds. OK clears it.
+void tampilDiagnostik() {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  const byte columnX[] = {26, 60, 94};
+  display.setCursor(0, 0);
+  display.print("us");
+  display.setCursor(columnX[0], 0);
+  display.print("min");
+  display.setCursor(columnX[1], 0);
+  display.print("p99");
+  display.setCursor(columnX[2], 0);
+  display.print("max");
+
+  for (byte i = 0; i < ST_COUNT; i++) {
+    const StageTiming& t = loopTiming[i];
+    int yOffset = 9 + i * 9;
+    display.setCursor(0, yOffset);
+    display.print(stageNames[i]);
+    if (t.count == 0) continue;
+    display.setCursor(columnX[0], yOffset);
+    printDuration(t.min);
+    display.setCursor(columnX[1], yOffset);
+    printDuration(timing_percentile(&t, 99));
+    display.setCursor(columnX[2], yOffset);
+    printDuration(t.max);
   }
 }
 
@@ -396,10 +770,10 @@ void tampilMenuNavigasi() {
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
 
-  // Show progress
+  // Checkpoints passed in the last line-follower run
   display.setCursor(0, 0);
-  display.print("Progress: ");
-  display.print("100%");
+  display.print("CP: ");
+  display.print(checkpointsPassed);
 
   // Display navigation mode options
   display.setTextColor(subMenuIndex == 0 ? SSD1306_BLACK : SSD1306_WHITE);
@@ -408,7 +782,6 @@ void tampilMenuNavigasi() {
   display.print("START CP");
 
   display.setTextSize(2);
-  display.setTextColor(SSD1306_WHITE);
   display.setCursor(15, 18);
   display.print("00");
 
@@ -423,8 +796,8 @@ void tampilMenuNavigasi() {
   display.fillRect(65, 23, 60, 12, subMenuIndex == 2 ? SSD1306_WHITE : SSD1306_BLACK);
   display.setCursor(67, 25);
   display.print("Cari Rute");
-}void updateLineFollower() {
-  // Read sensor values from multiplexer
+}// Read sensor values from multiplexer
+void readLineSensors() {
   for (int i = 0; i < numSensors; i++) {
     digitalWrite(MUX_A, (i & 0x01) ? HIGH : LOW);
     digitalWrite(MUX_B, (i & 0x02) ? HIGH : LOW);
@@ -432,6 +805,12 @@ void tampilMenuNavigasi() {
     delayMicroseconds(10);
     sensorValues[i] = analogRead(MUX_COM) > 500 ? 1 : 0;
   }
+}
+
+void updateLineFollower() {
+  readLineSensors();
+  if (detectCheckpoint()) onCheckpoint();
+  markStage(ST_SENSING);
 
   // Calculate line position
   int sum = 0, count = 0;
@@ -445,6 +824,10 @@ void tampilMenuNavigasi() {
   int linePosition = count > 0 ? sum / count : 3500;
   pid.error = linePosition - 3500;
 
+  // Pick gains for this tick from the speed/curvature schedule
+  curvature += 0.2 * (fabs(pid.error) - curvature);
+  applyGainSchedule();
+
   // Update PID calculations
   pid.integral += pid.error;
   pid.derivative = pid.error - pid.lastError;
@@ -454,25 +837,139 @@ void tampilMenuNavigasi() {
   // Adjust motor speeds
   pwmLeft = constrain(baseSpeed + (int)output, 0, 255);
   pwmRight = constrain(baseSpeed - (int)output, 0, 255);
+  markStage(ST_PID);
 }
 
 void updateMotors() {
-  // Control right motor
-  if (pwmRight > 0) {
-    analogWrite(MOTOR_RIGHT_IN1, pwmRight);
-    digitalWrite(MOTOR_RIGHT_IN2, LOW);
-  } else {
-    digitalWrite(MOTOR_RIGHT_IN1, LOW);
-    digitalWrite(MOTOR_RIGHT_IN2, LOW);
+  // Inner wheel speed loop: pwmLeft/pwmRight are the speed targets
+  updateWheelSpeeds();
+  pollBattery();
+  int targets[2] = {pwmLeft, pwmRight};
+  unsigned long now = micros();
+  double dt = (now - lastWheelLoopUs) * 1e-6;
+  lastWheelLoopUs = now;
+  if (dt > 0.05) dt = 0.05;
+
+  for (int w = 0; w < 2; w++) {
+    WheelLoop& wl = wheels[w];
+    if (targets[w] <= 0) {
+      wl.integral = 0;
+      wl.duty = 0;
+      continue;
+    }
+    double e = targets[w] - wl.speed;
+    double out = targets[w] + wl.Kp * e + wl.integral;
+    // Anti-windup: only integrate while the output is not saturated in the same direction
+    if (!((out >= 255 && e > 0) || (out <= 0 && e < 0))) {
+      wl.integral += wl.Ki * e * dt;
+    }
+    wl.duty = constrain((int)out, 0, 255);
   }
 
-  // Control left motor
-  if (pwmLeft > 0) {
-    analogWrite(MOTOR_LEFT_IN1, pwmLeft);
-    digitalWrite(MOTOR_LEFT_IN2, LOW);
-  } else {
-    digitalWrite(MOTOR_LEFT_IN1, LOW);
-    digitalWrite(MOTOR_LEFT_IN2, LOW);
+  // Drive both motors (duty compensated for battery voltage, 0 = coast)
+  motor_drive(&motorRight, battery_duty(&battery, wheels[WHEEL_RIGHT].duty));
+  motor_drive(&motorLeft, battery_duty(&battery, wheels[WHEEL_LEFT].duty));
+}
+
+// Active brake: both bridge inputs high, held until the next drive command
+void brakeMotors() {
+  for (int w = 0; w < 2; w++) {
+    wheels[w].integral = 0;
+    wheels[w].duty = 0;
+  }
+  motor_brake(&motorRight);
+  motor_brake(&motorLeft);
+}
+
+// Sample the battery every BATTERY_SAMPLE_MS; filtering and scale live in battery_comp.h
+void pollBattery() {
+  static unsigned long lastSample = 0;
+  if (millis() - lastSample < BATTERY_SAMPLE_MS) return;
+  lastSample = millis();
+  battery_sample(&battery, analogRead(BATTERY_SENSE));
+}
+
+// Configure encoder pins and enable their pin-change interrupts
+void setupEncoders() {
+  const uint8_t pins[4] = {ENC_LEFT_A, ENC_LEFT_B, ENC_RIGHT_A, ENC_RIGHT_B};
+  for (int i = 0; i < 4; i++) {
+    pinMode(pins[i], INPUT_PULLUP);
+    encoderPort[i] = portInputRegister(digitalPinToPort(pins[i]));
+    encoderMask[i] = digitalPinToBitMask(pins[i]);
+    *digitalPinToPCMSK(pins[i]) |= bit(digitalPinToPCMSKbit(pins[i]));
+    PCICR |= bit(digitalPinToPCICRbit(pins[i]));
+  }
+  for (int w = 0; w < 2; w++) {
+    encoderState[w] = ((*encoderPort[2 * w] & encoderMask[2 * w]) ? 2 : 0) |
+                      ((*encoderPort[2 * w + 1] & encoderMask[2 * w + 1]) ? 1 : 0);
+  }
+  lastWheelLoopUs = lastSpeedSampleUs = micros();
+}
+
+// Current button levels as a bit mask (bit set = pressed, buttons pull low)
+static inline uint8_t readButtons() {
+  uint8_t level = 0;
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    if (!(*buttonPort[i] & buttonMask[i])) level |= 1 << i;
+  }
+  return level;
+}
+
+// Configure button pin-change interrupts; edges are queued with a timestamp
+void setupButtons() {
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    buttonPort[i] = portInputRegister(digitalPinToPort(buttonPins[i]));
+    buttonMask[i] = digitalPinToBitMask(buttonPins[i]);
+  }
+  button_init(&buttons, BTN_COUNT, readButtons(), (uint16_t)millis());
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    *digitalPinToPCMSK(buttonPins[i]) |= bit(digitalPinToPCMSKbit(buttonPins[i]));
+    PCICR |= bit(digitalPinToPCICRbit(buttonPins[i]));
+  }
+}
+
+// Quadrature decode step for one wheel (called from the pin-change ISRs)
+static inline void encoderUpdate(uint8_t w) {
+  uint8_t a = (*encoderPort[2 * w] & encoderMask[2 * w]) ? 2 : 0;
+  uint8_t b = (*encoderPort[2 * w + 1] & encoderMask[2 * w + 1]) ? 1 : 0;
+  uint8_t state = ((encoderState[w] << 2) | a | b) & 0x0F;
+  encoderTicks[w] += quadTable[state];
+  encoderState[w] = state;
+}
+
+ISR(PCINT0_vect) { encoderUpdate(WHEEL_LEFT); }   // D13
+ISR(PCINT1_vect) {  // A1; buttons A2, A3
+  encoderUpdate(WHEEL_LEFT);
+  button_isr(&buttons, readButtons(), (uint16_t)millis());
+}
+ISR(PCINT2_vect) {  // D0, D1; buttons D5, D6, D7
+  encoderUpdate(WHEEL_RIGHT);
+  button_isr(&buttons, readButtons(), (uint16_t)millis());
+}
+
+long readEncoder(int w) {
+  noInterrupts();
+  long ticks = encoderTicks[w];
+  interrupts();
+  return ticks * encoderDir[w];
+}
+
+// Distance travelled by the robot centre in millimetres
+double distanceTravelled() {
+  return (readEncoder(WHEEL_LEFT) + readEncoder(WHEEL_RIGHT)) * 0.5 * MM_PER_TICK;
+}
+
+// Refresh the filtered per-wheel speed estimate every SPEED_SAMPLE_US
+void updateWheelSpeeds() {
+  unsigned long now = micros();
+  if (now - lastSpeedSampleUs < SPEED_SAMPLE_US) return;
+  double sampleSec = (now - lastSpeedSampleUs) * 1e-6;
+  lastSpeedSampleUs = now;
+  for (int w = 0; w < 2; w++) {
+    long ticks = readEncoder(w);
+    double measured = (ticks - wheels[w].lastTicks) / sampleSec / TICKS_PER_SEC_PER_PWM;
+    wheels[w].lastTicks = ticks;
+    wheels[w].speed += 0.5 * (measured - wheels[w].speed);
   }
 }
 
@@ -498,16 +995,18 @@ void tampilLineFollower() {
   display.setTextColor(SSD1306_INVERSE);
   display.print(motorText);
 
-  // Display PID error
-  String errorText = "Err:" + String(pid.error >= 0 ? "+" : "") + String(pid.error);
+  // Display PID error and checkpoints passed in this run
+  String errorText = "Err:" + String(pid.error >= 0 ? "+" : "") + String(pid.error) + " CP:" + String(checkpointsPassed);
   textWidth = errorText.length() * 6;
   int errorTextX = (SCREEN_WIDTH - textWidth) / 2;
   display.setCursor(errorTextX, 44);
   display.setTextColor(SSD1306_WHITE);
   display.print(errorText);
 
-  // Display base speed
-  String speedText = "Spd:" + String(baseSpeed);
+  // Display base speed and battery voltage (also sampled while stopped)
+  pollBattery();
+  String speedText = "Spd:" + String(baseSpeed) + " Bat:" +
+                     (battery.present ? String(battery.mv / 1000.0, 2) + "V" : String("-"));
   textWidth = speedText.length() * 6;
   int speedTextX = (SCREEN_WIDTH - textWidth) / 2;
   display.setCursor(speedTextX, 54);
@@ -560,11 +1059,11 @@ void followRightPath() {
 }
 
 void recallRoute() {
-  int route[100];
-  readRouteFromEEPROM(route, 100);
+  int route[ROUTE_LEN];
+  readRouteFromEEPROM(route, ROUTE_LEN);
 
   // Follow stored route
-  for (int i = 0; i < 100; i++) {
+  for (int i = 0; i < ROUTE_LEN; i++) {
     if (route[i] == 1) {
       moveForward();
     } else if (route[i] == 0) {
@@ -605,7 +1104,7 @@ bool detectRightLine() { return false; } // Implement right line detection
 void moveForward() {}                   // Implement forward movement
 void turnLeft() {}                      // Implement left turn
 void turnRight() {}                     // Implement right turn
-void stopMotor() {}                     // Implement motor stop
+void stopMotor() { brakeMotors(); }     // End of route: active brake
 
 
 
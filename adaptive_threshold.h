@@ -0,0 +1,204 @@
+// ===============================================================
+// adaptive_threshold.h
+// Ambang IR adaptif per sensor untuk line_follower.c dan
+// kode webot line maze.c, pengganti THRESHOLD / NOISE_THRESHOLD tetap
+// yang hanya cocok untuk satu tekstur lantai dan lookup table.
+//
+// Tiap sensor punya histogram ADAPT_BINS bin di rentang nilai sensor
+// (min/max lookup table), dengan bobot yang meluruh (half-life
+// ADAPT_HALF_LIFE langkah) supaya mengikuti perubahan lantai. Setiap
+// langkah histogram dibelah dua kelas dengan Otsu (varians antar-kelas
+// maksimum): lantai = rata-rata kelas bawah, garis = kelas atas (nilai
+// tinggi, sama seperti THRESHOLD di controller). Ambang = lantai +
+// ADAPT_LEVEL x (garis - lantai), bukan batas bin Otsu, karena bin kosong
+// di antara dua puncak membuat batas Otsu menempel di puncak lantai.
+// ADAPT_LEVEL 0.25 sama dengan THRESHOLD 300 di lookup table bawaan
+// (lantai 100, garis 900); aturan simpang controller maze disetel di situ
+// dan jauh lebih sering lepas garis dengan ambang di tengah.
+//
+// Sensor pinggir bisa lama tidak melihat garis sehingga histogramnya
+// satu puncak; Otsu di situ hanya membelah derau. Hasil dipakai hanya
+// jika kedua kelas cukup terpisah (eta = varians antar-kelas / varians
+// total >= ADAPT_MIN_ETA, Gauss tunggal ~0.64) dan selisih rata-ratanya
+// >= ADAPT_MIN_CONTRAST x rentang, dan (bila sudah ada hasil gabungan)
+// >= ADAPT_MIN_SHARE x kontras gabungan: sensor tengah yang hampir selalu
+// di atas garis jarang melihat lantai, dan Otsu-nya membelah kelas garis
+// sendiri (mis. 800 vs 890) sehingga garis yang sedikit bergeser dibaca
+// lantai. Jika tidak, dipakai hasil histogram
+// gabungan kedelapan sensor; jika itu pun tidak valid (mis. robot lama
+// lepas dari garis, semua sensor hanya melihat lantai), hasil gabungan
+// valid terakhir dipertahankan. Nilai tetap lama hanya dipakai sebelum
+// ada hasil valid sama sekali.
+//
+// Biaya per langkah: 8 x ADAPT_BINS peluruhan + 9 x ADAPT_BINS Otsu,
+// dicatat di update_us / update_us_max / update_us_sum.
+// Hanya C biasa, tanpa API Webots.
+// ===============================================================
+#ifndef ADAPTIVE_THRESHOLD_H
+#define ADAPTIVE_THRESHOLD_H
+
+#include <math.h>
+#include <time.h>
+
+#define ADAPT_SENSORS 8
+#define ADAPT_BINS 32
+#define ADAPT_HALF_LIFE 300        // langkah (~10 s pada TIME_STEP 32)
+#define ADAPT_WARMUP 30            // langkah sebelum histogram sensor sendiri dipercaya
+#define ADAPT_MIN_ETA 0.7f
+#define ADAPT_MIN_CONTRAST 0.05f
+#define ADAPT_MIN_CLASS 0.02f      // bobot kelas terkecil (garis jarang terlihat)
+#define ADAPT_MIN_SHARE 0.5f       // kontras sensor sendiri / kontras gabungan
+#define ADAPT_LEVEL 0.25f          // posisi ambang dari lantai ke garis
+
+typedef enum { ADAPT_FIXED, ADAPT_POOLED, ADAPT_OWN } AdaptSource;
+
+typedef struct {
+  float threshold;
+  float floor;     // rata-rata kelas bawah (lantai)
+  float line;      // rata-rata kelas atas (garis)
+  float eta;
+  int valid;
+} AdaptSplit;
+
+typedef struct {
+  // Parameter
+  float lo, hi;                       // rentang nilai sensor
+  float fixed_threshold, fixed_floor; // cadangan sebelum histogram terisi
+  float decay;
+
+  float hist[ADAPT_SENSORS][ADAPT_BINS];
+  unsigned long steps;
+  AdaptSplit last_pooled;             // hasil gabungan valid terakhir
+
+  // Hasil per sensor
+  float threshold[ADAPT_SENSORS];
+  float floor[ADAPT_SENSORS];
+  AdaptSource source[ADAPT_SENSORS];
+
+  // Biaya adapt_update per langkah (us)
+  float update_us, update_us_max, update_us_sum;
+} AdaptiveThreshold;
+
+static inline double adapt_clock_us(void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#else
+  return clock() * (1e6 / CLOCKS_PER_SEC);
+#endif
+}
+
+static inline void adapt_init(AdaptiveThreshold *a, float lo, float hi, float fixed_threshold, float fixed_floor) {
+  int s, b;
+  a->lo = lo;
+  a->hi = hi > lo ? hi : lo + 1;
+  a->fixed_threshold = fixed_threshold;
+  a->fixed_floor = fixed_floor;
+  a->decay = powf(0.5f, 1.0f / ADAPT_HALF_LIFE);
+  a->steps = 0;
+  a->last_pooled.valid = 0;
+  for (s = 0; s < ADAPT_SENSORS; s++) {
+    for (b = 0; b < ADAPT_BINS; b++) a->hist[s][b] = 0;
+    a->threshold[s] = fixed_threshold;
+    a->floor[s] = fixed_floor;
+    a->source[s] = ADAPT_FIXED;
+  }
+  a->update_us = a->update_us_max = a->update_us_sum = 0;
+}
+
+// Otsu pada satu histogram; split->valid = 0 jika kelas tidak terpisah jelas
+static inline void adapt_otsu(const AdaptiveThreshold *a, const float *h, AdaptSplit *split) {
+  float width = (a->hi - a->lo) / ADAPT_BINS;
+  float total = 0, sum = 0, sum_sq = 0, var_total;
+  float w_lo = 0, sum_lo = 0, best = -1, best_min = 0;
+  int b, best_bin = -1;
+  for (b = 0; b < ADAPT_BINS; b++) {
+    float x = b + 0.5f;
+    total += h[b];
+    sum += h[b] * x;
+    sum_sq += h[b] * x * x;
+  }
+  split->valid = 0;
+  if (total <= 0) return;
+  for (b = 0; b < ADAPT_BINS - 1; b++) {
+    float w_hi, m_lo, m_hi, between;
+    w_lo += h[b];
+    sum_lo += h[b] * (b + 0.5f);
+    w_hi = total - w_lo;
+    if (w_lo <= 0) continue;
+    if (w_hi <= 0) break;
+    m_lo = sum_lo / w_lo;
+    m_hi = (sum - sum_lo) / w_hi;
+    between = w_lo * w_hi * (m_hi - m_lo) * (m_hi - m_lo);
+    if (between > best) {
+      best = between;
+      best_bin = b;
+      split->floor = a->lo + m_lo * width;
+      split->line = a->lo + m_hi * width;
+      best_min = (w_lo < w_hi ? w_lo : w_hi) / total;
+    }
+  }
+  if (best_bin < 0) return;
+  var_total = sum_sq / total - (sum / total) * (sum / total);
+  split->eta = var_total > 0 ? best / (total * total) / var_total : 0;
+  split->threshold = split->floor + ADAPT_LEVEL * (split->line - split->floor);
+  split->valid = split->eta >= ADAPT_MIN_ETA && best_min >= ADAPT_MIN_CLASS &&
+                 split->line - split->floor >= ADAPT_MIN_CONTRAST * (a->hi - a->lo);
+}
+
+// Masukkan satu langkah nilai sensor, lalu hitung ulang ambang semua sensor
+static inline void adapt_update(AdaptiveThreshold *a, const double *values) {
+  double t0 = adapt_clock_us();
+  float pooled[ADAPT_BINS];
+  AdaptSplit own, pool;
+  int s, b;
+  for (b = 0; b < ADAPT_BINS; b++) pooled[b] = 0;
+  for (s = 0; s < ADAPT_SENSORS; s++) {
+    float *h = a->hist[s];
+    int bin = (int)((values[s] - a->lo) / (a->hi - a->lo) * ADAPT_BINS);
+    if (bin < 0) bin = 0;
+    if (bin >= ADAPT_BINS) bin = ADAPT_BINS - 1;
+    for (b = 0; b < ADAPT_BINS; b++) {
+      h[b] *= a->decay;
+      pooled[b] += h[b];
+    }
+    h[bin] += 1;
+    pooled[bin] += 1;
+  }
+  a->steps++;
+
+  adapt_otsu(a, pooled, &pool);
+  if (pool.valid) a->last_pooled = pool;
+  for (s = 0; s < ADAPT_SENSORS; s++) {
+    own.valid = 0;
+    if (a->steps >= ADAPT_WARMUP) adapt_otsu(a, a->hist[s], &own);
+    if (own.valid && a->last_pooled.valid &&
+        own.line - own.floor < ADAPT_MIN_SHARE * (a->last_pooled.line - a->last_pooled.floor)) {
+      own.valid = 0;
+    }
+    if (own.valid) {
+      a->threshold[s] = own.threshold;
+      a->floor[s] = own.floor;
+      a->source[s] = ADAPT_OWN;
+    } else if (a->last_pooled.valid) {
+      a->threshold[s] = a->last_pooled.threshold;
+      a->floor[s] = a->last_pooled.floor;
+      a->source[s] = ADAPT_POOLED;
+    } else {
+      a->threshold[s] = a->fixed_threshold;
+      a->floor[s] = a->fixed_floor;
+      a->source[s] = ADAPT_FIXED;
+    }
+  }
+
+  a->update_us = (float)(adapt_clock_us() - t0);
+  if (a->update_us > a->update_us_max) a->update_us_max = a->update_us;
+  a->update_us_sum += a->update_us;
+}
+
+static inline int adapt_is_line(const AdaptiveThreshold *a, int s, double value) {
+  return value > a->threshold[s];
+}
+
+#endif
@@ -0,0 +1,262 @@
+// ===============================================================
+// arduino_host.h
+// Pengganti minimal API Arduino supaya sketch firmware (.c) bisa
+// dikompilasi dan dijalankan di PC tanpa diubah.
+//
+// Dipakai oleh tool host (mis. trace_replay.cpp). Header ini berisi
+// definisi, jadi hanya boleh di-include SEKALI per program, sebelum
+// sketch-nya:
+//
+//   #include "arduino_host.h"
+//   #include "line_maze1.c"
+//
+// Waktu (millis/micros) adalah jam virtual hostClockUs yang hanya maju
+// lewat delay()/delayMicroseconds() atau diatur langsung oleh tool.
+// Semua I/O pin diteruskan ke hostHooks; yang tidak diisi memakai
+// perilaku default (pin input = HIGH, analog = 0, output dibuang).
+// ===============================================================
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define PI 3.1415926535897932384626433832795
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+// F() tetap tipe terpisah seperti di AVR supaya salah pakai ketahuan di host
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define pgm_read_word(a) (*(const uint16_t*)(a))
+#define pgm_read_dword(a) (*(const uint32_t*)(a))
+#define pgm_read_float(a) (*(const float*)(a))
+
+#define bit(b) (1UL << (b))
+#define bitRead(v, b) (((v) >> (b)) & 0x01)
+#define bitSet(v, b) ((v) |= (1UL << (b)))
+#define bitClear(v, b) ((v) &= ~(1UL << (b)))
+#define bitWrite(v, b, x) ((x) ? bitSet(v, b) : bitClear(v, b))
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+template <class A, class B> static inline auto max(A a, B b) -> decltype(a + b) { return a > b ? a : b; }
+template <class A, class B> static inline auto min(A a, B b) -> decltype(a + b) { return a < b ? a : b; }
+
+// ---------- Hook I/O ----------
+struct ArduinoHostHooks {
+  int (*analogRead)(uint8_t pin);
+  int (*digitalRead)(uint8_t pin);
+  void (*digitalWrite)(uint8_t pin, uint8_t value);
+  void (*analogWrite)(uint8_t pin, int value);
+  void (*advanceUs)(uint64_t us);        // dipanggil setiap jam virtual maju
+  void (*serialWrite)(uint8_t c);        // keluaran Serial (NULL = dibuang)
+  int (*serialRead)();                   // masukan Serial, -1 jika kosong
+};
+
+static ArduinoHostHooks hostHooks = {0, 0, 0, 0, 0, 0, 0};
+static uint64_t hostClockUs = 0;
+
+static inline void hostAdvanceUs(uint64_t us) {
+  hostClockUs += us;
+  if (hostHooks.advanceUs) hostHooks.advanceUs(us);
+}
+
+static inline unsigned long millis() { return (unsigned long)(hostClockUs / 1000); }
+static inline unsigned long micros() { return (unsigned long)hostClockUs; }
+static inline void delay(unsigned long ms) { hostAdvanceUs((uint64_t)ms * 1000); }
+static inline void delayMicroseconds(unsigned int us) { hostAdvanceUs(us); }
+
+static inline void pinMode(uint8_t, uint8_t) {}
+static inline int digitalRead(uint8_t pin) { return hostHooks.digitalRead ? hostHooks.digitalRead(pin) : HIGH; }
+static inline void digitalWrite(uint8_t pin, uint8_t v) { if (hostHooks.digitalWrite) hostHooks.digitalWrite(pin, v); }
+static inline int analogRead(uint8_t pin) { return hostHooks.analogRead ? hostHooks.analogRead(pin) : 0; }
+static inline void analogWrite(uint8_t pin, int v) { if (hostHooks.analogWrite) hostHooks.analogWrite(pin, v); }
+static inline void tone(uint8_t, unsigned int, unsigned long = 0) {}
+static inline void noTone(uint8_t) {}
+static inline long map(long x, long inLo, long inHi, long outLo, long outHi) {
+  return (x - inLo) * (outHi - outLo) / (inHi - inLo) + outLo;
+}
+
+// ---------- Register AVR (dummy) ----------
+static volatile uint8_t hostRegs[64];
+#define PCICR hostRegs[0]
+#define PCIFR hostRegs[1]
+#define PCMSK0 hostRegs[2]
+#define PCMSK1 hostRegs[3]
+#define PCMSK2 hostRegs[4]
+#define MCUSR hostRegs[5]
+#define ADCSRA hostRegs[6]
+#define ADMUX hostRegs[7]
+#define TCCR1A hostRegs[8]
+#define TCCR1B hostRegs[9]
+#define TCCR2A hostRegs[10]
+#define TCCR2B hostRegs[11]
+#define OCR2A hostRegs[12]
+#define OCR2B hostRegs[13]
+#define SREG hostRegs[14]
+#define PIND hostRegs[15]
+static volatile uint16_t ICR1, OCR1A, OCR1B, TCNT1;
+
+#define ISR(vector) void vector()
+#define cli()
+#define sei()
+static inline void noInterrupts() {}
+static inline void interrupts() {}
+
+#define digitalPinToPort(p) ((uint8_t)((p) < 8 ? 0 : ((p) < 14 ? 1 : 2)))
+#define digitalPinToBitMask(p) ((uint8_t)(1 << ((p) < 8 ? (p) : ((p) < 14 ? (p) - 8 : (p) - 14))))
+#define portInputRegister(port) (&hostRegs[32 + (port)])
+#define portOutputRegister(port) (&hostRegs[40 + (port)])
+#define digitalPinToPCICR(p) (&PCICR)
+#define digitalPinToPCICRbit(p) (digitalPinToPort(p))
+#define digitalPinToPCMSK(p) (&hostRegs[2 + digitalPinToPort(p)])
+#define digitalPinToPCMSKbit(p) ((p) < 8 ? (p) : ((p) < 14 ? (p) - 8 : (p) - 14))
+
+// ---------- String ----------
+class String {
+ public:
+  std::string s;
+  String(const char* c = "") : s(c ? c : "") {}
+  String(const std::string& x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v, int base = DEC) { fromLong(v, base); }
+  String(long v, int base = DEC) { fromLong(v, base); }
+  String(unsigned int v, int base = DEC) { fromLong((long)v, base); }
+  String(unsigned long v, int base = DEC) { fromLong((long)v, base); }
+  String(double v, int digits = 2) { char b[40]; snprintf(b, sizeof(b), "%.*f", digits, v); s = b; }
+
+  unsigned int length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  int indexOf(const String& t) const { size_t p = s.find(t.s); return p == std::string::npos ? -1 : (int)p; }
+  String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const { return from < s.size() ? String(s.substr(from, to - from)) : String(); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return (float)atof(s.c_str()); }
+  void replace(const String& from, const String& to) {
+    if (from.s.empty()) return;
+    size_t p = 0;
+    while ((p = s.find(from.s, p)) != std::string::npos) {
+      s.replace(p, from.s.size(), to.s);
+      p += to.s.size();
+    }
+  }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator!=(const String& o) const { return s != o.s; }
+
+ private:
+  void fromLong(long v, int base) {
+    char b[40];
+    if (base == HEX) snprintf(b, sizeof(b), "%lX", v);
+    else if (base == BIN) {
+      int n = 0; unsigned long u = (unsigned long)v;
+      char t[40]; do { t[n++] = '0' + (u & 1); u >>= 1; } while (u && n < 39);
+      for (int i = 0; i < n; i++) b[i] = t[n - 1 - i];
+      b[n] = 0;
+    } else snprintf(b, sizeof(b), "%ld", v);
+    s = b;
+  }
+};
+static inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+
+// ---------- Print / Serial ----------
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const uint8_t* buf, size_t n) { for (size_t i = 0; i < n; i++) write(buf[i]); return n; }
+  size_t print(const char* t) { size_t n = 0; while (t && *t) n += write((uint8_t)*t++); return n; }
+  size_t print(const String& t) { return print(t.c_str()); }
+  size_t print(const __FlashStringHelper* t) { return print(reinterpret_cast<const char*>(t)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned char v, int base = DEC) { return print(String((unsigned int)v, base)); }
+  size_t print(double v, int digits = 2) { return print(String(v, digits)); }
+  size_t println() { return print("\r\n"); }
+  template <class T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <class T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+ public:
+  using Print::write;
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) { if (hostHooks.serialWrite) hostHooks.serialWrite(c); return 1; }
+  int available() { return peekByte() >= 0 ? 1 : 0; }
+  int read() { int c = peekByte(); peeked = -2; return c; }
+  int peek() { return peekByte(); }
+  int availableForWrite() { return 64; }
+  void flush() {}
+  operator bool() { return true; }
+
+ private:
+  int peeked = -2;
+  int peekByte() {
+    if (peeked == -2) peeked = hostHooks.serialRead ? hostHooks.serialRead() : -1;
+    return peeked;
+  }
+};
+static HardwareSerial Serial;
+
+// ---------- Wire / EEPROM ----------
+// Layar OLED (oled_pages.h) ikut berjalan di host; byte I2C-nya dibuang di sini.
+class TwoWire {
+ public:
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) {}
+  uint8_t endTransmission(bool = true) { return 0; }
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t*, size_t n) { return n; }
+};
+static TwoWire Wire;
+
+class EEPROMClass {
+ public:
+  uint8_t mem[1024];
+  EEPROMClass() { memset(mem, 0xFF, sizeof(mem)); }
+  uint8_t read(int a) { return mem[a & 1023]; }
+  void write(int a, uint8_t v) { mem[a & 1023] = v; }
+  void update(int a, uint8_t v) { mem[a & 1023] = v; }
+  uint16_t length() { return sizeof(mem); }
+  template <class T> T& get(int a, T& t) { memcpy(&t, &mem[a & 1023], sizeof(T)); return t; }
+  template <class T> const T& put(int a, const T& t) { memcpy(&mem[a & 1023], &t, sizeof(T)); return t; }
+};
+static EEPROMClass EEPROM;
+static inline int eeprom_is_ready() { return 1; }
+
+// Sketch Arduino menyertakan header library sendiri; di host semuanya sudah ada di atas.
+#define ARDUINO_HOST 1
+
+#endif
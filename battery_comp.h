@@ -0,0 +1,91 @@
+// ===============================================================
+// battery_comp.h
+// Kompensasi tegangan baterai untuk duty PWM motor (feedforward),
+// dipakai oleh line_follower1.c, line_maze1.c dan UI.c.
+//
+// Duty analogWrite yang sama memberi tegangan motor yang makin kecil saat
+// baterai turun, jadi BASE_SPEED dan gain PID yang dituning dengan baterai
+// penuh terasa lembek di akhir sesi. Di sini tegangan baterai dibaca lewat
+// pembagi tegangan di pin ADC cadangan, difilter IIR, lalu setiap duty
+// dikali nominal_mv / tegangan_terfilter sebelum ke analogWrite, sehingga
+// tegangan rata-rata di motor tetap sama dengan saat tuning.
+//
+// Pembagi: baterai - R1 - pin ADC - R2 - GND, full_scale_mv = Vref x
+// (R1 + R2) / R2, mis. 5 V dengan 20k/10k = 15000 mV (cukup untuk 2S/3S,
+// impedansi 6.7k masih aman untuk ADC AVR; tambah 100 nF di pin ADC).
+//
+// Semua hitungan integer: skala Q8 (256 = 1.0) dihitung ulang hanya saat
+// sampel baru, battery_duty() cukup satu perkalian dan geser per motor.
+// Tegangan di bawah BATTERY_PRESENT_MV (mis. hanya USB, pembagi tidak
+// terpasang) atau nominal_mv = 0 mematikan kompensasi (skala 1.0).
+// ===============================================================
+#ifndef BATTERY_COMP_H
+#define BATTERY_COMP_H
+
+#include <stdint.h>
+
+#ifndef BATTERY_NOMINAL_MV
+#define BATTERY_NOMINAL_MV 7400     // 2S LiPo, tegangan saat gain dituning
+#endif
+#define BATTERY_PRESENT_MV 3000     // di bawah ini baterai dianggap tidak terpasang
+#define BATTERY_FILTER_SHIFT 3      // IIR alpha 1/8, ~160 ms pada sampel 20 ms
+#define BATTERY_SCALE_MIN_Q8 192    // 0.75x, baterai di atas nominal (baru dicas)
+#define BATTERY_SCALE_MAX_Q8 384    // 1.5x, baterai hampir habis
+
+typedef struct {
+  uint16_t full_scale_mv;  // tegangan baterai saat ADC = 1023
+  uint16_t nominal_mv;     // 0 = kompensasi mati
+  uint32_t acc;            // mv << BATTERY_FILTER_SHIFT
+  uint16_t mv;             // tegangan terfilter
+  uint16_t scale_q8;       // pengali duty, 256 = 1.0
+  uint8_t present;
+  uint8_t seeded;
+} BatteryComp;
+
+static inline void battery_init(BatteryComp *b, uint16_t full_scale_mv, uint16_t nominal_mv) {
+  b->full_scale_mv = full_scale_mv;
+  b->nominal_mv = nominal_mv;
+  b->acc = 0;
+  b->mv = 0;
+  b->scale_q8 = 256;
+  b->present = 0;
+  b->seeded = 0;
+}
+
+// Hitung ulang skala dari tegangan terfilter (juga setelah nominal_mv diubah)
+static inline void battery_update_scale(BatteryComp *b) {
+  uint32_t s;
+  b->present = b->mv >= BATTERY_PRESENT_MV;
+  if (!b->present || b->nominal_mv == 0) {
+    b->scale_q8 = 256;
+    return;
+  }
+  s = ((uint32_t)b->nominal_mv << 8) / b->mv;
+  if (s < BATTERY_SCALE_MIN_Q8) s = BATTERY_SCALE_MIN_Q8;
+  if (s > BATTERY_SCALE_MAX_Q8) s = BATTERY_SCALE_MAX_Q8;
+  b->scale_q8 = (uint16_t)s;
+}
+
+// Satu sampel ADC 10 bit dari pin baterai. Sampel pertama langsung mengisi
+// filter supaya kompensasi benar sejak awal, bukan naik pelan dari nol.
+static inline void battery_sample(BatteryComp *b, uint16_t adc) {
+  uint16_t mv = (uint16_t)((uint32_t)adc * b->full_scale_mv / 1023);
+  if (!b->seeded) {
+    b->acc = (uint32_t)mv << BATTERY_FILTER_SHIFT;
+    b->seeded = 1;
+  } else {
+    b->acc -= b->acc >> BATTERY_FILTER_SHIFT;
+    b->acc += mv;
+  }
+  b->mv = (uint16_t)(b->acc >> BATTERY_FILTER_SHIFT);
+  battery_update_scale(b);
+}
+
+// Duty bertanda (-255..255) yang sudah dikompensasi, tetap dalam batas PWM
+static inline int battery_duty(const BatteryComp *b, int duty) {
+  int32_t d = ((int32_t)(duty < 0 ? -duty : duty) * b->scale_q8 + 128) >> 8;
+  if (d > 255) d = 255;
+  return duty < 0 ? (int)-d : (int)d;
+}
+
+#endif
@@ -0,0 +1,505 @@
+// ===============================================================
+// benchmark_supervisor.c
+// Supervisor Webots untuk benchmark controller line follower / maze.
+// Untuk tiap baris suite: bangun lintasan referensi di lantai, taruh
+// robot di titik mulai, jalankan controller dengan derau sensor ber-seed
+// (lihat sensor_noise.h), lalu ukur terhadap ground truth:
+//
+//   waktu_s      waktu satu lap / sampai ujung rute
+//   rms_mm       RMS jarak titik sensor ke rute (cross-track error)
+//   maks_mm      cross-track error terbesar
+//   lepas_garis  berapa kali titik sensor lepas > LEPAS_MASUK dari rute
+//   simpang      keputusan di tiap simpang (L/S/R/U) vs yang diharapkan
+//
+// Hasil ditulis ke CSV dan dibandingkan dengan baseline.csv: run gagal
+// jika tidak selesai, lebih lambat > TOL_WAKTU, RMS naik > TOL_RMS, lebih
+// sering lepas garis, atau simpang benar berkurang. Baris tanpa baseline
+// hanya harus selesai. Di akhir simulasi keluar dengan status 0 (semua
+// lulus) atau 1, jadi bisa dipakai di skrip:
+//
+//   webots --batch --mode=fast --stdout --stderr benchmark.wbt
+//
+// World cukup berisi lantai terang, robot dengan DEF ROBOT (perangkat
+// ir1..ir8, motorkiri, motorkanan) dan Robot supervisor TRUE yang
+// memakai controller ini. Controller robot harus tersedia dengan nama
+// yang dipakai di suite (mis. line_follower, line_maze).
+//
+// Tanpa Webots, supervisor ini dan controller-nya bisa dijalankan di
+// dunia kinematik webots_host.cpp. benchmark/baseline.csv di repo dibuat
+// dengan cara itu; angkanya tidak sebanding dengan run di Webots, jadi
+// di world Webots buat baseline sendiri dulu dengan --perbarui.
+//
+// Argumen controller (controllerArgs):
+//   --suite=<file>      default ../../benchmark/suite.txt
+//   --baseline=<file>   default baseline.csv di folder suite
+//   --hasil=<file>      default hasil.csv di folder suite
+//   --robot=<DEF>       default ROBOT
+//   --sensor=<m>        jarak titik sensor di depan pusat robot, default 0
+//   --perbarui          tulis hasil sebagai baseline baru
+//
+// Format lintasan (.trk), satu perintah per baris, satuan meter/derajat,
+// gaya turtle: posisi dan arah maju sepanjang rute yang diharapkan.
+//   mulai x y arah       posisi dan arah awal robot
+//   lurus L              garis lurus
+//   putus L on off       garis putus-putus (on/off panjang segmen)
+//   belok R sudut        busur jari-jari R, sudut + = kiri
+//   putar sudut          sudut tajam di tempat
+//   cabang L sudut       cabang buntu/tidak dipakai, posisi tidak berubah
+//   palang P             palang checkpoint selebar LEBAR_PALANG, P panjang searah rute
+//   simpang K            simpang di posisi ini, keputusan benar K (L/S/R/U)
+// ===============================================================
+#include <webots/robot.h>
+#include <webots/supervisor.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TIME_STEP 32
+#define MAX_STRIPS 256
+#define MAX_ROUTE 512
+#define MAX_SIMPANG 16
+#define MAX_RUNS 32
+#define LEBAR_GARIS 0.025
+#define LEBAR_PALANG 0.12
+#define LANGKAH_BUSUR 10.0     // derajat per potongan busur
+#define RADIUS_SIMPANG 0.10
+#define JARAK_SELESAI 0.05
+#define LEPAS_MASUK 0.04       // lepas garis jika |xte| di atas ini...
+#define LEPAS_KELUAR 0.02      // ...dan kembali jika di bawah ini
+#define KELUAR_JALUR 0.30
+#define WAKTU_KELUAR 2.0       // detik di luar KELUAR_JALUR -> run dihentikan
+#define TOL_WAKTU 0.05
+#define TOL_RMS 0.10
+
+typedef struct {
+  double x1, y1, x2, y2;
+  double width;
+} Strip;
+
+typedef struct {
+  double x, y;
+  char expected;
+  char actual;
+  int inside;
+  double yaw_in;
+} Simpang;
+
+typedef struct {
+  Strip strips[MAX_STRIPS];
+  int strip_count;
+  double rx[MAX_ROUTE], ry[MAX_ROUTE], rs[MAX_ROUTE];  // rute dan panjang kumulatif
+  int route_count;
+  Simpang simpang[MAX_SIMPANG];
+  int simpang_count;
+  double start_x, start_y, start_yaw;
+} Track;
+
+typedef struct {
+  char track[64];
+  char controller[64];
+  unsigned seed;
+  double noise;
+  double timeout;
+  int finished;
+  double lap;
+  double rms_mm;
+  double max_mm;
+  int losses;
+  int simpang_ok;
+  int simpang_total;
+  char decisions[MAX_SIMPANG + 1];
+  char result[32];
+} Run;
+
+static Track track;
+static Run runs[MAX_RUNS];
+static Run baseline[MAX_RUNS];
+static int run_count, baseline_count;
+static WbNodeRef robot;
+static double sensor_offset;
+
+// ========== LINTASAN ==========
+
+static void add_strip(double x1, double y1, double x2, double y2, int extend) {
+  double len = hypot(x2 - x1, y2 - y1), e;
+  Strip *s;
+  if (track.strip_count >= MAX_STRIPS || len <= 0) return;
+  // ujung diperpanjang setengah lebar supaya sudut tajam tertutup
+  e = extend ? LEBAR_GARIS / 2 / len : 0;
+  s = &track.strips[track.strip_count++];
+  s->x1 = x1 - (x2 - x1) * e;
+  s->y1 = y1 - (y2 - y1) * e;
+  s->x2 = x2 + (x2 - x1) * e;
+  s->y2 = y2 + (y2 - y1) * e;
+  s->width = LEBAR_GARIS;
+}
+
+static void add_route_point(double x, double y) {
+  int n = track.route_count;
+  if (n >= MAX_ROUTE) return;
+  track.rx[n] = x;
+  track.ry[n] = y;
+  track.rs[n] = n ? track.rs[n - 1] + hypot(x - track.rx[n - 1], y - track.ry[n - 1]) : 0;
+  track.route_count++;
+}
+
+static int load_track(const char *path) {
+  FILE *f = fopen(path, "r");
+  char line[160], cmd[16];
+  double x = 0, y = 0, yaw = 0, a, b, c;
+  int lineno = 0;
+  if (!f) {
+    printf("[BENCH] lintasan %s tidak bisa dibuka\n", path);
+    return 0;
+  }
+  memset(&track, 0, sizeof(track));
+  add_route_point(0, 0);
+  while (fgets(line, sizeof(line), f)) {
+    int n;
+    lineno++;
+    if (line[0] == '#' || sscanf(line, "%15s", cmd) != 1) continue;
+    n = sscanf(line, "%*s %lf %lf %lf", &a, &b, &c);
+    if (strcmp(cmd, "mulai") == 0 && n == 3) {
+      x = track.start_x = a;
+      y = track.start_y = b;
+      yaw = track.start_yaw = c * M_PI / 180;
+      track.route_count = 0;
+      add_route_point(x, y);
+    } else if (strcmp(cmd, "lurus") == 0 && n == 1) {
+      add_strip(x, y, x + a * cos(yaw), y + a * sin(yaw), 1);
+      x += a * cos(yaw);
+      y += a * sin(yaw);
+      add_route_point(x, y);
+    } else if (strcmp(cmd, "putus") == 0 && n == 3) {
+      double d;
+      for (d = 0; d < a; d += b + c) {
+        double e = fmin(d + b, a);
+        add_strip(x + d * cos(yaw), y + d * sin(yaw), x + e * cos(yaw), y + e * sin(yaw), 0);
+      }
+      x += a * cos(yaw);
+      y += a * sin(yaw);
+      add_route_point(x, y);
+    } else if (strcmp(cmd, "belok") == 0 && n == 2) {
+      double s = b > 0 ? 1 : -1;
+      double cx = x - s * a * sin(yaw), cy = y + s * a * cos(yaw);
+      double phi = yaw - s * M_PI / 2;
+      int i, steps = (int)ceil(fabs(b) / LANGKAH_BUSUR);
+      double dphi = b * M_PI / 180 / steps;
+      for (i = 0; i < steps; i++) {
+        double nx, ny;
+        phi += dphi;
+        nx = cx + a * cos(phi);
+        ny = cy + a * sin(phi);
+        add_strip(x, y, nx, ny, 1);
+        x = nx;
+        y = ny;
+        add_route_point(x, y);
+      }
+      yaw += dphi * steps;
+    } else if (strcmp(cmd, "putar") == 0 && n == 1) {
+      yaw += a * M_PI / 180;
+    } else if (strcmp(cmd, "cabang") == 0 && n == 2) {
+      double h = yaw + b * M_PI / 180;
+      add_strip(x, y, x + a * cos(h), y + a * sin(h), 1);
+    } else if (strcmp(cmd, "palang") == 0 && n == 1) {
+      // satu strip melintang selebar a, dimulai di posisi ini; posisi tidak berubah
+      double px = x + a / 2 * cos(yaw), py = y + a / 2 * sin(yaw), w = LEBAR_PALANG / 2;
+      add_strip(px + w * sin(yaw), py - w * cos(yaw), px - w * sin(yaw), py + w * cos(yaw), 0);
+      if (track.strip_count > 0) track.strips[track.strip_count - 1].width = a;
+    } else if (strcmp(cmd, "simpang") == 0 && track.simpang_count < MAX_SIMPANG) {
+      char k = 'S';
+      sscanf(line, "%*s %c", &k);
+      Simpang *j = &track.simpang[track.simpang_count++];
+      j->x = x;
+      j->y = y;
+      j->expected = k;
+      j->actual = '-';
+    } else {
+      printf("[BENCH] %s:%d perintah tidak dikenal: %s", path, lineno, line);
+    }
+  }
+  fclose(f);
+  return track.route_count >= 2;
+}
+
+// Ganti lintasan di world dengan strip hitam tipis (Solid statis, supaya
+// sensor IR membaca warnanya)
+static void build_track(void) {
+  WbNodeRef old = wb_supervisor_node_get_from_def("BENCH_LINTASAN");
+  WbFieldRef children = wb_supervisor_node_get_field(wb_supervisor_node_get_root(), "children");
+  size_t cap = 64 + (size_t)track.strip_count * 320, len;
+  char *s = malloc(cap);
+  int i;
+  if (old) wb_supervisor_node_remove(old);
+  if (!s) return;
+  len = (size_t)snprintf(s, cap, "DEF BENCH_LINTASAN Group { children [");
+  for (i = 0; i < track.strip_count; i++) {
+    const Strip *t = &track.strips[i];
+    double l = hypot(t->x2 - t->x1, t->y2 - t->y1);
+    len += (size_t)snprintf(s + len, cap - len,
+                            " Solid { translation %.4f %.4f 0.00005 rotation 0 0 1 %.5f"
+                            " children [ Shape { appearance PBRAppearance { baseColor 0 0 0 roughness 1 metalness 0 }"
+                            " geometry Box { size %.4f %.4f 0.0001 } } ]"
+                            " boundingObject Box { size %.4f %.4f 0.0001 } }",
+                            (t->x1 + t->x2) / 2, (t->y1 + t->y2) / 2, atan2(t->y2 - t->y1, t->x2 - t->x1),
+                            l, t->width, l, t->width);
+  }
+  snprintf(s + len, cap - len, " ] }");
+  wb_supervisor_field_import_mf_node_from_string(children, -1, s);
+  free(s);
+}
+
+// Jarak titik ke rute; hanya segmen di sekitar segmen terakhir yang dicari
+// supaya lintasan tertutup tidak langsung "selesai" di titik mulai
+static double route_distance(double px, double py, int *seg, double *progress) {
+  int i, lo = *seg > 0 ? *seg - 1 : 0, hi = *seg + 4;
+  double best = 1e9;
+  if (hi > track.route_count - 2) hi = track.route_count - 2;
+  for (i = lo; i <= hi; i++) {
+    double dx = track.rx[i + 1] - track.rx[i], dy = track.ry[i + 1] - track.ry[i];
+    double l2 = dx * dx + dy * dy;
+    double u = l2 > 0 ? ((px - track.rx[i]) * dx + (py - track.ry[i]) * dy) / l2 : 0;
+    double d;
+    if (u < 0) u = 0;
+    if (u > 1) u = 1;
+    d = hypot(px - (track.rx[i] + u * dx), py - (track.ry[i] + u * dy));
+    if (d < best) {
+      best = d;
+      *seg = i;
+      *progress = track.rs[i] + u * sqrt(l2);
+    }
+  }
+  return best;
+}
+
+static char classify_turn(double yaw_in, double yaw_out) {
+  double d = atan2(sin(yaw_out - yaw_in), cos(yaw_out - yaw_in)) * 180 / M_PI;
+  if (fabs(d) < 45) return 'S';
+  if (d >= 45 && d < 135) return 'L';
+  if (d <= -45 && d > -135) return 'R';
+  return 'U';
+}
+
+// ========== RUN ==========
+
+static void set_controller(const Run *r) {
+  WbFieldRef args = wb_supervisor_node_get_field(robot, "controllerArgs");
+  WbFieldRef ctrl = wb_supervisor_node_get_field(robot, "controller");
+  char buf[48];
+  while (wb_supervisor_field_get_count(args) > 0) wb_supervisor_field_remove_mf(args, 0);
+  snprintf(buf, sizeof(buf), "--seed=%u", r->seed);
+  wb_supervisor_field_insert_mf_string(args, 0, buf);
+  snprintf(buf, sizeof(buf), "--noise=%g", r->noise);
+  wb_supervisor_field_insert_mf_string(args, 1, buf);
+  if (strcmp(wb_supervisor_field_get_sf_string(ctrl), r->controller) != 0)
+    wb_supervisor_field_set_sf_string(ctrl, r->controller);  // mengganti controller = restart
+  else
+    wb_supervisor_node_restart_controller(robot);
+}
+
+static void place_robot(void) {
+  WbFieldRef tf = wb_supervisor_node_get_field(robot, "translation");
+  WbFieldRef rf = wb_supervisor_node_get_field(robot, "rotation");
+  const double *cur = wb_supervisor_field_get_sf_vec3f(tf);
+  double pos[3] = {track.start_x - sensor_offset * cos(track.start_yaw),
+                   track.start_y - sensor_offset * sin(track.start_yaw), cur[2]};
+  double rot[4] = {0, 0, 1, track.start_yaw};
+  wb_supervisor_field_set_sf_vec3f(tf, pos);
+  wb_supervisor_field_set_sf_rotation(rf, rot);
+  wb_supervisor_node_reset_physics(robot);
+}
+
+static void run_one(Run *r) {
+  int seg = 0, samples = 0, lost = 0, i;
+  double progress = 0, sum_sq = 0, t0, off_since = -1;
+
+  set_controller(r);
+  place_robot();
+  wb_robot_step(TIME_STEP);
+  t0 = wb_robot_get_time();
+
+  while (wb_robot_step(TIME_STEP) != -1) {
+    const double *p = wb_supervisor_node_get_position(robot);
+    const double *m = wb_supervisor_node_get_orientation(robot);
+    double now = wb_robot_get_time() - t0;
+    double yaw = atan2(m[3], m[0]);
+    double sx = p[0] + sensor_offset * cos(yaw), sy = p[1] + sensor_offset * sin(yaw);
+    double xte = route_distance(sx, sy, &seg, &progress);
+
+    samples++;
+    sum_sq += xte * xte;
+    if (xte > r->max_mm / 1000) r->max_mm = xte * 1000;
+    if (!lost && xte > LEPAS_MASUK) {
+      lost = 1;
+      r->losses++;
+    } else if (lost && xte < LEPAS_KELUAR) {
+      lost = 0;
+    }
+
+    for (i = 0; i < track.simpang_count; i++) {
+      Simpang *j = &track.simpang[i];
+      double d = hypot(sx - j->x, sy - j->y);
+      if (j->actual != '-') continue;  // hanya kunjungan pertama
+      if (!j->inside && d < RADIUS_SIMPANG) {
+        j->inside = 1;
+        j->yaw_in = yaw;
+      } else if (j->inside && d > RADIUS_SIMPANG + 0.02) {
+        j->actual = classify_turn(j->yaw_in, yaw);
+      }
+    }
+
+    if (seg == track.route_count - 2 && progress >= track.rs[track.route_count - 1] - JARAK_SELESAI) {
+      r->finished = 1;
+      r->lap = now;
+      break;
+    }
+    if (xte > KELUAR_JALUR) {
+      if (off_since < 0) off_since = now;
+      if (now - off_since > WAKTU_KELUAR) break;
+    } else {
+      off_since = -1;
+    }
+    if (now > r->timeout) break;
+  }
+
+  if (!r->finished) r->lap = wb_robot_get_time() - t0;
+  r->rms_mm = samples ? sqrt(sum_sq / samples) * 1000 : 0;
+  r->simpang_total = track.simpang_count;
+  for (i = 0; i < track.simpang_count; i++) {
+    r->decisions[i] = track.simpang[i].actual;
+    if (track.simpang[i].actual == track.simpang[i].expected) r->simpang_ok++;
+  }
+  r->decisions[track.simpang_count] = '\0';
+}
+
+// ========== LAPORAN ==========
+
+static const Run *find_baseline(const Run *r) {
+  int i;
+  for (i = 0; i < baseline_count; i++) {
+    const Run *b = &baseline[i];
+    if (strcmp(b->track, r->track) == 0 && strcmp(b->controller, r->controller) == 0 && b->seed == r->seed)
+      return b;
+  }
+  return NULL;
+}
+
+static void judge(Run *r) {
+  const Run *b = find_baseline(r);
+  const char *why = NULL;
+  if (!r->finished) why = "tidak selesai";
+  else if (b && b->finished && r->lap > b->lap * (1 + TOL_WAKTU)) why = "waktu";
+  else if (b && b->finished && r->rms_mm > b->rms_mm * (1 + TOL_RMS)) why = "rms";
+  else if (b && r->losses > b->losses) why = "lepas garis";
+  else if (b && r->simpang_ok < b->simpang_ok) why = "simpang";
+  if (why) snprintf(r->result, sizeof(r->result), "GAGAL:%s", why);
+  else snprintf(r->result, sizeof(r->result), b ? "LULUS" : "BARU");
+}
+
+static const char csv_header[] =
+    "lintasan,pengendali,seed,noise,selesai,waktu_s,rms_mm,maks_mm,lepas_garis,simpang_benar,simpang_total,keputusan,hasil\n";
+
+static void write_csv(const char *path) {
+  FILE *f = fopen(path, "w");
+  int i;
+  if (!f) {
+    printf("[BENCH] %s tidak bisa ditulis\n", path);
+    return;
+  }
+  fputs(csv_header, f);
+  for (i = 0; i < run_count; i++) {
+    const Run *r = &runs[i];
+    fprintf(f, "%s,%s,%u,%g,%d,%.3f,%.2f,%.2f,%d,%d,%d,%s,%s\n", r->track, r->controller, r->seed, r->noise,
+            r->finished, r->lap, r->rms_mm, r->max_mm, r->losses, r->simpang_ok, r->simpang_total,
+            r->decisions[0] ? r->decisions : "-", r->result);
+  }
+  fclose(f);
+}
+
+static void read_baseline(const char *path) {
+  FILE *f = fopen(path, "r");
+  char line[256];
+  if (!f) return;
+  while (fgets(line, sizeof(line), f) && baseline_count < MAX_RUNS) {
+    Run *b = &baseline[baseline_count];
+    if (sscanf(line, "%63[^,],%63[^,],%u,%lf,%d,%lf,%lf,%lf,%d,%d,%d", b->track, b->controller, &b->seed,
+               &b->noise, &b->finished, &b->lap, &b->rms_mm, &b->max_mm, &b->losses, &b->simpang_ok,
+               &b->simpang_total) == 11)
+      baseline_count++;
+  }
+  fclose(f);
+}
+
+// ========== MAIN ==========
+
+int main(int argc, char **argv) {
+  char suite[256] = "../../benchmark/suite.txt", base[256] = "", hasil[256] = "", dir[256], line[256];
+  const char *robot_def = "ROBOT";
+  int update = 0, failed = 0, i;
+  char *slash;
+  FILE *f;
+
+  wb_robot_init();
+
+  for (i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--suite=", 8) == 0) snprintf(suite, sizeof(suite), "%s", argv[i] + 8);
+    else if (strncmp(argv[i], "--baseline=", 11) == 0) snprintf(base, sizeof(base), "%s", argv[i] + 11);
+    else if (strncmp(argv[i], "--hasil=", 8) == 0) snprintf(hasil, sizeof(hasil), "%s", argv[i] + 8);
+    else if (strncmp(argv[i], "--robot=", 8) == 0) robot_def = argv[i] + 8;
+    else if (strncmp(argv[i], "--sensor=", 9) == 0) sensor_offset = atof(argv[i] + 9);
+    else if (strcmp(argv[i], "--perbarui") == 0) update = 1;
+  }
+  snprintf(dir, sizeof(dir), "%s", suite);
+  slash = strrchr(dir, '/');
+  if (slash) slash[1] = '\0';
+  else dir[0] = '\0';
+  if (!base[0]) snprintf(base, sizeof(base), "%sbaseline.csv", dir);
+  if (!hasil[0]) snprintf(hasil, sizeof(hasil), "%shasil.csv", dir);
+
+  robot = wb_supervisor_node_get_from_def(robot_def);
+  f = fopen(suite, "r");
+  if (!robot || !f) {
+    printf("[BENCH] robot DEF %s atau suite %s tidak ditemukan\n", robot_def, suite);
+    if (f) fclose(f);
+    wb_supervisor_simulation_quit(EXIT_FAILURE);
+    wb_robot_step(TIME_STEP);
+    wb_robot_cleanup();
+    return 1;
+  }
+  read_baseline(base);
+
+  while (fgets(line, sizeof(line), f) && run_count < MAX_RUNS) {
+    Run *r = &runs[run_count];
+    char path[384];
+    memset(r, 0, sizeof(*r));
+    if (line[0] == '#' || sscanf(line, "%63s %63s %u %lf %lf", r->track, r->controller, &r->seed, &r->noise,
+                                 &r->timeout) != 5)
+      continue;
+    snprintf(path, sizeof(path), "%s%s", dir, r->track);
+    if (!load_track(path)) continue;
+    build_track();
+    printf("[BENCH] %s / %s seed %u noise %g ...\n", r->track, r->controller, r->seed, r->noise);
+    run_one(r);
+    judge(r);
+    printf("[BENCH] %s / %s: %s %.2f s, RMS %.1f mm, maks %.1f mm, lepas %d, simpang %d/%d (%s) -> %s\n",
+           r->track, r->controller, r->finished ? "selesai" : "TIDAK selesai", r->lap, r->rms_mm, r->max_mm,
+           r->losses, r->simpang_ok, r->simpang_total, r->decisions[0] ? r->decisions : "-", r->result);
+    if (strncmp(r->result, "GAGAL", 5) == 0) failed++;
+    run_count++;
+  }
+  fclose(f);
+
+  write_csv(hasil);
+  if (update) write_csv(base);
+  printf("[BENCH] %d run, %d gagal, hasil di %s%s\n", run_count, failed, hasil, update ? " (baseline diperbarui)" : "");
+
+  wb_supervisor_simulation_quit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+  wb_robot_step(TIME_STEP);
+  wb_robot_cleanup();
+  return 0;
+}
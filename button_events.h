@@ -0,0 +1,183 @@
+// ===============================================================
+// button_events.h
+// Antrian event tombol dari interrupt pin-change, dipakai UI.c dan
+// line_maze1.c. Hanya C biasa: sketch membaca level tombol sendiri
+// (bit 1 = ditekan) dan memberi waktu millis().
+//
+//   ISR     : button_isr(q, level, millis())  -> simpan tepi + waktu
+//   loop()  : while (button_next(q, millis(), &ev)) ...
+//
+// Antrian tepi satu produsen (ISR) satu konsumen (loop), tanpa
+// mematikan interrupt: head hanya ditulis ISR, tail hanya ditulis loop.
+// Debounce per tombol: tepi pertama langsung diterima, pantulan dalam
+// debounce_ms diabaikan, dan level akhir dicocokkan lagi setelahnya.
+// Tahan >= long_ms -> BUTTON_LONG sekali, lalu BUTTON_REPEAT tiap
+// repeat_ms selama masih ditahan. Tombol yang sudah ditekan saat
+// button_init tidak menghasilkan event sampai dilepas.
+// ===============================================================
+#ifndef BUTTON_EVENTS_H
+#define BUTTON_EVENTS_H
+
+#include <stdint.h>
+
+#ifndef BUTTON_MAX
+#define BUTTON_MAX 8
+#endif
+#ifndef BUTTON_EDGES
+#define BUTTON_EDGES 16    // pangkat dua
+#endif
+#ifndef BUTTON_OUT
+#define BUTTON_OUT 8
+#endif
+
+enum { BUTTON_PRESS, BUTTON_RELEASE, BUTTON_LONG, BUTTON_REPEAT };
+
+typedef struct {
+  uint8_t button;
+  uint8_t type;
+  uint16_t ms;     // waktu kejadian (16 bit bawah millis)
+  uint16_t held;   // lama ditekan (ms) untuk BUTTON_RELEASE, LONG dan REPEAT
+} ButtonEvent;
+
+typedef struct {
+  // Parameter
+  uint8_t count;
+  uint16_t debounce_ms;
+  uint16_t long_ms;
+  uint16_t repeat_ms;
+
+  // ISR -> loop
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint8_t edge_level[BUTTON_EDGES];
+  volatile uint16_t edge_ms[BUTTON_EDGES];
+  uint8_t isr_level;
+  volatile uint8_t overflows;
+
+  // Sisi loop
+  uint8_t raw;         // level terakhir dari ISR
+  uint8_t stable;      // level setelah debounce
+  uint8_t long_sent;   // LONG sudah dikirim untuk tekanan ini
+  uint8_t ignore;      // ditahan sejak button_init, diabaikan sampai dilepas
+  uint16_t raw_ms[BUTTON_MAX];
+  uint16_t stable_ms[BUTTON_MAX];
+  uint16_t next_repeat[BUTTON_MAX];
+  ButtonEvent out[BUTTON_OUT];
+  uint8_t out_head;
+  uint8_t out_count;
+} ButtonQueue;
+
+static inline void button_init(ButtonQueue *q, uint8_t count, uint8_t level, uint16_t now) {
+  uint8_t b;
+  q->count = count;
+  q->debounce_ms = 25;
+  q->long_ms = 500;
+  q->repeat_ms = 120;
+  q->head = q->tail = 0;
+  q->isr_level = q->raw = q->stable = q->ignore = level;
+  q->long_sent = 0;
+  q->overflows = 0;
+  for (b = 0; b < BUTTON_MAX; b++) {
+    q->raw_ms[b] = now;
+    q->stable_ms[b] = (uint16_t)(now - q->debounce_ms);
+    q->next_repeat[b] = now;
+  }
+  q->out_head = q->out_count = 0;
+}
+
+// Dipanggil dari ISR pin-change (boleh juga ISR yang sama dengan encoder)
+static inline void button_isr(ButtonQueue *q, uint8_t level, uint16_t now) {
+  uint8_t next;
+  if (level == q->isr_level) return;
+  next = (q->head + 1) & (BUTTON_EDGES - 1);
+  if (next == q->tail) {
+    q->overflows++;
+    return;
+  }
+  q->isr_level = level;
+  q->edge_level[q->head] = level;
+  q->edge_ms[q->head] = now;
+  q->head = next;
+}
+
+static inline void button_emit(ButtonQueue *q, uint8_t b, uint8_t type, uint16_t ms, uint16_t held) {
+  ButtonEvent *e;
+  if (q->out_count >= BUTTON_OUT) return;
+  e = &q->out[(q->out_head + q->out_count++) % BUTTON_OUT];
+  e->button = b;
+  e->type = type;
+  e->ms = ms;
+  e->held = held;
+}
+
+// Perubahan level yang sudah lolos debounce
+static inline void button_accept(ButtonQueue *q, uint8_t b, uint16_t ms) {
+  uint8_t bit = 1 << b;
+  uint16_t held = (uint16_t)(ms - q->stable_ms[b]);
+  q->stable ^= bit;
+  q->stable_ms[b] = ms;
+  q->long_sent &= ~bit;
+  if (q->stable & bit) {
+    q->ignore &= ~bit;
+    button_emit(q, b, BUTTON_PRESS, ms, 0);
+  } else if (q->ignore & bit) {
+    q->ignore &= ~bit;  // ditahan sejak init: lepas tanpa event
+  } else {
+    button_emit(q, b, BUTTON_RELEASE, ms, held);
+  }
+}
+
+// Ambil satu event; 0 jika tidak ada. Murah jika tidak ada tombol yang aktif.
+static inline int button_next(ButtonQueue *q, uint16_t now, ButtonEvent *ev) {
+  uint8_t b;
+  while (q->out_count == 0 && q->tail != q->head) {
+    uint8_t t = q->tail;
+    uint8_t level = q->edge_level[t];
+    uint16_t ms = q->edge_ms[t];
+    uint8_t changed = level ^ q->raw;
+    q->tail = (t + 1) & (BUTTON_EDGES - 1);
+    q->raw = level;
+    for (b = 0; b < q->count; b++) {
+      uint8_t bit = 1 << b;
+      if (!(changed & bit)) continue;
+      q->raw_ms[b] = ms;
+      if ((level & bit) != (q->stable & bit) && (uint16_t)(ms - q->stable_ms[b]) >= q->debounce_ms)
+        button_accept(q, b, ms);
+    }
+  }
+
+  if (q->out_count == 0 && (q->raw ^ q->stable)) {
+    // pantulan berakhir di level lain dari yang diterima: cocokkan setelah tenang
+    for (b = 0; b < q->count; b++) {
+      uint8_t bit = 1 << b;
+      if ((q->raw ^ q->stable) & bit && (int16_t)(now - q->raw_ms[b]) >= (int16_t)q->debounce_ms)
+        button_accept(q, b, q->raw_ms[b]);
+    }
+  }
+
+  if (q->out_count == 0 && (q->stable & ~q->ignore)) {
+    for (b = 0; b < q->count; b++) {
+      uint8_t bit = 1 << b;
+      int16_t held = (int16_t)(now - q->stable_ms[b]);  // < 0 jika tepi datang setelah now dibaca
+      if (!(q->stable & ~q->ignore & bit) || held < 0) continue;
+      if (!(q->long_sent & bit)) {
+        if (held >= (int16_t)q->long_ms) {
+          q->long_sent |= bit;
+          q->next_repeat[b] = (uint16_t)(now + q->repeat_ms);
+          button_emit(q, b, BUTTON_LONG, now, held);
+        }
+      } else if ((int16_t)(now - q->next_repeat[b]) >= 0) {
+        q->next_repeat[b] = (uint16_t)(q->next_repeat[b] + q->repeat_ms);
+        button_emit(q, b, BUTTON_REPEAT, now, held);
+      }
+    }
+  }
+
+  if (q->out_count == 0) return 0;
+  *ev = q->out[q->out_head];
+  q->out_head = (q->out_head + 1) % BUTTON_OUT;
+  q->out_count--;
+  return 1;
+}
+
+#endif
@@ -0,0 +1,195 @@
+// ===============================================================
+// camera_bench.cpp
+// Uji dan benchmark kernel look-ahead kamera (line_camera.h) di PC,
+// tanpa Webots. Gambar BGRA dibuat sintetis dengan geometri kamera yang
+// sama seperti controller (CAMERA_HEIGHT / CAMERA_PITCH), lalu:
+//   - kernel SSE2 dibandingkan dengan versi skalar di semua baris
+//   - hasil offset / heading / simpang dicetak per adegan dan dicek
+//   - biaya lookahead_update per langkah dibandingkan dengan TIME_STEP
+//
+// Kompilasi:  g++ -O2 -o camera_bench camera_bench.cpp
+// Pakai:      ./camera_bench [-W lebar] [-H tinggi] [-f fov] [-n ulang]
+//   default 160 x 120, fov 0.7854 (Camera Webots bawaan), 100000 ulang
+// Exit code != 0 jika SSE2 dan skalar berbeda atau simpang tidak terdeteksi.
+// ===============================================================
+#include "line_camera.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define TIME_STEP 32
+#define CAMERA_HEIGHT 0.08f
+#define CAMERA_PITCH 0.52f
+#define LINE_WIDTH 0.025f
+
+// Adegan di lantai: f = maju (m), l = lateral (m, + = kanan)
+static bool sceneStraight(float, float l) { return fabsf(l) < LINE_WIDTH / 2; }
+
+static bool sceneCurve(float f, float l) {
+  const float start = 0.10f, r = 0.25f;  // tikungan kanan r = 0.25 m mulai 0.10 m
+  if (f < start) return fabsf(l) < LINE_WIDTH / 2;
+  return l < r && fabsf(hypotf(f - start, l - r) - r) < LINE_WIDTH / 2;
+}
+
+static bool sceneT(float f, float l) {
+  const float at = 0.22f;
+  return (f < at && fabsf(l) < LINE_WIDTH / 2) || fabsf(f - at) < LINE_WIDTH / 2;
+}
+
+static bool sceneBranchRight(float f, float l) {
+  const float at = 0.22f;
+  return fabsf(l) < LINE_WIDTH / 2 || (l > 0 && fabsf(f - at) < LINE_WIDTH / 2);
+}
+
+static bool sceneEnd(float f, float l) { return f < 0.18f && fabsf(l) < LINE_WIDTH / 2; }
+
+struct Scene {
+  const char *name;
+  bool (*dark)(float, float);
+  char junction;  // petunjuk yang diharapkan
+};
+
+static void render(const LineLookahead &la, bool (*dark)(float, float), std::vector<uint8_t> &img) {
+  float s = sinf(la.pitch), c = cosf(la.pitch);
+  img.assign(4 * la.width * la.height, 0);
+  for (int v = 0; v < la.height; v++) {
+    float yc = (v + 0.5f - la.height / 2.0f) / la.focal;
+    float down = s + yc * c;
+    for (int u = 0; u < la.width; u++) {
+      uint8_t *px = &img[4 * (v * la.width + u)];
+      uint8_t g = 230;  // lantai putih, langit juga terang
+      if (down > 0) {
+        float t = la.cam_height / down;
+        float f = t * (c - yc * s), l = t * (u + 0.5f - la.width / 2.0f) / la.focal;
+        if (dark(f, l)) g = 25;
+      }
+      g = (uint8_t)(g + (u * 7 + v * 13) % 11);  // sedikit tekstur
+      px[0] = g; px[1] = g; px[2] = g; px[3] = 255;
+    }
+  }
+}
+
+static bool sameScan(const LineRowScan &a, const LineRowScan &b) {
+  return a.count == b.count && a.sum == b.sum && a.first == b.first && a.last == b.last;
+}
+
+// SSE2 vs skalar pada semua baris gambar
+static int checkKernel(const std::vector<uint8_t> &img, int width, int height, uint8_t th) {
+  int bad = 0;
+  for (int v = 0; v < height; v++) {
+    LineRowScan simd, ref = {0, 0, -1, -1};
+    lookahead_scan_row(&img[4 * v * width], width, th, &simd);
+    lookahead_scan_row_scalar(&img[4 * v * width], 0, width, th, &ref);
+    if (!sameScan(simd, ref)) bad++;
+  }
+  return bad;
+}
+
+int main(int argc, char **argv) {
+  int width = 160, height = 120;
+  long repeat = 100000;
+  float fov = 0.7854f;
+  int opt;
+  while ((opt = getopt(argc, argv, "W:H:f:n:")) != -1) {
+    switch (opt) {
+      case 'W': width = atoi(optarg); break;
+      case 'H': height = atoi(optarg); break;
+      case 'f': fov = (float)atof(optarg); break;
+      case 'n': repeat = atol(optarg); break;
+      default:
+        fprintf(stderr, "pakai: %s [-W lebar] [-H tinggi] [-f fov] [-n ulang]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (width < 1 || height < 1 || repeat < 1) return 2;
+
+  static const Scene scenes[] = {
+    {"lurus", sceneStraight, '\0'},
+    {"tikungan", sceneCurve, '\0'},
+    {"simpang_t", sceneT, 'T'},
+    {"cabang_kanan", sceneBranchRight, 'R'},
+    {"ujung", sceneEnd, 'E'},
+  };
+  int failures = 0;
+  LineLookahead la;
+  lookahead_init(&la, width, height, fov, CAMERA_HEIGHT, CAMERA_PITCH);
+  la.line_width = LINE_WIDTH;
+
+#ifdef __SSE2__
+  const char *kernel = "SSE2";
+#else
+  const char *kernel = "skalar";
+#endif
+  printf("kamera %dx%d fov %.3f, kernel %s, baris:", width, height, fov, kernel);
+  for (int r = 0; r < LOOKAHEAD_ROWS; r++) {
+    if (la.row[r] < 0) printf(" %.2fm=luar", la.distance[r]);
+    else printf(" %.2fm=v%d(%.3f)", la.distance[r], la.row[r], la.forward[r]);
+  }
+  printf("\n");
+
+  std::vector<uint8_t> img;
+  for (const Scene &sc : scenes) {
+    render(la, sc.dark, img);
+    int bad = checkKernel(img, width, height, la.threshold);
+    lookahead_update(&la, img.data());
+    printf("%-13s offset(mm):", sc.name);
+    for (int r = 0; r < LOOKAHEAD_ROWS; r++) {
+      if (la.seen[r]) printf(" %6.1f", la.offset[r] * 1000);
+      else printf("      -");
+    }
+    printf("  heading %6.3f rad  kelengkungan %6.2f /m  simpang %c", la.heading, la.curvature,
+           la.junction ? la.junction : '-');
+    if (la.junction) printf(" @%.2fm", la.junction_distance);
+    if (bad) printf("  [%d baris SSE2 != skalar]", bad);
+    bool ok = !bad && la.junction == sc.junction;
+    printf("  %s\n", ok ? "OK" : "GAGAL");
+    if (!ok) failures++;
+  }
+
+  // Derau acak: semua kemungkinan nilai di sekitar ambang, lebar tidak kelipatan 16
+  {
+    std::vector<uint8_t> noise(4 * (width + 5) * 8);
+    uint32_t x = 12345;
+    for (auto &b : noise) {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      b = (uint8_t)x;
+    }
+    for (int th = 0; th < 256; th += 17) {
+      int bad = checkKernel(noise, width + 5, 8, (uint8_t)th);
+      if (bad) {
+        printf("derau ambang %d: %d baris SSE2 != skalar  GAGAL\n", th, bad);
+        failures++;
+      }
+    }
+  }
+
+  // Biaya per langkah (lookahead_update = LOOKAHEAD_ROWS baris) vs pindai seluruh gambar
+  render(la, sceneCurve, img);
+  la.kernel_us_sum = la.kernel_us_max = 0;
+  la.steps = 0;
+  volatile int sink = 0;
+  double t0 = lookahead_clock_us();
+  for (long i = 0; i < repeat; i++) {
+    lookahead_update(&la, img.data());
+    sink += la.seen[0];
+  }
+  double step_us = (lookahead_clock_us() - t0) / repeat;
+
+  long full_repeat = repeat / height + 1;
+  t0 = lookahead_clock_us();
+  for (long i = 0; i < full_repeat; i++) {
+    for (int v = 0; v < height; v++) {
+      LineRowScan scan = {0, 0, -1, -1};
+      lookahead_scan_row_scalar(&img[4 * v * width], 0, width, la.threshold, &scan);
+      sink += scan.count;
+    }
+  }
+  double full_us = (lookahead_clock_us() - t0) / full_repeat;
+
+  printf("lookahead_update: %.3f us/langkah (maks %.1f us) = %.4f%% dari TIME_STEP %d ms\n", step_us,
+         la.kernel_us_max, step_us / (TIME_STEP * 10.0), TIME_STEP);
+  printf("pindai skalar seluruh gambar: %.2f us = %.4f%% dari TIME_STEP\n", full_us, full_us / (TIME_STEP * 10.0));
+  return failures ? 1 : 0;
+}
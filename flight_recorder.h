@@ -0,0 +1,166 @@
+// ===============================================================
+// flight_recorder.h
+// Perekam kejadian (black box) untuk line_maze1.c: ring buffer di RAM
+// yang selalu menyimpan FR_RECORDS frame terakhir (sensorStates, error,
+// koreksi PID, duty motor, mode). Saat ada pemicu (garis hilang sampai
+// recovery menyerah, tombol, finish) buffer dibekukan lalu disalin ke
+// EEPROM, sehingga kegagalan di lapangan bisa dibaca belakangan lewat
+// Serial (perintah DUMP tune_cli) tanpa laptop tersambung saat lomba.
+//
+//   tiap scan sensor : fr_record(fr, &frame, millis())
+//   pemicu           : fr_trigger(fr, FR_CAUSE_..., millis())
+//   loop()           : fr_persist_step(fr, base, write, ready)
+//
+// Penyalinan ke EEPROM tidak blocking: satu tulisan EEPROM AVR ~3.4 ms,
+// jadi fr_persist_step() hanya menulis selama ready() (EEPROM tidak
+// sibuk) dan dilanjutkan di panggilan berikutnya; 500 an byte selesai
+// dalam beberapa detik loop biasa tanpa menahan loop PID. Magic header
+// dihapus dulu dan ditulis paling akhir, jadi salinan yang terputus
+// (reset/baterai dicabut) terbaca kosong, bukan sampah. Selama belum
+// selesai disalin, buffer tetap beku dan pemicu lain diabaikan; setelah
+// selesai perekaman jalan lagi.
+//
+// Tata letak EEPROM mulai base: magic, sebab, jumlah frame, ukuran frame,
+// waktu pemicu (ms, 32 bit), lalu frame urut dari yang paling lama.
+// Hanya C biasa; akses EEPROM lewat pointer fungsi seperti tune_save().
+// ===============================================================
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef FR_RECORDS
+#define FR_RECORDS 64            // ~1 detik pada loop ~16 ms; 8 byte RAM per frame
+#endif
+#define FR_EEPROM_MAGIC 0x46
+#define FR_HEADER_SIZE 8
+
+enum { FR_CAUSE_NONE, FR_CAUSE_LOST, FR_CAUSE_BUTTON, FR_CAUSE_FINISH, FR_CAUSES };
+static const char *const fr_cause_names[FR_CAUSES] = {"-", "garis hilang", "tombol", "finish"};
+
+// Bit mode; 4 bit bawah = fase recovery (RecoveryPhase)
+#define FR_MODE_PHASE 0x0F
+#define FR_MODE_TURNING 0x10     // manuver belok/simpang yang blocking
+#define FR_MODE_SPEED_RUN 0x20
+#define FR_MODE_BRAKE 0x40
+#define FR_MODE_DONE 0x80        // eksplorasi selesai
+
+typedef struct {
+  uint8_t sensors;     // sensorStates
+  uint8_t mode;
+  uint8_t dt_ms;       // sejak frame sebelumnya, jenuh 255
+  int8_t error_q4;     // error garis x 16
+  int16_t correction;  // koreksi PID (satuan duty)
+  int8_t pwm_left;     // duty motor / 2
+  int8_t pwm_right;
+} FlightRecord;
+
+typedef struct {
+  FlightRecord buf[FR_RECORDS];
+  uint8_t head;        // slot berikutnya
+  uint8_t count;
+  uint8_t cause;       // != FR_CAUSE_NONE = beku
+  uint32_t trigger_ms;
+  uint32_t last_ms;
+  int persist_pos;     // byte berikutnya yang disalin, -1 = tidak sedang menyalin
+} FlightRecorder;
+
+static inline void fr_init(FlightRecorder *fr) {
+  memset(fr, 0, sizeof(*fr));
+  fr->persist_pos = -1;
+}
+
+static inline int8_t fr_pack_duty(int duty) {
+  if (duty > 255) duty = 255;
+  if (duty < -255) duty = -255;
+  return (int8_t)(duty / 2);
+}
+
+static inline void fr_record(FlightRecorder *fr, const FlightRecord *r, uint32_t now_ms) {
+  FlightRecord *slot;
+  uint32_t dt;
+  if (fr->cause != FR_CAUSE_NONE) return;
+  dt = fr->count ? now_ms - fr->last_ms : 0;
+  fr->last_ms = now_ms;
+  slot = &fr->buf[fr->head];
+  *slot = *r;
+  slot->dt_ms = dt > 255 ? 255 : (uint8_t)dt;
+  fr->head = (uint8_t)((fr->head + 1) % FR_RECORDS);
+  if (fr->count < FR_RECORDS) fr->count++;
+}
+
+// Bekukan buffer dan mulai salin ke EEPROM. 0 jika masih ada salinan sebelumnya.
+static inline int fr_trigger(FlightRecorder *fr, uint8_t cause, uint32_t now_ms) {
+  if (fr->cause != FR_CAUSE_NONE || fr->count == 0) return 0;
+  fr->cause = cause;
+  fr->trigger_ms = now_ms;
+  fr->persist_pos = 0;
+  return 1;
+}
+
+// Frame ke-i dari yang paling lama (0 .. count-1)
+static inline const FlightRecord *fr_at(const FlightRecorder *fr, uint8_t i) {
+  return &fr->buf[(fr->head + FR_RECORDS - fr->count + i) % FR_RECORDS];
+}
+
+static inline uint8_t fr_header_byte(const FlightRecorder *fr, int i) {
+  switch (i) {
+    case 0: return FR_EEPROM_MAGIC;
+    case 1: return fr->cause;
+    case 2: return fr->count;
+    case 3: return (uint8_t)sizeof(FlightRecord);
+    default: return (uint8_t)(fr->trigger_ms >> (8 * (i - 4)));
+  }
+}
+
+// Lanjutkan penyalinan selama ready() != 0. 1 = selesai (atau tidak ada yang disalin).
+// Urutan: hapus magic, frame, header tanpa magic, terakhir magic.
+static inline int fr_persist_step(FlightRecorder *fr, int base,
+                                  void (*write)(int, uint8_t), int (*ready)(void)) {
+  int data = fr->count * (int)sizeof(FlightRecord);
+  while (fr->persist_pos >= 0) {
+    int p = fr->persist_pos;
+    if (!ready()) return 0;
+    if (p == 0) {
+      write(base, 0xFF);
+    } else if (p <= data) {
+      const uint8_t *rec = (const uint8_t *)fr_at(fr, (uint8_t)((p - 1) / sizeof(FlightRecord)));
+      write(base + FR_HEADER_SIZE + p - 1, rec[(p - 1) % sizeof(FlightRecord)]);
+    } else if (p < data + FR_HEADER_SIZE) {
+      write(base + p - data, fr_header_byte(fr, p - data));
+    } else {
+      write(base, FR_EEPROM_MAGIC);
+      fr->persist_pos = -1;
+      fr->cause = FR_CAUSE_NONE;  // perekaman jalan lagi dari buffer kosong
+      fr->count = 0;
+      fr->head = 0;
+      return 1;
+    }
+    fr->persist_pos++;
+  }
+  return 1;
+}
+
+// Baca header rekaman di EEPROM tanpa memuat semua frame ke RAM. 0 jika kosong/rusak.
+static inline int fr_load_header(int base, uint8_t (*read)(int), uint8_t *cause, uint8_t *count,
+                                 uint32_t *trigger_ms) {
+  int i;
+  if (read(base) != FR_EEPROM_MAGIC || read(base + 3) != sizeof(FlightRecord) ||
+      read(base + 2) > FR_RECORDS || read(base + 1) >= FR_CAUSES) return 0;
+  *cause = read(base + 1);
+  *count = read(base + 2);
+  *trigger_ms = 0;
+  for (i = 0; i < 4; i++) *trigger_ms |= (uint32_t)read(base + 4 + i) << (8 * i);
+  return 1;
+}
+
+// Frame ke-i (dari yang paling lama) dari rekaman di EEPROM
+static inline void fr_load_record(int base, uint8_t (*read)(int), uint8_t i, FlightRecord *r) {
+  uint8_t k;
+  for (k = 0; k < sizeof(FlightRecord); k++) {
+    ((uint8_t *)r)[k] = read(base + FR_HEADER_SIZE + i * (int)sizeof(FlightRecord) + k);
+  }
+}
+
+#endif
@@ -1,13 +1,43 @@
 #include <webots/robot.h>
 #include <webots/motor.h>
 #include <webots/distance_sensor.h>
+#include <webots/camera.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "line_recovery.h"
+#include "sensor_noise.h"
+#include "line_camera.h"
+#include "adaptive_threshold.h"
 
 #define TIME_STEP 32
 #define MAX_SPEED 10.0
 #define BASE_SPEED 8.0
 #define THRESHOLD 300
 #define NOISE_THRESHOLD 200
+#define CAMERA_HEIGHT 0.08f  // tinggi kamera di atas lantai (m), sesuaikan dengan world
+#define CAMERA_PITCH 0.52f   // kamera menunduk (rad)
+#define JUNCTION_SLOW_DIST 0.25f  // m
+
+#define PATH_MAX_LEN 64
+#define PROBE_STEPS 18       // maju pelan setelah cabang terlihat sampai poros roda di simpang
+                             // (jarak sensor ke poros / kecepatan CEK_SIMPANG, sesuaikan dengan robot)
+#define JUNCTION_HOLDOFF 6   // langkah setelah simpang, cabang yang sama diabaikan
+#define TURN_MIN_STEPS 6
+#define TURN_MAX_STEPS 150   // belok terlalu lama -> cari garis
+#define DEAD_END_STEPS 3     // garis hilang di tengah selama ini = jalan buntu
+
+// Governor kecepatan dari kelengkungan lintasan (--governor; bawaan tetap pengali
+// kontras lama). Geometri sesuaikan dengan robot.
+#define WHEEL_RADIUS 0.02       // m
+#define AXLE_TRACK 0.10         // m, jarak antar roda
+#define SENSOR_AHEAD 0.06       // m, baris IR di depan poros roda
+#define SENSOR_HALF_SPAN 0.042  // m, posisi garis +-1 = IR1 / IR8
+#define LAT_ACCEL_MAX 0.4       // m/s^2, batas percepatan lateral (--alat=)
+#define LONG_ACCEL_MAX 0.4      // m/s^2, percepatan maju di lurus (--along=)
+#define CURVE_WINDOW 6          // langkah riwayat untuk rata-rata kelengkungan
+#define GOV_MIN 0.5             // speed_multiplier minimum
+#define GOV_MAX 1.5             // sama dengan batas atas pengali lama
 
 typedef enum {
   MODE_LURUS,
@@ -16,13 +46,120 @@ typedef enum {
   MODE_CARI,
   MODE_PERTIGAAN_KIRI,
   MODE_PERTIGAAN_KANAN,
-  MODE_PEREMPATAN,
-  MODE_PUTAR_BALIK
+  MODE_CEK_SIMPANG,
+  MODE_PUTAR_BALIK,
+  MODE_MUNDUR,
+  MODE_FINISH
 } Mode;
 
+// Eksplorasi -> finish -> kembali ke start lewat path terbalik -> run cepat
+typedef enum {
+  RUN_EKSPLORASI,
+  RUN_KEMBALI,
+  RUN_CEPAT,
+  RUN_SELESAI
+} Run;
+
 float speed_multiplier = 1.0;
 
-int main() {
+// ========== Governor kecepatan ==========
+// Kelengkungan lintasan = kelengkungan robot + perubahan arah garis relatif robot:
+//   - robot: dari perintah roda, kappa = 2 (vl - vr) / (b (vl + vr)), dirata-rata
+//     CURVE_WINDOW langkah sehingga koreksi kiri-kanan di lurus saling hapus
+//   - garis: kemiringan posisi garis terhadap jarak tempuh (regresi di jendela
+//     yang sama); garis yang bergeser ke samping = tikungan datang sebelum robot
+//     ikut berbelok. Offset tetap (robot sejajar garis) tidak dihitung.
+// Kecepatan v = sqrt(a_lat / |kappa|), turun seketika, naik dibatasi a_long.
+// Dengan --kamera kelengkungan dari look-ahead ikut dipakai sebagai pratinjau.
+typedef struct {
+  float lat_accel, long_accel;       // m/s^2
+  float cmd[CURVE_WINDOW];           // kelengkungan perintah roda (1/m)
+  float offset[CURVE_WINDOW];        // posisi garis (m, + = kanan)
+  float dist[CURVE_WINDOW];          // jarak tempuh (m)
+  int count, index;
+  float travelled;
+  float curvature;                   // 1/m, perkiraan terakhir (+ = kanan)
+  float speed;                       // m/s, kecepatan dasar terpilih
+} SpeedGovernor;
+
+static void gov_init(SpeedGovernor *g) {
+  g->lat_accel = LAT_ACCEL_MAX;
+  g->long_accel = LONG_ACCEL_MAX;
+  g->count = g->index = 0;
+  g->travelled = 0;
+  g->curvature = 0;
+  g->speed = BASE_SPEED * WHEEL_RADIUS;
+}
+
+// Satu langkah: posisi garis (-1..1, + = kanan), perintah roda sebelumnya (rad/s),
+// kelengkungan pratinjau kamera (0 = tidak ada). Hasil: speed_multiplier.
+static float gov_update(SpeedGovernor *g, float position, double left, double right, float preview, float dt) {
+  float sum_cmd = 0, ms = 0, my = 0, sss = 0, ssy = 0, kappa, target;
+  float vmin = GOV_MIN * BASE_SPEED * WHEEL_RADIUS, vmax = GOV_MAX * BASE_SPEED * WHEEL_RADIUS;
+  int i;
+  g->travelled += WHEEL_RADIUS * (left + right) / 2 * dt;
+  g->cmd[g->index] = left + right > 0.1 ? 2 * (left - right) / (AXLE_TRACK * (left + right)) : 0;
+  g->offset[g->index] = position * SENSOR_HALF_SPAN;
+  g->dist[g->index] = g->travelled;
+  g->index = (g->index + 1) % CURVE_WINDOW;
+  if (g->count < CURVE_WINDOW) g->count++;
+
+  for (i = 0; i < g->count; i++) {
+    sum_cmd += g->cmd[i];
+    ms += g->dist[i];
+    my += g->offset[i];
+  }
+  ms /= g->count;
+  my /= g->count;
+  for (i = 0; i < g->count; i++) {
+    sss += (g->dist[i] - ms) * (g->dist[i] - ms);
+    ssy += (g->dist[i] - ms) * (g->offset[i] - my);
+  }
+  g->curvature = sum_cmd / g->count;
+  if (sss > 1e-6f) g->curvature += ssy / sss / SENSOR_AHEAD;  // arah garis relatif / jarak sensor
+
+  kappa = fabsf(g->curvature);
+  if (fabsf(preview) > kappa) kappa = fabsf(preview);
+  target = kappa > 1e-3f ? sqrtf(g->lat_accel / kappa) : vmax;
+  if (target > vmax) target = vmax;
+  if (target < vmin) target = vmin;
+  if (target < g->speed) g->speed = target;
+  else if (g->speed + g->long_accel * dt < target) g->speed += g->long_accel * dt;
+  else g->speed = target;
+  return g->speed / (BASE_SPEED * WHEEL_RADIUS);
+}
+
+// ========== Path maze (tangan kiri, reduksi online) ==========
+char path[PATH_MAX_LEN + 1];
+int path_length = 0;
+int raw_turns = 0;  // keputusan sebelum reduksi
+
+static int turn_angle(char c) {
+  return c == 'L' ? 270 : c == 'R' ? 90 : c == 'U' ? 180 : 0;
+}
+
+// xUy diganti satu belokan dengan sudut total yang sama (LUR=U, LUS=R, LUL=S, SUL=R, ...)
+static void path_add(char c) {
+  raw_turns++;
+  if (path_length >= PATH_MAX_LEN) return;
+  path[path_length++] = c;
+  while (path_length >= 3 && path[path_length - 2] == 'U') {
+    int total = turn_angle(path[path_length - 3]) + 180 + turn_angle(path[path_length - 1]);
+    path_length -= 3;
+    path[path_length++] = "SRUL"[total % 360 / 90];
+  }
+  path[path_length] = '\0';
+}
+
+static char left_hand(bool left, bool straight, bool right) {
+  return left ? 'L' : straight ? 'S' : right ? 'R' : 'U';
+}
+
+static char mirror_turn(char c) {
+  return c == 'L' ? 'R' : c == 'R' ? 'L' : c;
+}
+
+int main(int argc, char **argv) {
   wb_robot_init();
 
   WbDeviceTag motor_kiri = wb_robot_get_device("motorkiri");
@@ -40,64 +177,139 @@ int main() {
     wb_distance_sensor_enable(ir_sensors[i], TIME_STEP);
   }
 
+  SensorNoise noise;
+  noise_init(&noise, argc, argv);  // derau dari argumen benchmark
+
+  // Ambang garis adaptif per sensor; --ambang-tetap = THRESHOLD lama
+  AdaptiveThreshold adapt;
+  bool adaptive = true;
+  bool governor = false;
+  adapt_init(&adapt, wb_distance_sensor_get_min_value(ir_sensors[0]),
+             wb_distance_sensor_get_max_value(ir_sensors[0]), THRESHOLD, NOISE_THRESHOLD);
+
+  // Kamera look-ahead opsional (--kamera), robot harus punya Camera "camera"
+  WbDeviceTag camera = 0;
+  LineLookahead look = {0};  // tanpa kamera: seen[] tetap 0
+  SpeedGovernor gov;
+  gov_init(&gov);
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--kamera") == 0) camera = wb_robot_get_device("camera");
+    else if (strncmp(argv[i], "--alat=", 7) == 0) gov.lat_accel = atof(argv[i] + 7);
+    else if (strncmp(argv[i], "--along=", 8) == 0) gov.long_accel = atof(argv[i] + 8);
+    else if (strcmp(argv[i], "--ambang-tetap") == 0) adaptive = false;
+    else if (strcmp(argv[i], "--governor") == 0) governor = true;
+  }
+  if (camera) {
+    wb_camera_enable(camera, TIME_STEP);
+    lookahead_init(&look, wb_camera_get_width(camera), wb_camera_get_height(camera),
+                   (float)wb_camera_get_fov(camera), CAMERA_HEIGHT, CAMERA_PITCH);
+  }
+
   Mode mode = MODE_CARI;
   int cross_timer = 0;
   int turn_timer = 0; // Timer untuk mempertahankan belokan
 
+  Run run = RUN_EKSPLORASI;
+  int path_index = 0;
+  int probe_steps = 0, turn_steps = 0, lost_steps = 0;
+  bool probe_left = false, probe_right = false;
+  bool probe_passed = false, probe_straight = false;  // sensor sudah melewati cabang, ada garis lurus
+  bool turn_left_line = false;  // sensor tengah sudah lepas dari garis lama
+  double run_start = 0, explore_time = 0, return_time = 0;
+  double last_left = 0, last_right = 0;  // perintah roda langkah sebelumnya, untuk governor
+
+  // Pencarian garis bertahap berdasarkan riwayat posisi garis.
+  // Di maze spiral dibuat pendek supaya robot tidak keluar jalur.
+  LineRecovery recovery;
+  recovery_init(&recovery);
+  recovery.arc_time = 0.8f;
+  recovery.center_band = 0.3f;  // jalan buntu: garis habis saat robot kurang lebih lurus
+
   while (wb_robot_step(TIME_STEP) != -1) {
     double sensor_values[8];
     int active_sensors = 0;
     int active_left = 0, active_right = 0, active_center = 0;
     float line_quality = 0.0;
+    float position = 0.0; // -1 kiri .. +1 kanan (IR1 paling kanan)
 
     printf("Sensor IR: ");
     for (int i = 0; i < 8; i++) {
-      sensor_values[i] = wb_distance_sensor_get_value(ir_sensors[i]);
+      sensor_values[i] = noise_apply(&noise, wb_distance_sensor_get_value(ir_sensors[i]));
       printf("IR%d: %.0f ", i + 1, sensor_values[i]);
+    }
+    printf("\n");
+    if (adaptive) adapt_update(&adapt, sensor_values);
+    if (adaptive && adapt.steps % 100 == 0) {
+      printf("[AMBANG] update rata-rata %.2f us, maks %.1f us | IR1..8:", adapt.update_us_sum / adapt.steps,
+             adapt.update_us_max);
+      // T = nilai tetap, G = histogram gabungan, S = histogram sensor sendiri
+      for (int i = 0; i < 8; i++) printf(" %.0f%c", adapt.threshold[i], "TGS"[adapt.source[i]]);
+      printf("\n");
+    }
 
-      if (sensor_values[i] > NOISE_THRESHOLD) {
-        if (sensor_values[i] > THRESHOLD) {
-          active_sensors++;
-          line_quality += (sensor_values[i] - THRESHOLD) / 100.0;
-        }
+    bool on_line[8];
+    for (int i = 0; i < 8; i++) {
+      on_line[i] = adapt_is_line(&adapt, i, sensor_values[i]);
+      if (!on_line[i]) continue;
+      active_sensors++;
+      line_quality += (sensor_values[i] - adapt.threshold[i]) / 100.0;  // --ambang-tetap: = THRESHOLD
+      position += (3.5 - i) / 3.5;
+      if (i < 2) active_right++;
+      else if (i > 5) active_left++;
+      else active_center++;
+    }
 
-        if (i < 2) {
-          if (sensor_values[i] > THRESHOLD) active_right++;
-        }
-        else if (i > 5) {
-          if (sensor_values[i] > THRESHOLD) active_left++;
-        }
-        else {
-          if (sensor_values[i] > THRESHOLD) active_center++;
-        }
+    if (camera) {
+      const unsigned char *image = wb_camera_get_image(camera);
+      if (image) lookahead_update(&look, image);
+      if (look.steps > 0 && look.steps % 100 == 0) {
+        double avg = look.kernel_us_sum / look.steps;
+        printf("[KAMERA] kernel rata-rata %.1f us, maks %.1f us (%.3f%% dari TIME_STEP %d ms)\n",
+               avg, look.kernel_us_max, avg / (TIME_STEP * 10.0), TIME_STEP);
+      }
+    }
+
+    double now = wb_robot_get_time();
+    if (active_sensors > 0) {
+      recovery_track(&recovery, position / active_sensors);
+      if (recovery_active(&recovery)) {
+        RecoveryPhase found = recovery.phase;
+        recovery_end(&recovery, (float)now);
+        printf("[PEMULIHAN] #%u garis ditemukan di fase %s setelah %.2f s (rata-rata %.2f s, maks %.2f s, gagal %u)\n",
+               recovery.losses, recovery_phase_names[found], recovery.last_time,
+               recovery.total_time / recovery.losses, recovery.max_time, recovery.failures);
       }
     }
-    printf(" | Kualitas: %.1f\n", line_quality);
-
-    speed_multiplier = 0.8 + (line_quality / 20.0);
-    if (speed_multiplier > 1.5) speed_multiplier = 1.5;
-    if (speed_multiplier < 0.8) speed_multiplier = 0.8;
-
-    bool t_junction_left = (active_center >= 2) && 
-                          (active_left >= 2) && 
-                          (active_right == 0) &&
-                          (sensor_values[5] < THRESHOLD && 
-                           sensor_values[6] > THRESHOLD && 
-                           sensor_values[7] > THRESHOLD);
-
-    bool t_junction_right = (active_center >= 2) && 
-                           (active_right >= 2) && 
-                           (active_left == 0) &&
-                           (sensor_values[0] > THRESHOLD && 
-                            sensor_values[1] > THRESHOLD && 
-                            sensor_values[2] > THRESHOLD &&
-                            sensor_values[5] < THRESHOLD &&
-                            sensor_values[6] < THRESHOLD &&
-                            sensor_values[7] < THRESHOLD);
-
-    bool crossroad = (active_center >= 4) && 
-                    (active_left >= 2) && 
-                    (active_right >= 2);
+
+    // Bawaan: pengali dari kontras garis. Governor (--governor) hanya belajar saat
+    // mengikuti garis; belok di simpang, cek simpang, mundur dan pencarian memakai
+    // kecepatan tetap sendiri
+    if (!governor) {
+      speed_multiplier = 0.8 + (line_quality / 20.0);
+      if (speed_multiplier > 1.5) speed_multiplier = 1.5;
+      if (speed_multiplier < 0.8) speed_multiplier = 0.8;
+    } else {
+      if (active_sensors > 0 && (mode == MODE_LURUS || mode == MODE_KANAN || mode == MODE_KIRI)) {
+        float preview = camera && look.steps > 0 ? look.curvature : 0;
+        speed_multiplier = gov_update(&gov, position / active_sensors, last_left, last_right, preview, TIME_STEP / 1000.0f);
+      }
+      printf("[GOV] kelengkungan %.2f /m -> %.3f m/s (x%.2f)\n",
+             gov.curvature, speed_multiplier * BASE_SPEED * WHEEL_RADIUS, speed_multiplier);
+    }
+
+    // Petunjuk simpang dari kamera: pelan sebelum sensor IR sampai di simpang
+    if (camera && look.junction && look.junction_distance < JUNCTION_SLOW_DIST) {
+      if (speed_multiplier > 0.8) speed_multiplier = 0.8;
+      printf("[KAMERA] simpang %c di depan %.2f m, heading %.2f rad\n",
+             look.junction, look.junction_distance, look.heading);
+    }
+
+    // Cabang: sensor pinggir dan tengah hitam bersamaan, lebih lebar dari garis miring biasa
+    bool arm_left = active_left >= 2 && active_center >= 1 && active_sensors >= 5;
+    bool arm_right = active_right >= 2 && active_center >= 1 && active_sensors >= 5;
+    bool on_center = on_line[3] || on_line[4];
+    bool centered = active_sensors > 0 && active_sensors <= 3 && fabs(position / active_sensors) < 0.2;
+    lost_steps = active_sensors == 0 ? lost_steps + 1 : 0;
 
     // Hitung kekuatan relatif untuk belok
     int left_strength = active_left * 100 + (sensor_values[6] + sensor_values[7]) / 2;
@@ -106,20 +318,105 @@ int main() {
 
     printf("Strength - Left: %d, Right: %d, Center: %d\n", left_strength, right_strength, center_strength);
 
-    if (t_junction_left && cross_timer == 0) {
-      mode = MODE_PERTIGAAN_KIRI;
-      cross_timer = 5;
-      printf("+++++ PERTIGAAN KIRI DETECTED +++++\n");
+    // Keputusan di simpang / finish / jalan buntu; 'L','R','U' memulai belokan
+    char turn = '\0';
+
+    if (run == RUN_SELESAI) {
+      mode = MODE_FINISH;
+    }
+    else if (mode == MODE_PERTIGAAN_KIRI || mode == MODE_PERTIGAAN_KANAN || mode == MODE_PUTAR_BALIK) {
+      // Belok sampai sensor tengah lepas dari garis lama lalu menemukan garis baru
+      turn_steps++;
+      if (!on_center) turn_left_line = true;
+      if (turn_steps >= TURN_MIN_STEPS && turn_left_line && centered) {
+        mode = MODE_LURUS;
+        cross_timer = JUNCTION_HOLDOFF;
+      }
+      else if (turn_steps > TURN_MAX_STEPS) {
+        mode = MODE_CARI;
+      }
+    }
+    else if (mode == MODE_MUNDUR) {
+      // Mundur keluar dari kotak finish sampai hanya garis biasa yang terlihat
+      if (active_sensors > 0 && active_sensors <= 3 && on_center) turn = 'U';
+    }
+    else if (mode == MODE_CEK_SIMPANG) {
+      // Lurus dinilai sekali, tepat setelah sensor melewati cabang
+      if (!probe_passed && !arm_left && !arm_right) {
+        probe_passed = true;
+        probe_straight = active_center >= 1;
+      }
+      if (!probe_passed) {
+        probe_left |= arm_left;
+        probe_right |= arm_right;
+      }
+      if (--probe_steps == 0) {
+        bool straight = probe_straight;
+        if (!probe_passed && active_sensors >= 7) {
+          // Masih hitam semua setelah maju: kotak finish
+          if (run == RUN_EKSPLORASI) {
+            explore_time = now - run_start;
+            printf("[MAZE] finish eksplorasi %.2f s, %d keputusan -> path %s (%d)\n",
+                   explore_time, raw_turns, path, path_length);
+            run = RUN_KEMBALI;
+            path_index = 0;
+            run_start = now;
+            mode = MODE_MUNDUR;
+          } else {
+            double solve_time = now - run_start;
+            printf("[MAZE] run cepat %.2f s (eksplorasi %.2f s, kembali %.2f s, hemat %.0f%%) path %s\n",
+                   solve_time, explore_time, return_time, 100.0 * (1.0 - solve_time / explore_time), path);
+            run = RUN_SELESAI;
+            mode = MODE_FINISH;
+          }
+        } else {
+          int exits = probe_left + straight + probe_right;
+          char choice = left_hand(probe_left, straight, probe_right);
+          if (exits >= 2) {
+            // Simpang sungguhan: eksplorasi mencatat, kembali / run cepat membaca path
+            if (run == RUN_EKSPLORASI) {
+              path_add(choice);
+            } else if (path_index < path_length) {
+              char planned = run == RUN_KEMBALI ? mirror_turn(path[path_length - 1 - path_index]) : path[path_index];
+              path_index++;
+              if ((planned == 'L' && probe_left) || (planned == 'S' && straight) || (planned == 'R' && probe_right)) choice = planned;
+              else printf("[MAZE] simpang #%d: %c dari path tidak ada, pakai %c\n", path_index, planned, choice);
+            }
+            printf("[MAZE] simpang %s%s%s -> %c | path %s\n",
+                   probe_left ? "L" : "", straight ? "S" : "", probe_right ? "R" : "", choice, path);
+          }
+          if (choice == 'S') {
+            mode = MODE_LURUS;
+            cross_timer = JUNCTION_HOLDOFF;
+          } else {
+            turn = choice;
+          }
+        }
+      }
+    }
+    else if (lost_steps >= DEAD_END_STEPS && recovery_lost_centered(&recovery) && mode != MODE_CARI) {
+      // Jalan buntu (atau ujung garis start saat kembali)
+      if (run == RUN_EKSPLORASI) {
+        path_add('U');
+        printf("[MAZE] jalan buntu -> U | path %s\n", path);
+      } else if (run == RUN_KEMBALI) {
+        return_time = now - run_start;
+        printf("[MAZE] kembali di start %.2f s, mulai run cepat path %s\n", return_time, path);
+        run = RUN_CEPAT;
+        path_index = 0;
+        run_start = now;
+      }
+      turn = 'U';
     }
-    else if (t_junction_right && cross_timer == 0) {
-      mode = MODE_PERTIGAAN_KANAN;
-      cross_timer = 5;
-      printf("+++++ PERTIGAAN KANAN DETECTED +++++\n");
+    else if (lost_steps > 0 && lost_steps < DEAD_END_STEPS && recovery_lost_centered(&recovery) && mode != MODE_CARI) {
+      mode = MODE_LURUS;  // garis habis di tengah: maju sedikit dulu, belum tentu buntu
     }
-    else if (crossroad && cross_timer == 0) {
-      mode = MODE_PEREMPATAN;
-      cross_timer = 10;
-      printf("+++++ PEREMPATAN DETECTED +++++\n");
+    else if ((arm_left || arm_right) && cross_timer == 0) {
+      mode = MODE_CEK_SIMPANG;
+      probe_steps = PROBE_STEPS;
+      probe_left = arm_left;
+      probe_right = arm_right;
+      probe_passed = false;
     }
     else if (cross_timer > 0) {
       cross_timer--;
@@ -128,7 +425,10 @@ int main() {
       turn_timer--; // Pertahankan mode belok selama beberapa langkah
     }
     else {
-      if (left_strength > right_strength + 50 && left_strength > center_strength + 20) {
+      if (active_sensors == 0) {
+        mode = MODE_CARI; // Garis hilang
+      }
+      else if (left_strength > right_strength + 50 && left_strength > center_strength + 20) {
         mode = MODE_KIRI;
         turn_timer = 3; // Pertahankan belok selama 3 langkah
       }
@@ -140,10 +440,16 @@ int main() {
         mode = MODE_LURUS;
       }
       else {
-        mode = MODE_CARI;
+        mode = MODE_LURUS; // Garis terlihat tapi tidak jelas arahnya
       }
     }
 
+    if (turn) {
+      mode = turn == 'L' ? MODE_PERTIGAAN_KIRI : turn == 'R' ? MODE_PERTIGAAN_KANAN : MODE_PUTAR_BALIK;
+      turn_steps = 0;
+      turn_left_line = !on_center;
+    }
+
     double left_speed = BASE_SPEED * speed_multiplier;
     double right_speed = BASE_SPEED * speed_multiplier;
 
@@ -164,22 +470,34 @@ int main() {
         printf("← BELOK KIRI (Speed: %.1f)\n", BASE_SPEED * speed_multiplier);
         break;
 
+      // Poros roda sudah di simpang: putar di tempat sampai cabang ada di tengah
       case MODE_PERTIGAAN_KIRI:
-        left_speed = BASE_SPEED * 0.1;
-        right_speed = BASE_SPEED * 1.8;
-        printf("⤷ BELOK KIRI DI PERTIGAAN (Boost Speed)\n");
+        left_speed = -BASE_SPEED * 0.6;
+        right_speed = BASE_SPEED * 0.6;
+        printf("⤷ BELOK KIRI DI PERTIGAAN\n");
         break;
 
       case MODE_PERTIGAAN_KANAN:
-        left_speed = BASE_SPEED * 1.8;
-        right_speed = BASE_SPEED * 0.1;
-        printf("⤶ BELOK KANAN DI PERTIGAAN (Boost Speed)\n");
+        left_speed = BASE_SPEED * 0.6;
+        right_speed = -BASE_SPEED * 0.6;
+        printf("⤶ BELOK KANAN DI PERTIGAAN\n");
         break;
 
-      case MODE_PEREMPATAN:
+      case MODE_CEK_SIMPANG:
+        left_speed = BASE_SPEED * 0.5;
+        right_speed = BASE_SPEED * 0.5;
+        printf("+ CEK SIMPANG\n");
+        break;
+
+      case MODE_MUNDUR:
+        left_speed = -BASE_SPEED * 0.5;
+        right_speed = -BASE_SPEED * 0.5;
+        printf("↓ MUNDUR DARI FINISH\n");
+        break;
+
+      case MODE_FINISH:
         left_speed = 0.0;
         right_speed = 0.0;
-        printf("■ BERHENTI DI PEREMPATAN\n");
         break;
 
       case MODE_PUTAR_BALIK:
@@ -188,11 +506,21 @@ int main() {
         printf("↻ PUTAR BALIK\n");
         break;
 
-      case MODE_CARI:
-        left_speed = BASE_SPEED * 0.7;
-        right_speed = -BASE_SPEED * 0.7;
-        printf("⟳ MENCARI GARIS\n");
+      case MODE_CARI: {
+        if (!recovery_active(&recovery)) recovery_begin(&recovery, (float)now);
+        float l, r;
+        RecoveryPhase phase = recovery_step(&recovery, (float)now, &l, &r);
+        if (phase == RECOVERY_GAVE_UP) {
+          printf("[PEMULIHAN] #%u garis tidak ditemukan setelah %.2f s, ulangi pencarian\n",
+                 recovery.losses, recovery.last_time);
+          recovery_begin(&recovery, (float)now);
+          phase = recovery_step(&recovery, (float)now, &l, &r);
+        }
+        left_speed = BASE_SPEED * l;
+        right_speed = BASE_SPEED * r;
+        printf("⟳ MENCARI GARIS (%s)\n", recovery_phase_names[phase]);
         break;
+      }
     }
 
     if (left_speed > MAX_SPEED) left_speed = MAX_SPEED;
@@ -202,6 +530,8 @@ int main() {
 
     wb_motor_set_velocity(motor_kiri, left_speed);
     wb_motor_set_velocity(motor_kanan, right_speed);
+    last_left = left_speed;
+    last_right = right_speed;
 
     printf("Motor - Kiri: %.1f, Kanan: %.1f\n", left_speed, right_speed);
   }
@@ -0,0 +1,248 @@
+// ===============================================================
+// line_camera.h
+// Deteksi garis look-ahead dari kamera Webots, mode opsional untuk
+// line_follower.c dan kode webot line maze.c (argumen --kamera).
+// Hanya C biasa (+ SSE2 jika ada), tanpa API Webots: controller memberi
+// gambar BGRA dari wb_camera_get_image() dan geometri kamera.
+//
+// Per langkah hanya LOOKAHEAD_ROWS baris gambar yang dipindai, satu
+// baris per jarak look-ahead di lantai. Kernel baris: kanal hijau 16
+// piksel BGRA dikemas jadi 16 byte, dibandingkan dengan ambang (garis =
+// gelap), lalu movemask -> jumlah piksel gelap, psadbw -> jumlah indeks
+// (untuk titik tengah), tepi kiri/kanan dari bit pertama/terakhir.
+//
+// Hasil (meter, + = kanan dari sumbu robot):
+//   offset[r]   posisi garis pada jarak forward[r]
+//   heading     arah garis relatif robot (rad, + = ke kanan)
+//   curvature   kelengkungan lingkaran yang menyinggung arah robot dan
+//               melewati titik garis terjauh (1/m, + = belok kanan)
+//   junction    'L'/'R'/'T' jika ada area gelap jauh lebih lebar dari
+//               garis di sisi itu, 'E' jika garis berakhir; '\0' = tidak ada
+//
+// Geometri: kamera setinggi cam_height di atas lantai, menunduk pitch rad,
+// fov horizontal dari wb_camera_get_fov(), piksel persegi. Harus cocok
+// dengan pose Camera di world.
+// ===============================================================
+#ifndef LINE_CAMERA_H
+#define LINE_CAMERA_H
+
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define LOOKAHEAD_ROWS 4
+#define LOOKAHEAD_ARM 1.5f  // tepi gelap sejauh ini x lebar garis dari garis = cabang
+
+typedef struct {
+  int count;   // piksel gelap
+  int sum;     // jumlah indeks x piksel gelap
+  int first;   // piksel gelap paling kiri, -1 jika tidak ada
+  int last;
+} LineRowScan;
+
+typedef struct {
+  // Parameter (default dari lookahead_init, panggil lookahead_setup jika diubah)
+  float distance[LOOKAHEAD_ROWS];  // jarak look-ahead yang diminta (m), dekat ke jauh
+  uint8_t threshold;               // kanal hijau <= ini dianggap garis
+  float line_width;                // lebar garis di lantai (m)
+
+  // Geometri
+  int width, height;
+  float focal;                     // piksel
+  float cam_height, pitch;
+  int row[LOOKAHEAD_ROWS];         // baris gambar, -1 = di luar gambar
+  float forward[LOOKAHEAD_ROWS];   // jarak maju sebenarnya pada baris itu (m)
+  float meters_per_px[LOOKAHEAD_ROWS];
+
+  // Hasil langkah terakhir
+  int seen[LOOKAHEAD_ROWS];
+  float offset[LOOKAHEAD_ROWS];
+  float span[LOOKAHEAD_ROWS];      // lebar area gelap (m)
+  float heading;
+  float curvature;
+  char junction;
+  float junction_distance;
+
+  // Biaya kernel per langkah (us)
+  float kernel_us, kernel_us_max, kernel_us_sum;
+  unsigned long steps;
+} LineLookahead;
+
+static inline double lookahead_clock_us(void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#else
+  return clock() * (1e6 / CLOCKS_PER_SEC);
+#endif
+}
+
+// Hitung baris gambar untuk tiap jarak look-ahead
+static inline void lookahead_setup(LineLookahead *la) {
+  float s = sinf(la->pitch), c = cosf(la->pitch);
+  int r;
+  for (r = 0; r < LOOKAHEAD_ROWS; r++) {
+    float k = la->cam_height / la->distance[r];
+    float yc = (k * c - s) / (c + k * s);  // sinar kamera (arah bawah) yang mengenai lantai di jarak itu
+    int v = (int)floorf(la->height / 2.0f + la->focal * yc);
+    float down;
+    la->row[r] = -1;
+    if (v < 0 || v >= la->height) continue;
+    yc = (v + 0.5f - la->height / 2.0f) / la->focal;
+    down = s + yc * c;
+    if (down <= 0) continue;
+    la->row[r] = v;
+    la->forward[r] = la->cam_height * (c - yc * s) / down;
+    la->meters_per_px[r] = la->cam_height / down / la->focal;
+  }
+}
+
+static inline void lookahead_init(LineLookahead *la, int width, int height, float fov, float cam_height, float pitch) {
+  static const float defaults[LOOKAHEAD_ROWS] = {0.08f, 0.14f, 0.22f, 0.30f};
+  int r;
+  for (r = 0; r < LOOKAHEAD_ROWS; r++) {
+    la->distance[r] = defaults[r];
+    la->seen[r] = 0;
+  }
+  la->threshold = 80;
+  la->line_width = 0.025f;
+  la->width = width;
+  la->height = height;
+  la->focal = width / 2.0f / tanf(fov / 2);
+  la->cam_height = cam_height;
+  la->pitch = pitch;
+  la->heading = la->curvature = 0;
+  la->junction = '\0';
+  la->junction_distance = 0;
+  la->kernel_us = la->kernel_us_max = la->kernel_us_sum = 0;
+  la->steps = 0;
+  lookahead_setup(la);
+}
+
+// Versi skalar kernel baris, juga acuan untuk camera_bench
+static inline void lookahead_scan_row_scalar(const uint8_t *bgra, int x, int width, uint8_t threshold, LineRowScan *out) {
+  for (; x < width; x++) {
+    if (bgra[4 * x + 1] > threshold) continue;
+    out->count++;
+    out->sum += x;
+    if (out->first < 0) out->first = x;
+    out->last = x;
+  }
+}
+
+static inline void lookahead_scan_row(const uint8_t *bgra, int width, uint8_t threshold, LineRowScan *out) {
+  int x = 0;
+  out->count = out->sum = 0;
+  out->first = out->last = -1;
+#ifdef __SSE2__
+  {
+    const __m128i green = _mm_set1_epi32(0xFF);
+    const __m128i th = _mm_set1_epi8((char)threshold);
+    const __m128i index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+      const __m128i *p = (const __m128i *)(bgra + 4 * x);
+      __m128i g0 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(p), 8), green);
+      __m128i g1 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(p + 1), 8), green);
+      __m128i g2 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(p + 2), 8), green);
+      __m128i g3 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(p + 3), 8), green);
+      __m128i g = _mm_packus_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3));
+      __m128i dark = _mm_cmpeq_epi8(_mm_max_epu8(g, th), th);  // g <= th
+      int mask = _mm_movemask_epi8(dark);
+      __m128i sad;
+      int n;
+      if (!mask) continue;
+      sad = _mm_sad_epu8(_mm_and_si128(dark, index), zero);
+      n = __builtin_popcount(mask);
+      out->sum += _mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4) + x * n;
+      out->count += n;
+      if (out->first < 0) out->first = x + __builtin_ctz(mask);
+      out->last = x + 31 - __builtin_clz(mask);
+    }
+  }
+#endif
+  lookahead_scan_row_scalar(bgra, x, width, threshold, out);
+}
+
+// Pindai baris look-ahead dari gambar BGRA (wb_camera_get_image) dan perbarui hasil
+static inline void lookahead_update(LineLookahead *la, const uint8_t *image) {
+  double t0 = lookahead_clock_us();
+  float left[LOOKAHEAD_ROWS], right[LOOKAHEAD_ROWS];
+  float sf = 0, sff = 0, sfo = 0, so = 0, ref = 0, arm = LOOKAHEAD_ARM * la->line_width;
+  int r, n = 0, near_seen = -1;
+  int used[LOOKAHEAD_ROWS] = {0};
+
+  for (r = 0; r < LOOKAHEAD_ROWS; r++) {
+    LineRowScan scan;
+    float mpp = la->meters_per_px[r], center = la->width / 2.0f;
+    la->seen[r] = 0;
+    if (la->row[r] < 0) continue;
+    lookahead_scan_row(image + 4 * la->row[r] * la->width, la->width, la->threshold, &scan);
+    if (scan.count < 2) continue;
+    la->seen[r] = 1;
+    la->offset[r] = ((float)scan.sum / scan.count + 0.5f - center) * mpp;
+    la->span[r] = (scan.last - scan.first + 1) * mpp;
+    left[r] = (scan.first + 0.5f - center) * mpp;
+    right[r] = (scan.last + 0.5f - center) * mpp;
+  }
+
+  // Simpang: area gelap melebar ke samping dari posisi garis di baris
+  // sebelumnya, dan baris berikutnya kosong (T / siku) atau masih melihat
+  // garis di tempat semula (cabang). Tikungan tajam juga melebar, tapi
+  // baris berikutnya melihat garis sudah bergeser jauh. Baris terjauh
+  // tidak bisa dipastikan, simpang di sana baru dilaporkan langkah berikutnya.
+  la->junction = '\0';
+  for (r = 0; r < LOOKAHEAD_ROWS && !la->junction; r++) {
+    if (la->row[r] < 0) continue;
+    if (!la->seen[r]) {
+      if (near_seen >= 0) {
+        la->junction = 'E';  // garis berakhir padahal baris lebih dekat masih melihatnya
+        la->junction_distance = la->forward[r];
+      }
+      continue;
+    }
+    if (near_seen >= 0) {
+      int arm_l = left[r] < ref - arm, arm_r = right[r] > ref + arm;
+      int next = r + 1;
+      while (next < LOOKAHEAD_ROWS && la->row[next] < 0) next++;
+      if ((arm_l || arm_r) &&
+          next < LOOKAHEAD_ROWS && (!la->seen[next] || fabsf(la->offset[next] - ref) < arm)) {
+        la->junction = arm_l && arm_r ? 'T' : (arm_l ? 'L' : 'R');
+        la->junction_distance = la->forward[r];
+        break;
+      }
+    }
+    near_seen = r;
+    ref = la->offset[r];
+    used[r] = 1;
+    sf += la->forward[r];
+    sff += la->forward[r] * la->forward[r];
+    sfo += la->forward[r] * la->offset[r];
+    so += la->offset[r];
+    n++;
+  }
+
+  // Heading: garis lurus terbaik lewat titik garis sebelum simpang;
+  // kelengkungan dari titik terjauh yang dipakai
+  la->heading = la->curvature = 0;
+  if (n >= 2) {
+    float mf = sf / n, var = sff / n - mf * mf;
+    if (var > 1e-6f) la->heading = atanf((sfo / n - mf * so / n) / var);
+  }
+  for (r = LOOKAHEAD_ROWS - 1; r >= 0; r--) {
+    if (!used[r]) continue;
+    la->curvature = 2 * la->offset[r] / (la->forward[r] * la->forward[r] + la->offset[r] * la->offset[r]);
+    break;
+  }
+
+  la->kernel_us = (float)(lookahead_clock_us() - t0);
+  if (la->kernel_us > la->kernel_us_max) la->kernel_us_max = la->kernel_us;
+  la->kernel_us_sum += la->kernel_us;
+  la->steps++;
+}
+
+#endif
@@ -1,7 +1,14 @@
 #include <webots/robot.h>
 #include <webots/motor.h>
 #include <webots/distance_sensor.h>
+#include <webots/camera.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "line_recovery.h"
+#include "sensor_noise.h"
+#include "line_camera.h"
+#include "adaptive_threshold.h"
 
 #define TIME_STEP 32
 #define MAX_SPEED 10.0
@@ -9,15 +16,80 @@
 #define THRESHOLD 300
 #define NOISE_THRESHOLD 200
 #define GHOST_THRESHOLD 50
+#define CAMERA_HEIGHT 0.08f  // tinggi kamera di atas lantai (m), sesuaikan dengan world
+#define CAMERA_PITCH 0.52f   // kamera menunduk (rad)
+#define CURVE_SLOWDOWN 0.1   // m: tikungan r = 0.2 m di depan -> kecepatan x 0.83
+
+// Kemudi PID (bisa diubah lewat argumen --kp= --ki= --kd=)
+#define PID_KP 8.0
+#define PID_KI 0.5
+#define PID_KD 0.3
+#define PID_MAX_OUTPUT BASE_SPEED  // koreksi maksimum (rad/s), roda dalam paling pelan berhenti
+#define PID_SLEW 60.0              // perubahan koreksi maksimum (rad/s per detik)
 
 typedef enum {
   MODE_LURUS,
   MODE_KANAN,
   MODE_KIRI,
-  MODE_CARI
+  MODE_CARI,
+  MODE_PID
 } Mode;
 
-int main() {
+// ========== Kemudi PID kontinu ==========
+typedef struct {
+  double kp, ki, kd;
+  double integral;
+  double last_error;
+  double output;   // koreksi langkah sebelumnya
+  int primed;      // last_error sudah valid
+} SteerPid;
+
+static void pid_reset(SteerPid *pid) {
+  pid->integral = 0;
+  pid->last_error = 0;
+  pid->output = 0;
+  pid->primed = 0;  // langkah pertama setelah reset tanpa suku D
+}
+
+static void pid_init(SteerPid *pid, double kp, double ki, double kd) {
+  pid->kp = kp;
+  pid->ki = ki;
+  pid->kd = kd;
+  pid_reset(pid);
+}
+
+// Koreksi kecepatan (rad/s, + = belok kanan) dengan saturasi dan batas slew
+static double pid_step(SteerPid *pid, double error, double dt) {
+  double derivative = pid->primed ? (error - pid->last_error) / dt : 0;
+  double u = pid->kp * error + pid->ki * (pid->integral + error * dt) + pid->kd * derivative;
+  double step = PID_SLEW * dt;
+  pid->last_error = error;
+  pid->primed = 1;
+
+  if (u > PID_MAX_OUTPUT) u = PID_MAX_OUTPUT;
+  else if (u < -PID_MAX_OUTPUT) u = -PID_MAX_OUTPUT;
+  else pid->integral += error * dt;  // anti-windup: integral berhenti saat jenuh
+
+  if (u > pid->output + step) u = pid->output + step;
+  else if (u < pid->output - step) u = pid->output - step;
+  pid->output = u;
+  return u;
+}
+
+// Posisi garis analog -1 kiri .. +1 kanan dari kedelapan sensor,
+// dibobot selisih nilai sensor terhadap lantai (per sensor, dari ambang adaptif)
+static double line_position(const double *values, const float *floor_level) {
+  double sum = 0, weighted = 0;
+  for (int i = 0; i < 8; i++) {
+    double w = values[i] - floor_level[i];
+    if (w <= 0) continue;
+    sum += w;
+    weighted += w * (3.5 - i) / 3.5;
+  }
+  return sum > 0 ? weighted / sum : 0;
+}
+
+int main(int argc, char **argv) {
   wb_robot_init();
 
   // Mendapatkan perangkat motor
@@ -37,34 +109,90 @@ int main() {
     wb_distance_sensor_enable(ir_sensors[i], TIME_STEP);
   }
 
-  Mode mode = MODE_LURUS;
+  // Derau sensor dari argumen benchmark (nol jika tanpa argumen)
+  SensorNoise noise;
+  noise_init(&noise, argc, argv);
+
+  // Ambang garis/lantai adaptif per sensor; --ambang-tetap = THRESHOLD/NOISE_THRESHOLD lama
+  AdaptiveThreshold adapt;
+  bool adaptive = true;
+  adapt_init(&adapt, wb_distance_sensor_get_min_value(ir_sensors[0]),
+             wb_distance_sensor_get_max_value(ir_sensors[0]), THRESHOLD, NOISE_THRESHOLD);
+
+  // Kamera look-ahead opsional (--kamera), robot harus punya Camera "camera"
+  WbDeviceTag camera = 0;
+  LineLookahead look = {0};  // tanpa kamera: seen[] tetap 0
+  SteerPid pid;
+  pid_init(&pid, PID_KP, PID_KI, PID_KD);
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--kamera") == 0) camera = wb_robot_get_device("camera");
+    else if (strncmp(argv[i], "--kp=", 5) == 0) pid.kp = atof(argv[i] + 5);
+    else if (strncmp(argv[i], "--ki=", 5) == 0) pid.ki = atof(argv[i] + 5);
+    else if (strncmp(argv[i], "--kd=", 5) == 0) pid.kd = atof(argv[i] + 5);
+    else if (strcmp(argv[i], "--ambang-tetap") == 0) adaptive = false;
+  }
+  if (camera) {
+    wb_camera_enable(camera, TIME_STEP);
+    lookahead_init(&look, wb_camera_get_width(camera), wb_camera_get_height(camera),
+                   (float)wb_camera_get_fov(camera), CAMERA_HEIGHT, CAMERA_PITCH);
+  }
+
+  Mode mode = MODE_PID;
+
+  // Pencarian garis memakai riwayat posisi garis
+  LineRecovery recovery;
+  recovery_init(&recovery);
 
   while (wb_robot_step(TIME_STEP) != -1) {
     double sensor_values[8];
     int active_left = 0, active_right = 0;
     int all_active = 0; // Untuk memeriksa apakah semua sensor aktif
+    double position = 0; // -1 kiri .. +1 kanan (IR1 paling kanan)
 
     // Membaca sensor IR
     for (int i = 0; i < 8; i++) {
-      sensor_values[i] = wb_distance_sensor_get_value(ir_sensors[i]);
-
-      // Menilai sensor yang aktif
-      if (sensor_values[i] > NOISE_THRESHOLD) {
-        if (sensor_values[i] > THRESHOLD) {
-          if (i < 3) {
-            // Sensor kanan (IR1, IR2, IR3)
-            if (sensor_values[i] > THRESHOLD) active_right++;
-          }
-          else if (i > 4) {
-            // Sensor kiri (IR6, IR7, IR8)
-            if (sensor_values[i] > THRESHOLD) active_left++;
-          }
-        }
-      }
+      sensor_values[i] = noise_apply(&noise, wb_distance_sensor_get_value(ir_sensors[i]));
+    }
+    if (adaptive) adapt_update(&adapt, sensor_values);
+    if (adaptive && adapt.steps % 100 == 0) {
+      printf("[AMBANG] update rata-rata %.2f us, maks %.1f us | IR1..8:", adapt.update_us_sum / adapt.steps,
+             adapt.update_us_max);
+      // T = nilai tetap, G = histogram gabungan, S = histogram sensor sendiri
+      for (int i = 0; i < 8; i++) printf(" %.0f%c", adapt.threshold[i], "TGS"[adapt.source[i]]);
+      printf("\n");
+    }
+
+    bool on_line[8];
+    for (int i = 0; i < 8; i++) {
+      on_line[i] = adapt_is_line(&adapt, i, sensor_values[i]);
+      if (!on_line[i]) continue;
+      if (i < 3) active_right++;      // Sensor kanan (IR1, IR2, IR3)
+      else if (i > 4) active_left++;  // Sensor kiri (IR6, IR7, IR8)
 
       // Mengecek apakah semua sensor mendeteksi garis
-      if (sensor_values[i] > THRESHOLD) {
-        all_active++;
+      all_active++;
+      position += (3.5 - i) / 3.5;
+    }
+    if (camera) {
+      const unsigned char *image = wb_camera_get_image(camera);
+      if (image) lookahead_update(&look, image);
+      if (look.steps > 0 && look.steps % 100 == 0) {
+        double avg = look.kernel_us_sum / look.steps;
+        printf("[KAMERA] kernel rata-rata %.1f us, maks %.1f us (%.3f%% dari TIME_STEP %d ms)\n",
+               avg, look.kernel_us_max, avg / (TIME_STEP * 10.0), TIME_STEP);
+      }
+    }
+
+    double now = wb_robot_get_time();
+    if (all_active > 0) {
+      position /= all_active;
+      recovery_track(&recovery, (float)position);
+      if (recovery_active(&recovery)) {
+        RecoveryPhase found = recovery.phase;
+        recovery_end(&recovery, (float)now);
+        printf("[PEMULIHAN] #%u garis ditemukan di fase %s setelah %.2f s (rata-rata %.2f s, maks %.2f s, gagal %u)\n",
+               recovery.losses, recovery_phase_names[found], recovery.last_time,
+               recovery.total_time / recovery.losses, recovery.max_time, recovery.failures);
       }
     }
 
@@ -73,56 +201,100 @@ int main() {
 
     // Logika untuk mode "Lurus"
     // IR4 atau IR5 tidak mendeteksi garis hitam, tapi sensor lainnya mendeteksi garis
-    if (sensor_values[3] < THRESHOLD && sensor_values[4] < THRESHOLD && active_left + active_right >= 4) {
+    if (!on_line[3] && !on_line[4] && active_left + active_right >= 4) {
       mode = MODE_LURUS; // Robot lurus jika banyak sensor lainnya mendeteksi garis
     }
     // Logika jika semua sensor mendeteksi garis hitam, robot tetap maju
+    // Tidak ada sensor yang melihat garis -> cari garis
+    else if (all_active == 0) {
+      mode = MODE_CARI;
+    }
     else if (all_sensors_active) {
       mode = MODE_LURUS; // Semua sensor mendeteksi garis -> tetap maju
       printf("Semua Sensor Deteksi Garis, Maju\n");
     }
-    // Tentukan mode berdasarkan sensor yang aktif
-    else if (active_left > active_right) {
-      mode = MODE_KIRI; // Belok kanan jika lebih banyak kiri
-    } else if (active_right > active_left) {
-      mode = MODE_KANAN; // Belok kiri jika lebih banyak kanan
-    } else {
-      mode = MODE_LURUS; // Lurus jika sensor kiri dan kanan seimbang
+    // Garis tinggal di sensor paling pinggir: PID sudah jenuh, belok keras supaya tidak lepas
+    else if (all_active == 1 && on_line[0]) {
+      mode = MODE_KANAN;
+    }
+    else if (all_active == 1 && on_line[7]) {
+      mode = MODE_KIRI;
+    }
+    else {
+      mode = MODE_PID;
     }
+    if (mode != MODE_PID) pid_reset(&pid);
 
     // Kecepatan motor kiri dan kanan berdasarkan mode
     double left_speed = BASE_SPEED;
     double right_speed = BASE_SPEED;
 
+    // Kamera melihat ke depan: garis lurus -> boleh sampai MAX_SPEED,
+    // tikungan di depan -> pelan sebelum masuk, bukan setelah sensor lepas
+    double camera_scale = 1.0;
+    if (camera && look.seen[0]) {
+      camera_scale = (MAX_SPEED / BASE_SPEED) / (1.0 + CURVE_SLOWDOWN * fabs(look.curvature));
+      if (camera_scale < 0.6) camera_scale = 0.6;
+    }
+    double turn_scale = camera_scale < 1.0 ? camera_scale : 1.0;  // belokan tidak dipercepat
+
     switch (mode) {
+      case MODE_PID: {
+        double error = line_position(sensor_values, adapt.floor);
+        double correction = pid_step(&pid, error, TIME_STEP / 1000.0);
+        double base = BASE_SPEED * camera_scale;
+        // Roda luar melebihi MAX_SPEED -> turunkan keduanya, selisih (belokan) tetap
+        if (base + fabs(correction) > MAX_SPEED) base = MAX_SPEED - fabs(correction);
+        left_speed = base + correction;
+        right_speed = base - correction;
+        // Roda dalam paling pelan berhenti, tidak berputar mundur
+        if (left_speed < 0) left_speed = 0;
+        if (right_speed < 0) right_speed = 0;
+        printf("PID e=%+.2f u=%+.2f\n", error, correction);
+        break;
+      }
+
       case MODE_LURUS:
         printf("Lurus\n");
-        left_speed = BASE_SPEED;
-        right_speed = BASE_SPEED;
+        left_speed = BASE_SPEED * camera_scale;
+        right_speed = BASE_SPEED * camera_scale;
         break;
 
       case MODE_KANAN:
         printf("Belok Kanan\n");
-        left_speed = MAX_SPEED; // Motor kiri lebih cepat
-        right_speed = BASE_SPEED * 0.5; // Motor kanan lebih lambat
+        left_speed = MAX_SPEED * turn_scale; // Motor kiri lebih cepat
+        right_speed = BASE_SPEED * 0.5 * turn_scale; // Motor kanan lebih lambat
         break;
 
       case MODE_KIRI:
         printf("Belok Kiri\n");
-        left_speed = BASE_SPEED * 0.5; // Motor kiri lebih lambat
-        right_speed = MAX_SPEED; // Motor kanan lebih cepat
+        left_speed = BASE_SPEED * 0.5 * turn_scale; // Motor kiri lebih lambat
+        right_speed = MAX_SPEED * turn_scale; // Motor kanan lebih cepat
         break;
 
-      case MODE_CARI:
-        printf("Mencari Garis\n");
-        left_speed = BASE_SPEED * 0.7;
-        right_speed = -BASE_SPEED * 0.7; // Bergerak untuk mencari garis
+      case MODE_CARI: {
+        // Sapu ke sisi garis terakhir, lalu sisi lain, spiral, baru putar balik
+        if (!recovery_active(&recovery)) recovery_begin(&recovery, (float)now);
+        float l, r;
+        RecoveryPhase phase = recovery_step(&recovery, (float)now, &l, &r);
+        printf("Mencari Garis (%s)\n", recovery_phase_names[phase]);
+        if (phase == RECOVERY_GAVE_UP) {
+          printf("[PEMULIHAN] #%u garis tidak ditemukan setelah %.2f s, ulangi pencarian\n",
+                 recovery.losses, recovery.last_time);
+          recovery_begin(&recovery, (float)now);
+          recovery_step(&recovery, (float)now, &l, &r);
+        }
+        left_speed = BASE_SPEED * l;
+        right_speed = BASE_SPEED * r;
         break;
+      }
     }
 
     // Atur kecepatan motor
     if (left_speed > MAX_SPEED) left_speed = MAX_SPEED;
+    if (left_speed < -MAX_SPEED) left_speed = -MAX_SPEED;
     if (right_speed > MAX_SPEED) right_speed = MAX_SPEED;
+    if (right_speed < -MAX_SPEED) right_speed = -MAX_SPEED;
 
     wb_motor_set_velocity(motor_kiri, left_speed);
     wb_motor_set_velocity(motor_kanan, right_speed);
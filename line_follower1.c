@@ -1,11 +1,18 @@
+#ifndef ARDUINO_HOST
 #include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#include <EEPROM.h>
+#endif
+#include "tune_protocol.h"
+#include "loop_timing.h"
+#include "oled_pages.h"
+#include "mpc_table.h"
+#include "battery_comp.h"
+#include "motor_driver.h"
 
 // OLED Configuration
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+SSD1306Pages display;  // tanpa framebuffer, lihat oled_pages.h
 
 // Multiplexer Pins
 const int selectPins[3] = {2, 3, 4};
@@ -16,15 +23,54 @@ int thresholds[8] = {802, 752, 700, 677, 650, 742, 707, 782};
 int sensorValues[8];
 bool sensorActive[8];
 
+// SENSOR_PULSED 1: emitter IR dipulsa per kanal (mati lalu nyala), nilai sensor
+// = terang - gelap sehingga cahaya ruangan dan kedipan lampu terhapus.
+// Tiap fase di-oversample 4x lalu didesimasi ke 11 bit; thresholdsPulsed dalam
+// satuan itu. 0 (bawaan) = cara lama, rata-rata dua analogRead.
+//
+// Hanya untuk robot yang emitternya digerakkan driver (transistor) dari pin D5.
+// Di robot dengan emitter nyala terus, terang - gelap ~0 di bawah semua
+// threshold sehingga kedelapan sensor terbaca aktif. Cara mengaktifkan:
+// pasang driver emitter di D5, set 1, lalu kalibrasi thresholdsPulsed. Nilai
+// di bawah hanya threshold lama x2 dan belum pernah diukur. Ukur nilai
+// readPulsed() tiap sensor di atas lantai dan di atas garis, ambil tengahnya;
+// bisa dicoba langsung lewat tune_cli (th0..th7) lalu COMMIT.
+#ifndef SENSOR_PULSED
+#define SENSOR_PULSED 0
+#endif
+const int emitterPin = 5;
+const int OVERSAMPLE = 4;
+const unsigned int MUX_SETTLE_US = 20;
+const unsigned int EMITTER_SETTLE_US = 30;
+int thresholdsPulsed[8] = {1604, 1504, 1400, 1354, 1300, 1484, 1414, 1564};
+int ambientLevel[8];
+
+// Statistik waktu satu scan 8 sensor, dilaporkan tiap SENSOR_REPORT_MS (0 = mati)
+const unsigned long SENSOR_REPORT_MS = 2000;
+unsigned long scanUsMin = 0xFFFFFFFF, scanUsMax = 0, scanUsSum = 0;
+unsigned int scanCount = 0;
+
 // Motor Pins
 const int motorKananMaju = 6;
 const int motorKananMundur = 9;
 const int motorKiriMaju = 11;
 const int motorKiriMundur = 10;
+// H-bridge lewat motor_driver.h: PWM 20 kHz di pin Mundur (9/10, Timer1),
+// jadi maju = pin Maju HIGH dan pin Mundur PWM terbalik (drive/brake)
+MotorBridge motorKiri, motorKanan;
+
+// Baterai lewat pembagi 20k/10k di A7 (lihat battery_comp.h). Semua duty motor
+// dikompensasi ke BAT_NOMINAL mV, jadi BASE_SPEED dan gain PID berlaku sama
+// dari baterai penuh sampai hampir habis. BAT_NOMINAL = 0 mematikannya.
+const int batteryPin = A7;
+const uint16_t BATTERY_FULL_SCALE_MV = 15000;
+const unsigned long BATTERY_SAMPLE_MS = 20;
+int batteryNominalMv = BATTERY_NOMINAL_MV;
+BatteryComp battery;
 
 // Motion Constants
-const int BASE_SPEED_kiri = 140;
-const int BASE_SPEED_kanan = 140;
+int BASE_SPEED_kiri = 140;
+int BASE_SPEED_kanan = 140;
 
 // PID Constants
 float Kp = 16;
@@ -38,6 +84,80 @@ float integral;
 // Weights for the sensor readings
 int weights[8] = {-7, -4.5, -1.5, -0.5, 0.5, 1.5, 4.5, 7};
 
+// Pilihan kontrol kemudi (bisa diganti lewat tune_cli: set steer 1)
+// STEER_MPC: MPC eksplisit dari mpc_table.h (model dari steer_id.log),
+// memperhitungkan batas koreksi +-MPC_U_MAX sebelum constrain() memotongnya.
+// Tabel dibuat untuk BASE_SPEED 140; buat ulang jika BASE_SPEED diubah.
+// STEER_IDENT: PID + dither PRBS +-IDENT_DITHER untuk merekam data identifikasi;
+// simpan log serial-nya lalu jalankan mpc_gen -l <log> untuk tabel baru.
+#define STEER_PID 0
+#define STEER_MPC 1
+#define STEER_IDENT 2
+#ifndef STEER_DEFAULT
+#define STEER_DEFAULT STEER_PID
+#endif
+int steerMode = STEER_DEFAULT;
+const float MPC_TOLERANCE = 1e-4;
+const int IDENT_DITHER = 60;
+float mpcLastY = 0;
+float mpcLastU = 0;
+uint16_t identPrbs = 0xACE1;
+
+// Live Tuning: parameter yang bisa dibaca/diubah lewat Serial (tune_cli)
+// tanpa flash ulang; COMMIT menyimpannya ke EEPROM
+#if SENSOR_PULSED
+#define SENSOR_THRESHOLDS thresholdsPulsed
+#else
+#define SENSOR_THRESHOLDS thresholds
+#endif
+const int TUNE_EEPROM_BASE = 0;
+const TuneParam tuneParams[] PROGMEM = {
+  {"Kp", TUNE_FLOAT, &Kp, 0, 100},
+  {"Ki", TUNE_FLOAT, &Ki, 0, 10},
+  {"Kd", TUNE_FLOAT, &Kd, 0, 1000},
+  {"BASE_kiri", TUNE_INT, &BASE_SPEED_kiri, 0, 255},
+  {"BASE_kanan", TUNE_INT, &BASE_SPEED_kanan, 0, 255},
+  {"steer", TUNE_INT, &steerMode, STEER_PID, STEER_IDENT},
+  {"BAT_NOMINAL", TUNE_INT, &batteryNominalMv, 0, 12600},
+  {"th0", TUNE_INT, &SENSOR_THRESHOLDS[0], 0, 2047},
+  {"th1", TUNE_INT, &SENSOR_THRESHOLDS[1], 0, 2047},
+  {"th2", TUNE_INT, &SENSOR_THRESHOLDS[2], 0, 2047},
+  {"th3", TUNE_INT, &SENSOR_THRESHOLDS[3], 0, 2047},
+  {"th4", TUNE_INT, &SENSOR_THRESHOLDS[4], 0, 2047},
+  {"th5", TUNE_INT, &SENSOR_THRESHOLDS[5], 0, 2047},
+  {"th6", TUNE_INT, &SENSOR_THRESHOLDS[6], 0, 2047},
+  {"th7", TUNE_INT, &SENSOR_THRESHOLDS[7], 0, 2047},
+};
+const uint8_t TUNE_COUNT = sizeof(tuneParams) / sizeof(tuneParams[0]);
+TuneParser tuneParser;
+
+// Loop Timing: waktu tiap tahap loop (us), dicetak dengan perintah STATS (tune_cli stats).
+// Tiap tahap dicatat tepat sekali per loop: tune = pollTuning, serial = log debug.
+enum { ST_TUNE, ST_SENSING, ST_PID, ST_MOTOR, ST_DISPLAY, ST_SERIAL, ST_LOOP, ST_COUNT };
+const char* const stageNames[ST_COUNT] = {"tune", "sensing", "pid", "motor", "display", "serial", "loop"};
+StageTiming loopTiming[ST_COUNT];
+unsigned long stageStartUs = 0;
+
+// Prototipe (Arduino IDE membuatnya otomatis; perlu untuk build host / sil_webots.cpp)
+void readSensors();
+int readPulsed(int channel);
+void reportSensorTiming(unsigned long scanUs);
+void displayReadings();
+void computeError();
+void pidControlLogic();
+void driveMotors(float correction);
+void mpcControlLogic();
+void pollBattery();
+void printBattery(Print& out);
+void setMultiplexerChannel(int channel);
+void pollTuning();
+void tuneCommit();
+void serialWriteByte(uint8_t b);
+void eepromWriteByte(int addr, uint8_t b);
+uint8_t eepromReadByte(int addr);
+void markStage(int stage);
+void dumpLoopTiming();
+
 void setup() {
   Serial.begin(9600);
   Wire.begin();
@@ -52,17 +172,43 @@ void setup() {
   display.setTextColor(SSD1306_WHITE);
 
   for (int i = 0; i < 3; i++) pinMode(selectPins[i], OUTPUT);
-  pinMode(motorKananMaju, OUTPUT);
-  pinMode(motorKananMundur, OUTPUT);
-  pinMode(motorKiriMaju, OUTPUT);
-  pinMode(motorKiriMundur, OUTPUT);
+  motor_timer_init();
+  motor_init(&motorKanan, motorKananMaju, motorKananMundur);
+  motor_init(&motorKiri, motorKiriMaju, motorKiriMundur);
+
+#if SENSOR_PULSED
+  pinMode(emitterPin, OUTPUT);
+  digitalWrite(emitterPin, LOW);
+  // Prescaler ADC 32 (500 kHz): ~26 us per analogRead, cukup cepat untuk oversampling
+  ADCSRA = (ADCSRA & ~0x07) | 0x05;
+#endif
+
+  // Live tuning: pakai parameter tersimpan jika pernah di-COMMIT
+  tune_parser_init(&tuneParser, TUNE_SYNC_HOST);
+  for (int i = 0; i < ST_COUNT; i++) timing_reset(&loopTiming[i]);
+  if (tune_load(tuneParams, TUNE_COUNT, TUNE_EEPROM_BASE, eepromReadByte)) {
+    Serial.println(F("Parameter dimuat dari EEPROM"));
+  }
+  battery_init(&battery, BATTERY_FULL_SCALE_MV, batteryNominalMv);
+  battery_sample(&battery, analogRead(batteryPin));
 }
 
 void loop() {
+  unsigned long loopStartUs = stageStartUs = micros();
+  pollTuning();   // Memproses perintah tuning dari Serial (tidak menunggu)
+  markStage(ST_TUNE);
   readSensors();  // Membaca sensor
+  pollBattery();  // Tegangan baterai untuk kompensasi PWM
+  markStage(ST_SENSING);
   displayReadings();  // Menampilkan pembacaan sensor ke OLED
+  markStage(ST_DISPLAY);
 
-  pidControlLogic(); // Menghitung kontrol PID untuk menggerakkan motor
+  if (steerMode == STEER_MPC) {
+    mpcControlLogic(); // Kontrol MPC eksplisit (tabel lookup)
+  } else {
+    pidControlLogic(); // Menghitung kontrol PID untuk menggerakkan motor
+  }
+  timing_record(&loopTiming[ST_LOOP], micros() - loopStartUs);
 
   delay(50);
 }
@@ -70,13 +216,61 @@ void loop() {
 // ========== SENSOR READING ==========
 // Fungsi untuk membaca sensor line
 void readSensors() {
+  unsigned long t0 = micros();
   for (int i = 0; i < 8; i++) {
     setMultiplexerChannel(i);
+#if SENSOR_PULSED
+    int value = readPulsed(i);
+    sensorValues[i] = value;
+    sensorActive[i] = value < thresholdsPulsed[i];
+#else
     delayMicroseconds(50);
     int value = (analogRead(analogPin) + analogRead(analogPin)) / 2;
     sensorValues[i] = value;
     sensorActive[i] = value < thresholds[i];  // Sensor aktif jika nilai sensor lebih kecil dari threshold
+#endif
   }
+#if SENSOR_PULSED
+  digitalWrite(emitterPin, LOW);
+#endif
+  reportSensorTiming(micros() - t0);
+}
+
+// Fungsi untuk membaca satu kanal dengan emitter dipulsa:
+// 4 sampel emitter mati (ambien), 4 sampel emitter nyala, hasil selisih 11 bit
+int readPulsed(int channel) {
+  unsigned int dark = 0, lit = 0;
+  digitalWrite(emitterPin, LOW);
+  delayMicroseconds(MUX_SETTLE_US);
+  for (int k = 0; k < OVERSAMPLE; k++) dark += analogRead(analogPin);
+  digitalWrite(emitterPin, HIGH);
+  delayMicroseconds(EMITTER_SETTLE_US);
+  for (int k = 0; k < OVERSAMPLE; k++) lit += analogRead(analogPin);
+  ambientLevel[channel] = dark >> 1;
+  return lit > dark ? (lit - dark) >> 1 : 0;
+}
+
+// Fungsi untuk mencatat dan melaporkan waktu scan sensor ke Serial
+void reportSensorTiming(unsigned long scanUs) {
+  static unsigned long lastReport = 0;
+  if (scanUs < scanUsMin) scanUsMin = scanUs;
+  if (scanUs > scanUsMax) scanUsMax = scanUs;
+  scanUsSum += scanUs;
+  scanCount++;
+  if (SENSOR_REPORT_MS == 0 || millis() - lastReport < SENSOR_REPORT_MS) return;
+  lastReport = millis();
+  Serial.print("SCAN us: "); Serial.print(scanUsSum / scanCount);
+  Serial.print(" | MIN: "); Serial.print(scanUsMin);
+  Serial.print(" | MAX: "); Serial.print(scanUsMax);
+#if SENSOR_PULSED
+  long ambient = 0;
+  for (int i = 0; i < 8; i++) ambient += ambientLevel[i];
+  Serial.print(" | AMBIEN: "); Serial.print(ambient / 8);
+#endif
+  Serial.println();
+  scanUsMin = 0xFFFFFFFF;
+  scanUsMax = scanUsSum = 0;
+  scanCount = 0;
 }
 
 // ========== DISPLAY ==========
@@ -91,12 +285,17 @@ void displayReadings() {
     display.print(sensorActive[i] ? "1" : "0");
   }
 
+  // Baris 2: Tegangan baterai dan skala kompensasi PWM
+  display.setCursor(0, 10);
+  display.print("Baterai: ");
+  printBattery(display);
+
   display.display();
 }
 
 // ========== PID CONTROL ==========
-// Fungsi untuk menghitung PID dan mengontrol motor
-void pidControlLogic() {
+// Fungsi untuk menghitung error posisi garis dari sensor aktif
+void computeError() {
   int weightedSum = 0;
   int activeCount = 0;
 
@@ -114,12 +313,26 @@ void pidControlLogic() {
   } else {
     error = lastError;
   }
+}
 
+// Fungsi untuk menghitung PID dan mengontrol motor
+void pidControlLogic() {
+  computeError();
   integral += error;
   float derivative = error - lastError;
   float correction = Kp * error + Ki * integral + Kd * derivative;
+  if (steerMode == STEER_IDENT) {
+    identPrbs = (identPrbs >> 1) ^ (-(identPrbs & 1u) & 0xB400u);  // LFSR 16 bit
+    correction += (identPrbs & 1) ? IDENT_DITHER : -IDENT_DITHER;
+  }
   lastError = error;
+  markStage(ST_PID);
+
+  driveMotors(correction);
+}
 
+// Fungsi untuk menggerakkan motor dari koreksi kemudi
+void driveMotors(float correction) {
   // Menghitung kecepatan motor kiri dan kanan berdasarkan koreksi PID
   int leftSpeed = BASE_SPEED_kiri - correction;
   int rightSpeed = BASE_SPEED_kanan + correction;
@@ -127,11 +340,10 @@ void pidControlLogic() {
   leftSpeed = constrain(leftSpeed, 0,  BASE_SPEED_kiri);
   rightSpeed = constrain(rightSpeed, 0,  BASE_SPEED_kanan);
 
-  // Mengatur motor berdasarkan hasil PID
-  analogWrite(motorKananMaju, rightSpeed);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMaju, leftSpeed);
-  analogWrite(motorKiriMundur, 0);
+  // Mengatur motor berdasarkan hasil PID, duty dikompensasi tegangan baterai
+  motor_drive(&motorKanan, battery_duty(&battery, rightSpeed));
+  motor_drive(&motorKiri, battery_duty(&battery, leftSpeed));
+  markStage(ST_MOTOR);
 
   // Debug serial untuk memantau nilai PID
   Serial.print("ERR: "); Serial.print(error);
@@ -139,7 +351,65 @@ void pidControlLogic() {
   Serial.print(" | R: "); Serial.print(rightSpeed);
   Serial.print(" | KP: "); Serial.print(Kp);
   Serial.print(" KI: "); Serial.print(Ki);
-  Serial.print(" KD: "); Serial.println(Kd);
+  Serial.print(" KD: "); Serial.print(Kd);
+  Serial.print(" | BAT: "); printBattery(Serial);
+  Serial.print(" | "); Serial.println(steerMode == STEER_MPC ? "MPC" : steerMode == STEER_IDENT ? "IDENT" : "PID");
+  markStage(ST_SERIAL);
+}
+
+// ========== MPC CONTROL ==========
+// Fungsi untuk kontrol MPC eksplisit: cari region tempat state berada,
+// lalu u = gain . x + offset (semua tabel di PROGMEM)
+void mpcControlLogic() {
+  computeError();
+  float x[3] = {error * MPC_Y_PER_ERROR, mpcLastY, mpcLastU};
+  const float* gain = mpcFallback;
+  float u = 0;
+
+  for (int r = 0; r < MPC_REGIONS; r++) {
+    int i = 0;
+    for (; i < MPC_ROWS; i++) {
+      float v = pgm_read_float(&mpcRows[r][i][0]) * x[0]
+              + pgm_read_float(&mpcRows[r][i][1]) * x[1]
+              + pgm_read_float(&mpcRows[r][i][2]) * x[2];
+      if (v > pgm_read_float(&mpcRowLimit[r][i]) + MPC_TOLERANCE) break;
+    }
+    if (i == MPC_ROWS) {
+      gain = mpcGain[r];
+      u = pgm_read_float(&mpcOffset[r]);
+      break;
+    }
+  }
+  for (int c = 0; c < 3; c++) u += pgm_read_float(&gain[c]) * x[c];
+  u = constrain(u, -MPC_U_MAX, MPC_U_MAX);
+
+  mpcLastY = x[0];
+  mpcLastU = u;
+  lastError = error;
+  markStage(ST_PID);
+
+  driveMotors(u * MPC_PWM_PER_U);
+}
+
+// ========== BATTERY ==========
+// Fungsi untuk membaca tegangan baterai tiap BATTERY_SAMPLE_MS (filter di battery_comp.h)
+void pollBattery() {
+  static unsigned long lastSample = 0;
+  if (millis() - lastSample < BATTERY_SAMPLE_MS) return;
+  lastSample = millis();
+  battery.nominal_mv = batteryNominalMv;  // bisa diubah lewat tune_cli
+  battery_sample(&battery, analogRead(batteryPin));
+}
+
+// Fungsi untuk mencetak tegangan (V) dan skala duty, mis. "7.21V x1.03"
+void printBattery(Print& out) {
+  if (!battery.present) {
+    out.print(F("-"));
+    return;
+  }
+  out.print(battery.mv / 1000.0, 2);
+  out.print(F("V x"));
+  out.print(battery.scale_q8 / 256.0, 2);
 }
 
 // ========== MULTIPLEXER ==========
@@ -149,3 +419,53 @@ void setMultiplexerChannel(int channel) {
     digitalWrite(selectPins[i], bitRead(channel, i));
   }
 }
+
+// ========== LIVE TUNING ==========
+// Fungsi untuk memproses byte Serial yang sudah masuk tanpa menunggu
+void pollTuning() {
+  while (Serial.available() > 0) {
+    int result = tune_feed(&tuneParser, Serial.read());
+    if (result > 0 && tuneParser.cmd == TUNE_CMD_STATS) {
+      dumpLoopTiming();
+      if (tuneParser.len > 0 && tuneParser.payload[0]) {
+        for (int i = 0; i < ST_COUNT; i++) timing_reset(&loopTiming[i]);
+      }
+      tune_send(serialWriteByte, TUNE_SYNC_ROBOT, TUNE_CMD_STATS | TUNE_REPLY, NULL, 0);
+    } else if (result > 0) {
+      tune_handle(&tuneParser, tuneParams, TUNE_COUNT, serialWriteByte, tuneCommit);
+    } else if (result < 0) {
+      tune_error(serialWriteByte, TUNE_ERR_CRC, tuneParser.cmd);
+    }
+  }
+}
+
+// Fungsi untuk menyimpan semua parameter tuning ke EEPROM
+void tuneCommit() {
+  tune_save(tuneParams, TUNE_COUNT, TUNE_EEPROM_BASE, eepromWriteByte);
+}
+
+void serialWriteByte(uint8_t b) { Serial.write(b); }
+void eepromWriteByte(int addr, uint8_t b) { EEPROM.update(addr, b); }
+uint8_t eepromReadByte(int addr) { return EEPROM.read(addr); }
+
+// ========== LOOP TIMING ==========
+// Fungsi untuk mencatat waktu sejak penanda sebelumnya ke satu tahap
+void markStage(int stage) {
+  unsigned long now = micros();
+  timing_record(&loopTiming[stage], now - stageStartUs);
+  stageStartUs = now;
+}
+
+// Fungsi untuk mencetak min/p50/p99/maks tiap tahap ke Serial
+void dumpLoopTiming() {
+  Serial.println(F("TAHAP MIN P50 P99 MAKS N (us)"));
+  for (int i = 0; i < ST_COUNT; i++) {
+    const StageTiming& t = loopTiming[i];
+    Serial.print(stageNames[i]);
+    Serial.print(' '); Serial.print((unsigned long)(t.count ? t.min : 0));
+    Serial.print(' '); Serial.print((unsigned long)timing_percentile(&t, 50));
+    Serial.print(' '); Serial.print((unsigned long)timing_percentile(&t, 99));
+    Serial.print(' '); Serial.print((unsigned long)t.max);
+    Serial.print(' '); Serial.println(t.count);
+  }
+}
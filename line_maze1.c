@@ -1,10 +1,27 @@
+#ifndef ARDUINO_HOST
 #include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#include <EEPROM.h>
+#endif
+// Ukuran buffer header untuk RAM 2 KB ATmega328P: satu tombol, lima baris teks OLED
+// (updateOLEDDisplay paling banyak 6 potong teks, ~102 karakter)
+#define FR_RECORDS 16   // ~0,25 s terakhir pada loop ~16 ms
+#define OLED_ITEMS 8
+#define OLED_TEXT 104
+#define BUTTON_MAX 1
+#define BUTTON_EDGES 8
+#define BUTTON_OUT 4
+#include "line_recovery.h"
+#include "tune_protocol.h"
+#include "loop_timing.h"
+#include "oled_pages.h"
+#include "button_events.h"
+#include "battery_comp.h"
+#include "motor_driver.h"
+#include "flight_recorder.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+SSD1306Pages display;  // tanpa framebuffer, lihat oled_pages.h
 
 const int selectPins[3] = {2, 3, 4};
 const int analogPin = A0;
@@ -12,14 +29,109 @@ const int analogPin = A0;
 int sensorStates = 0;
 int thresholds[8] = {802, 752, 580, 677, 615, 742, 707, 782};
 
+// SENSOR_PULSED 1: emitter IR dipulsa per kanal (mati lalu nyala) dan nilainya
+// terang - gelap, sehingga cahaya ruangan dan kedipan lampu ikut terhapus.
+// Tiap fase di-oversample 4x lalu didesimasi ke 11 bit (threshold di bawah
+// dalam satuan itu). 0 (bawaan) = cara lama, rata-rata dua analogRead.
+//
+// Butuh driver emitter di pin D5. Dengan emitter nyala terus (robot lama)
+// terang - gelap ~0, kedelapan sensor aktif dan pola itu dibaca sebagai
+// finish. thresholdsPulsed hanya threshold lama x2, belum diukur: setelah
+// driver terpasang dan SENSOR_PULSED 1, ukur readPulsed() tiap sensor di
+// lantai dan di garis, pakai nilai tengahnya (tune_cli th0..th7, lalu COMMIT).
+#ifndef SENSOR_PULSED
+#define SENSOR_PULSED 0
+#endif
+const int emitterPin = 5;
+const int OVERSAMPLE = 4;
+const unsigned int MUX_SETTLE_US = 20;
+const unsigned int EMITTER_SETTLE_US = 30;
+int thresholdsPulsed[8] = {1604, 1504, 1160, 1354, 1230, 1484, 1414, 1564};
+int ambientLevel[8];
+
+// Waktu satu scan 8 sensor dilaporkan ke Serial tiap SENSOR_REPORT_MS (0 = mati)
+const unsigned long SENSOR_REPORT_MS = 2000;
+unsigned long scanUsMin = 0xFFFFFFFF, scanUsMax = 0, scanUsSum = 0;
+unsigned int scanCount = 0;
+
 const int motorKananMaju = 9;
 const int motorKananMundur = 6;
 const int motorKiriMaju = 10;
 const int motorKiriMundur = 11;
 
+// H-bridge lewat motor_driver.h: PWM 20 kHz di pin Maju (9/10, Timer1).
+// Rem aktif (kedua input HIGH) sebelum tiap putaran di simpang/belokan dan
+// di finish, sampai encoder menunjukkan roda hampir diam.
+MotorBridge motorKiri, motorKanan;
+const unsigned long TURN_BRAKE_MS = 120;     // batas lama rem sebelum putar
+const unsigned long FINISH_BRAKE_MS = 300;
+const unsigned long BRAKE_SAMPLE_MS = 5;
+const long BRAKE_STILL_TICKS = 1;            // tick kedua roda per sampel = dianggap diam
+bool wheelsHeld = false;                     // rem ditahan sampai ada target baru
+
+// Baterai lewat pembagi 20k/10k di A7 (lihat battery_comp.h). Semua duty di
+// writeMotors dikompensasi ke BAT_NOMINAL mV, jadi feedforward loop roda,
+// profil belok dan gain PID tetap sama saat baterai turun. 0 = mati.
+const int batteryPin = A7;
+const uint16_t BATTERY_FULL_SCALE_MV = 15000;
+const unsigned long BATTERY_SAMPLE_MS = 20;
+int batteryNominalMv = BATTERY_NOMINAL_MV;
+BatteryComp battery;
+
+// Encoder quadrature, semua pin memakai pin-change interrupt
+const int encKiriA = 8;
+const int encKiriB = 12;
+const int encKananA = A1;
+const int encKananB = A2;
+
+const float MM_PER_TICK = 0.25;            // keliling roda / (CPR x 4)
+const float TICKS_PER_SEC_PER_PWM = 20.0;  // kecepatan roda per satu satuan PWM (feedforward)
+const unsigned long SPEED_SAMPLE_US = 10000;
+const float TRACK_WIDTH_MM = 110.0;        // jarak antar roda, untuk putar di tempat
+const float SENSOR_TO_AXLE_MM = 60.0;      // sensor di depan poros roda, sesuaikan dengan robot
+
+#define USE_WHEEL_SPEED_LOOP 1
+float Kpw = 0.8;
+float Kiw = 6.0;
+
 #define BUTTON_EXTRA 7
 
-const int BASE_SPEED = 60;
+// TRACE_RECORD 1: setiap frame sensorStates dikirim ke Serial (115200) sebagai
+// 8 byte biner {0xA4, sensorStates, dt_ms (16 bit), dTick kiri (16 bit), dTick kanan (16 bit)},
+// little endian, di sela teks log biasa. Tick encoder ikut direkam karena eksplorasi
+// memakai odometri. (Format lama 4 byte dengan sync 0xA5 masih bisa diputar ulang.)
+// Rekam dengan: stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > run.trc
+// lalu putar ulang di PC dengan trace_replay.
+#ifndef TRACE_RECORD
+#define TRACE_RECORD 0
+#endif
+#define TRACE_SYNC 0xA4
+
+// 1 = eksplorasi Trémaux (tandai cabang simpang, pilih yang paling jarang dilewati,
+//     butuh encoder); 0 = aturan tetap lama (T/3L ambil kiri, 4/3R lurus)
+#define EXPLORE_TREMAUX 1
+
+int BASE_SPEED = 60;
+
+// Profil belok trapesium (satuan setara PWM): naik dengan TURN_ACCEL sampai
+// TURN_PEAK, turun ke TURN_CREEP sebelum sudut/garis tujuan tercapai
+#define TURN_PEAK (BASE_SPEED / 1.6)
+#define TURN_CREEP (BASE_SPEED / 4.0)
+const float TURN_ACCEL = 400.0;  // per detik
+float driveBase = BASE_SPEED;    // kecepatan dasar PID, naik lagi setelah belok
+
+// Perencana kecepatan speed run. Panjang tiap segmen rute optimal diambil dari
+// peta simpang saat eksplorasi selesai; saat speed run kecepatan dasar naik dengan
+// ACCEL_MAX, dibatasi SPEED_MAX, lalu turun tepat waktu (v^2 = v_masuk^2 + 2·a·sisa)
+// supaya tiba di simpang berikutnya dengan JUNCTION_ENTRY, BRAKE_MARGIN_MM sebelum
+// posisi simpang menurut peta. Segmen yang berisi belokan tunggal dibatasi BASE_SPEED,
+// kecepatan yang sudah terbukti aman di belokan itu saat eksplorasi.
+int SPEED_MAX = 150;
+float ACCEL_MAX = 300.0;  // setara PWM per detik
+const float BRAKE_MARGIN_MM = 50;
+#define JUNCTION_ENTRY (BASE_SPEED / 2.0)
+#define FINISH_ENTRY TURN_CREEP
+unsigned long lastNavigateMs = 0;
 float Kp = 10;
 float Ki = 0.0001;
 float Kd = 10 * Kp;
@@ -29,15 +141,71 @@ float lastError = 0;
 float integral = 0;
 float derivative;
 
+// Parameter yang bisa dibaca/diubah lewat Serial saat robot berjalan (tune_cli),
+// COMMIT menyimpannya ke EEPROM mulai TUNE_EEPROM_BASE
+#if SENSOR_PULSED
+#define SENSOR_THRESHOLDS thresholdsPulsed
+#else
+#define SENSOR_THRESHOLDS thresholds
+#endif
+const int TUNE_EEPROM_BASE = 0;
+const TuneParam tuneParams[] PROGMEM = {
+  {"Kp", TUNE_FLOAT, &Kp, 0, 100},
+  {"Ki", TUNE_FLOAT, &Ki, 0, 10},
+  {"Kd", TUNE_FLOAT, &Kd, 0, 1000},
+  {"BASE_SPEED", TUNE_INT, &BASE_SPEED, 0, 255},
+  {"Kpw", TUNE_FLOAT, &Kpw, 0, 10},
+  {"Kiw", TUNE_FLOAT, &Kiw, 0, 50},
+  {"SPEED_MAX", TUNE_INT, &SPEED_MAX, 0, 255},
+  {"ACCEL_MAX", TUNE_FLOAT, &ACCEL_MAX, 10, 5000},
+  {"BAT_NOMINAL", TUNE_INT, &batteryNominalMv, 0, 12600},
+  {"th0", TUNE_INT, &SENSOR_THRESHOLDS[0], 0, 2047},
+  {"th1", TUNE_INT, &SENSOR_THRESHOLDS[1], 0, 2047},
+  {"th2", TUNE_INT, &SENSOR_THRESHOLDS[2], 0, 2047},
+  {"th3", TUNE_INT, &SENSOR_THRESHOLDS[3], 0, 2047},
+  {"th4", TUNE_INT, &SENSOR_THRESHOLDS[4], 0, 2047},
+  {"th5", TUNE_INT, &SENSOR_THRESHOLDS[5], 0, 2047},
+  {"th6", TUNE_INT, &SENSOR_THRESHOLDS[6], 0, 2047},
+  {"th7", TUNE_INT, &SENSOR_THRESHOLDS[7], 0, 2047},
+};
+const uint8_t TUNE_COUNT = sizeof(tuneParams) / sizeof(tuneParams[0]);
+TuneParser tuneParser;
+
+// Perekam kejadian: FR_RECORDS frame terakhir tiap scan sensor, disalin ke EEPROM
+// (setelah area parameter tune) saat recovery menyerah, tombol ditekan saat jalan,
+// atau finish. Baca dengan perintah DUMP (tune_cli dump [eeprom]).
+const int FR_EEPROM_BASE = 128;
+FlightRecorder recorder;
+float pidCorrection = 0;
+
+// LOOP_STATS 1: waktu tiap tahap loop (us). Klasifikasi termasuk manuver belok yang
+// blocking. Dicetak ke Serial dengan perintah STATS (tune_cli stats). Tiap tahap dicatat
+// paling banyak sekali per loop: tune = pollTuning, serial = log path di navigate(),
+// motor = target roda dari PID, roda = loop kecepatan roda di loop().
+// Bawaan 0: histogramnya makan 234 B SRAM yang tidak tersisa di ATmega328P; untuk
+// mengukur, nyalakan sementara dan kecilkan FR_RECORDS ke 4.
+#ifndef LOOP_STATS
+#define LOOP_STATS 0
+#endif
+enum { ST_TUNE, ST_SENSING, ST_KLASIFIKASI, ST_PID, ST_MOTOR, ST_DISPLAY, ST_SERIAL, ST_RODA, ST_LOOP, ST_COUNT };
+#if LOOP_STATS
+const char stageNames[ST_COUNT][12] PROGMEM = {"tune", "sensing", "klasifikasi", "pid", "motor", "display", "serial", "roda", "loop"};
+StageTiming loopTiming[ST_COUNT];
+unsigned long stageStartUs = 0;
+#endif
+
 int weights[8] = {-7, -5, -2.5, -1, 1, 2.5, 5, 7};
 
 bool isTurning = false;
-String currentDirection = "Standby";
-String currentStatus = "Jalan";
+// Teks layar dari flash (F()), diisi pertama kali di setup()
+const __FlashStringHelper* currentDirection;
+const __FlashStringHelper* currentStatus;
 
 int pathlength = 0;
 int readpath = 0;
 char path[25];
+uint8_t segmentCm[sizeof(path)];  // segmen k berakhir di simpang path[k], segmen terakhir di finish
+uint32_t segmentCorners = 0;      // bit k: segmen k berisi belokan tunggal
 
 bool readyToSavePath = false;
 char pendingPath = '\0';
@@ -45,28 +213,162 @@ bool justDidUTurn = false;
 bool justDidLeftTurn = false;
 bool justDidRightTurn = false;
 bool wasOnLine = false;
+// Hasil probeBlack(): jenis daerah hitam semua di bawah sensor
+enum BlackArea { AREA_JUNCTION, AREA_CHECKPOINT, AREA_FINISH };
+
+// Garis hilang: ujung buntu jika sebelumnya lurus di tengah, selain itu
+// sapu dulu ke sisi garis terakhir sebelum menyerah ke U-turn
+LineRecovery recovery;
+
+const int KIRI = 0;
+const int KANAN = 1;
+
+volatile long encoderTicks[2] = {0, 0};
+volatile uint8_t encoderState[2] = {0, 0};
+volatile uint8_t *encoderPort[4];
+uint8_t encoderMask[4];
+
+// Tombol EXTRA (bit 0 = ditekan), diisi ISR PCINT2
+volatile uint8_t *buttonPort;
+uint8_t buttonMask;
+ButtonQueue button;
+static inline uint8_t readButton() { return (*buttonPort & buttonMask) ? 0 : 1; }
+const int8_t encoderDir[2] = {1, -1};
+const int8_t quadTable[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
-void performIntersectionTurn(const char* intersectionType);
+struct Roda {
+  long lastTicks;
+  float speed;     // kecepatan terukur, satuan setara PWM
+  float target;    // kecepatan yang diminta, satuan setara PWM
+  float integral;
+  int duty;
+};
+Roda roda[2];
+unsigned long lastSpeedSampleUs = 0;
+unsigned long lastWheelLoopUs = 0;
+float segmentStartMm = 0;
+
+// Peta simpang untuk eksplorasi: arah absolut 0 = utara (arah start), 1 = timur, 2 = selatan, 3 = barat
+const uint8_t EXIT_L = 1;
+const uint8_t EXIT_S = 2;
+const uint8_t EXIT_R = 4;
+const int MAX_JUNCTIONS = 20;
+const float JUNCTION_MATCH_MM = 100;
+const float JUNCTION_HOLDOFF_MM = 60;
+const float FINISH_HOLDOFF_MM = 150;
+const float CP_BAR_MIN_MM = 35;     // palang checkpoint (50 mm): hitam semua lebih panjang dari garis simpang (25 mm)
+const float FINISH_PROBE_MM = 80;  // masih hitam semua sejauh ini = kotak finish
+const unsigned long CP_TAP_GAP_MS = 600;  // jeda tekan tombol: pilihan checkpoint selesai
+const int MAX_CHECKPOINTS = 8;
+const float GAP_PROBE_MM = 60;     // celah garis putus-putus lebih pendek dari ini
+const int8_t DX[4] = {0, 1, 0, -1};
+const int8_t DY[4] = {1, 0, -1, 0};
+
+struct Junction {
+  int16_t x, y;      // posisi dari odometri (mm)
+  uint8_t exits;     // bit 0-3 per arah absolut yang punya cabang, bit 4-7 cabang berisi belokan tunggal
+  uint8_t marks;     // 2 bit per arah: berapa kali cabang dilewati (0..2)
+  int8_t next[4];    // simpang di ujung cabang, -1 = belum diketahui
+  uint8_t lenCm[4];  // panjang cabang (cm)
+};
+Junction junctions[MAX_JUNCTIONS];
+int junctionCount = 0;
+int heading = 0;
+float poseX = 0, poseY = 0, poseDistMm = 0;
+int lastNode = -1;
+int lastExit = -1;
+float lastNodeMm = 0;
+bool cornerSinceNode = false;  // belokan tunggal sejak simpang terakhir
+float lastJunctionMm = -1000;
+float probedMm = 0;  // sudah maju sejauh ini sejak simpang terbaca (probeBlack)
+
+// Checkpoint: palang melintang di lintasan. Speed run dari start mencatat indeks
+// readpath dan jarak di segmennya, supaya speed run bisa dimulai dari palang ke-N.
+struct Checkpoint {
+  uint8_t readpath;
+  int16_t offsetMm;  // jarak palang dari awal segmen readpath
+};
+Checkpoint checkpoints[MAX_CHECKPOINTS];
+int checkpointCount = 0;
+int checkpointsPassed = 0;
+float checkpointMm = -1000;  // posisi palang terakhir
+int cpTaps = 0;              // tekan singkat beruntun: mulai dari checkpoint cpTaps - 1
+unsigned long lastTapMs = 0;
+bool deadEndPending = false;
+int finishNode = -1;
+bool explorationDone = false;
+bool speedRun = false;
+
+char performIntersectionTurn(const __FlashStringHelper* intersectionType, uint8_t exits, char fixedChoice);
 void moveStraight();
 void turnRight();
 void turnLeft();
 void uTurn();
-void finishLine();
-void intersection3WayRight();
-void intersection3WayLeft();
-void intersection3WayT();
-void intersection4Way();
+char finishLine();
+bool isFinishPattern(int states);
+BlackArea probeBlack(uint8_t& exits);
+void passCheckpoint();
+void selectCheckpoint();
+bool probeGap();
+char intersection3WayRight();
+char intersection3WayLeft();
+char intersection3WayT();
+char intersection4Way();
 void updateOLEDDisplay();
 void resetMemory();
-
-String simplifyPath(String path) {
-  path.replace("SUL", "R");
-  path.replace("LUL", "s");
-  return path;
-}
+void readSensors();
+void setMultiplexerChannel(int channel);
+int readPulsed(int channel);
+void reportSensorTiming(unsigned long scanUs);
+void navigate();
+void recordTraceFrame();
+void recordFlightFrame();
+void flightTrigger(uint8_t cause);
+void pollFlightRecorder();
+void dumpFlightRecorder(bool fromEeprom);
+int eepromReady();
+void setupEncoders();
+void setupButton();
+long readEncoder(int w);
+float distanceTravelled();
+void writeMotors(int leftDuty, int rightDuty);
+void pollBattery();
+void printBattery(Print& out);
+void setWheelTargets(float leftSpeed, float rightSpeed);
+void updateWheelSpeedLoop();
+void stopWheels();
+void brakeWheels(unsigned long maxMs);
+void spinByAngle(float degrees);
+void turnHeading(int quarterTurns);
+void resetExploration();
+void updatePose();
+int markOf(int n, int e);
+void addMark(int n, int e);
+char exploreJunction(uint8_t exits, char fixedChoice);
+bool reachFinish();
+void finishExploration();
+void startSpeedRun(int fromCheckpoint);
+void planSpeedRun();
+float plannedSpeed();
+uint8_t advanceToJunction(uint8_t exits, float mm);
+void takeExit(char choice);
+void spinToLine(int dir);
+bool profiledSpin(int dir, float degrees, bool stopAtLine, int oldLine, unsigned long timeoutMs);
+float lineError();
+bool recoverLine();
+void pollTuning();
+void markStage(int stage);
+void dumpLoopTiming();
+void tuneCommit();
+void serialWriteByte(uint8_t b);
+void eepromWriteByte(int addr, uint8_t b);
+uint8_t eepromReadByte(int addr);
+#ifdef TRACE_REPLAY
+int traceReplayNextFrame();
+#endif
 
 void setup() {
-  Serial.begin(9600);
+  Serial.begin(TRACE_RECORD ? 115200 : 9600);
   Wire.begin();
 
   if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
@@ -77,53 +379,340 @@ void setup() {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
+  currentDirection = F("Standby");
+  currentStatus = F("Jalan");
 
   for (int i = 0; i < 3; i++) pinMode(selectPins[i], OUTPUT);
-  pinMode(motorKananMaju, OUTPUT);
-  pinMode(motorKananMundur, OUTPUT);
-  pinMode(motorKiriMaju, OUTPUT);
-  pinMode(motorKiriMundur, OUTPUT);
+  motor_timer_init();
+  motor_init(&motorKiri, motorKiriMaju, motorKiriMundur);
+  motor_init(&motorKanan, motorKananMaju, motorKananMundur);
 
-  pinMode(BUTTON_EXTRA, INPUT_PULLUP);
+  setupButton();
+#if SENSOR_PULSED
+  pinMode(emitterPin, OUTPUT);
+  digitalWrite(emitterPin, LOW);
+  // prescaler ADC 32 (500 kHz): ~26 us per analogRead, cukup untuk oversampling
+  ADCSRA = (ADCSRA & ~0x07) | 0x05;
+#endif
 
+  setupEncoders();
+  recovery_init(&recovery);
+  recovery.center_band = 0.3;  // garis putus-putus: hilang agak ke samping pun masih dicoba lurus
+  recovery.coast_time = 0;
+  recovery.sweep_time = 0.25;
+  recovery.arc_time = 0;
+  recovery.uturn_time = 0;
+  tune_parser_init(&tuneParser, TUNE_SYNC_HOST);
+#if LOOP_STATS
+  for (int i = 0; i < ST_COUNT; i++) timing_reset(&loopTiming[i]);
+#endif
+  if (tune_load(tuneParams, TUNE_COUNT, TUNE_EEPROM_BASE, eepromReadByte)) {
+    Serial.println(F("Parameter dimuat dari EEPROM"));
+  }
+  battery_init(&battery, BATTERY_FULL_SCALE_MV, batteryNominalMv);
+  battery_sample(&battery, analogRead(batteryPin));
+  fr_init(&recorder);
   resetMemory();
 }
 
 void loop() {
-  if (digitalRead(BUTTON_EXTRA) == LOW) {
-    resetMemory();
-    delay(200);
+  ButtonEvent ev;
+  while (button_next(&button, (uint16_t)millis(), &ev)) {
+    // tombol ditekan saat robot jalan: simpan kejadian sebelum operator turun tangan
+    if (ev.type == BUTTON_PRESS && !(explorationDone && !speedRun)) flightTrigger(FR_CAUSE_BUTTON);
+    // tekan singkat saat rute siap = speed run (N+1 kali = dari checkpoint N), tahan 1 detik = reset
+    if (ev.type == BUTTON_LONG) resetMemory();
+    else if (ev.type == BUTTON_RELEASE && ev.held < button.long_ms) {
+      if (explorationDone) selectCheckpoint();
+      else resetMemory();
+    }
   }
+  if (cpTaps && millis() - lastTapMs > CP_TAP_GAP_MS) {
+    startSpeedRun(cpTaps - 1);
+    cpTaps = 0;
+  }
+#if LOOP_STATS
+  unsigned long loopStartUs = stageStartUs = micros();
+#endif
+  pollTuning();
+  markStage(ST_TUNE);
   readSensors();
-  if (!isTurning) navigate();
+  markStage(ST_SENSING);
+  if (!isTurning && !(explorationDone && !speedRun)) navigate();
+  updateWheelSpeedLoop();
+  markStage(ST_RODA);
+  pollFlightRecorder();
+#if LOOP_STATS
+  timing_record(&loopTiming[ST_LOOP], micros() - loopStartUs);
+#endif
   delay(10);
 }
 
+// Catat waktu sejak penanda sebelumnya ke tahap ini
+void markStage(int stage) {
+#if LOOP_STATS
+  unsigned long now = micros();
+  timing_record(&loopTiming[stage], now - stageStartUs);
+  stageStartUs = now;
+#else
+  (void)stage;
+#endif
+}
+
+void dumpLoopTiming() {
+#if !LOOP_STATS
+  Serial.println(F("waktu loop: build dengan LOOP_STATS 1"));
+#else
+  Serial.println(F("tahap min p50 p99 maks n (us)"));
+  for (int i = 0; i < ST_COUNT; i++) {
+    const StageTiming& t = loopTiming[i];
+    Serial.print((const __FlashStringHelper*)stageNames[i]);
+    Serial.print(' ');
+    Serial.print((unsigned long)(t.count ? t.min : 0));
+    Serial.print(' ');
+    Serial.print((unsigned long)timing_percentile(&t, 50));
+    Serial.print(' ');
+    Serial.print((unsigned long)timing_percentile(&t, 99));
+    Serial.print(' ');
+    Serial.print((unsigned long)t.max);
+    Serial.print(' ');
+    Serial.println(t.count);
+  }
+#endif
+}
+
+// Baca byte Serial yang sudah masuk tanpa menunggu, jalankan frame yang lengkap
+void pollTuning() {
+  while (Serial.available() > 0) {
+    int result = tune_feed(&tuneParser, Serial.read());
+    if (result > 0 && tuneParser.cmd == TUNE_CMD_STATS) {
+      dumpLoopTiming();
+#if LOOP_STATS
+      if (tuneParser.len > 0 && tuneParser.payload[0]) {
+        for (int i = 0; i < ST_COUNT; i++) timing_reset(&loopTiming[i]);
+      }
+#endif
+      tune_send(serialWriteByte, TUNE_SYNC_ROBOT, TUNE_CMD_STATS | TUNE_REPLY, NULL, 0);
+    } else if (result > 0 && tuneParser.cmd == TUNE_CMD_DUMP) {
+      dumpFlightRecorder(tuneParser.len > 0 && tuneParser.payload[0]);
+      tune_send(serialWriteByte, TUNE_SYNC_ROBOT, TUNE_CMD_DUMP | TUNE_REPLY, NULL, 0);
+    } else if (result > 0) {
+      tune_handle(&tuneParser, tuneParams, TUNE_COUNT, serialWriteByte, tuneCommit);
+    } else if (result < 0) {
+      tune_error(serialWriteByte, TUNE_ERR_CRC, tuneParser.cmd);
+    }
+  }
+}
+
+void tuneCommit() {
+  tune_save(tuneParams, TUNE_COUNT, TUNE_EEPROM_BASE, eepromWriteByte);
+}
+
+void serialWriteByte(uint8_t b) { Serial.write(b); }
+void eepromWriteByte(int addr, uint8_t b) { EEPROM.update(addr, b); }
+uint8_t eepromReadByte(int addr) { return EEPROM.read(addr); }
+int eepromReady() { return eeprom_is_ready(); }
+
 void resetMemory() {
   memset(path, '\0', sizeof(path));
   pathlength = 0;
   readpath = 0;
 
-  currentDirection = "Standby";
-  currentStatus = "Reset";
+  currentDirection = F("Standby");
+  currentStatus = F("Reset");
   readyToSavePath = false;
   pendingPath = '\0';
   justDidUTurn = false;
   justDidLeftTurn = false;
   justDidRightTurn = false;
+  segmentStartMm = distanceTravelled();
+  checkpointCount = 0;  // indeks readpath checkpoint hanya berlaku untuk rute yang mencatatnya
+  checkpointsPassed = 0;
+  checkpointMm = -1000;
+  cpTaps = 0;
+  resetExploration();
   updateOLEDDisplay();
-  Serial.println("Path di-reset!");
+  Serial.println(F("Path di-reset!"));
 }
 
 void readSensors() {
+#ifdef TRACE_REPLAY
+  sensorStates = traceReplayNextFrame();
+  return;
+#endif
+  unsigned long t0 = micros();
   sensorStates = 0;
   for (int i = 0; i < 8; i++) {
     setMultiplexerChannel(i);
+#if SENSOR_PULSED
+    if (readPulsed(i) < thresholdsPulsed[i]) {
+      sensorStates |= (1 << i);
+    }
+#else
     delayMicroseconds(50);
     int value = (analogRead(analogPin) + analogRead(analogPin)) / 2;
     if (value < thresholds[i]) {
       sensorStates |= (1 << i);
     }
+#endif
+  }
+#if SENSOR_PULSED
+  digitalWrite(emitterPin, LOW);
+#endif
+  reportSensorTiming(micros() - t0);
+#if TRACE_RECORD
+  recordTraceFrame();
+#endif
+  recordFlightFrame();
+}
+
+// Satu kanal mux: 4 sampel emitter mati, 4 sampel emitter nyala, hasil 11 bit
+int readPulsed(int channel) {
+  unsigned int dark = 0, lit = 0;
+  digitalWrite(emitterPin, LOW);
+  delayMicroseconds(MUX_SETTLE_US);
+  for (int k = 0; k < OVERSAMPLE; k++) dark += analogRead(analogPin);
+  digitalWrite(emitterPin, HIGH);
+  delayMicroseconds(EMITTER_SETTLE_US);
+  for (int k = 0; k < OVERSAMPLE; k++) lit += analogRead(analogPin);
+  ambientLevel[channel] = dark >> 1;
+  return lit > dark ? (lit - dark) >> 1 : 0;
+}
+
+void reportSensorTiming(unsigned long scanUs) {
+  static unsigned long lastReport = 0;
+  if (scanUs < scanUsMin) scanUsMin = scanUs;
+  if (scanUs > scanUsMax) scanUsMax = scanUs;
+  scanUsSum += scanUs;
+  scanCount++;
+  if (SENSOR_REPORT_MS == 0 || millis() - lastReport < SENSOR_REPORT_MS) return;
+  lastReport = millis();
+  Serial.print(F("Scan sensor us: "));
+  Serial.print(scanUsSum / scanCount);
+  Serial.print(F(" (min "));
+  Serial.print(scanUsMin);
+  Serial.print(F(", maks "));
+  Serial.print(scanUsMax);
+  Serial.print(')');
+#if SENSOR_PULSED
+  long ambient = 0;
+  for (int i = 0; i < 8; i++) ambient += ambientLevel[i];
+  Serial.print(F(" | ambien: "));
+  Serial.print(ambient / 8);
+#endif
+  Serial.print(F(" | baterai: "));
+  printBattery(Serial);
+  Serial.println();
+  scanUsMin = 0xFFFFFFFF;
+  scanUsMax = scanUsSum = 0;
+  scanCount = 0;
+}
+
+void recordTraceFrame() {
+  static unsigned long lastFrameMs = 0;
+  static long lastTicks[2] = {0, 0};
+  unsigned long now = millis();
+  unsigned long dt = now - lastFrameMs;
+  if (dt > 0xFFFF) dt = 0xFFFF;
+  lastFrameMs = now;
+  int16_t dTick[2];
+  for (int w = 0; w < 2; w++) {
+    noInterrupts();
+    long ticks = encoderTicks[w];
+    interrupts();
+    dTick[w] = constrain(ticks - lastTicks[w], -32768L, 32767L);
+    lastTicks[w] += dTick[w];
+  }
+  uint8_t frame[8] = {TRACE_SYNC, (uint8_t)sensorStates, (uint8_t)(dt & 0xFF), (uint8_t)(dt >> 8),
+                      (uint8_t)(dTick[KIRI] & 0xFF), (uint8_t)(dTick[KIRI] >> 8),
+                      (uint8_t)(dTick[KANAN] & 0xFF), (uint8_t)(dTick[KANAN] >> 8)};
+  Serial.write(frame, 8);
+}
+
+// Satu frame perekam per scan sensor, juga selama manuver belok yang blocking.
+// Error/koreksi dari navigate() terakhir, duty = yang benar-benar ke H-bridge.
+void recordFlightFrame() {
+  FlightRecord r;
+  r.sensors = (uint8_t)sensorStates;
+  r.mode = recovery.phase & FR_MODE_PHASE;
+  if (isTurning) r.mode |= FR_MODE_TURNING;
+  if (speedRun) r.mode |= FR_MODE_SPEED_RUN;
+  if (motorKiri.state == MOTOR_BRAKE) r.mode |= FR_MODE_BRAKE;
+  if (explorationDone) r.mode |= FR_MODE_DONE;
+  r.error_q4 = (int8_t)constrain(error * 16, -127, 127);
+  r.correction = (int16_t)constrain(pidCorrection, -32767, 32767);
+  r.pwm_left = fr_pack_duty(motorKiri.duty);
+  r.pwm_right = fr_pack_duty(motorKanan.duty);
+  fr_record(&recorder, &r, millis());
+}
+
+void flightTrigger(uint8_t cause) {
+  if (!fr_trigger(&recorder, cause, millis())) return;
+  Serial.print(F("Rekaman dibekukan: "));
+  Serial.println(fr_cause_names[cause]);
+}
+
+// Salin rekaman yang dibekukan ke EEPROM sedikit demi sedikit, tanpa menunggu EEPROM
+void pollFlightRecorder() {
+  if (recorder.persist_pos < 0) return;
+  if (fr_persist_step(&recorder, FR_EEPROM_BASE, eepromWriteByte, eepromReady)) {
+    Serial.println(F("Rekaman tersimpan di EEPROM"));
+  }
+}
+
+void printFlightRecord(const FlightRecord& r, long t) {
+  Serial.print(t);
+  Serial.print(' ');
+  for (int i = 7; i >= 0; i--) Serial.print(bitRead(r.sensors, i));
+  Serial.print(' ');
+  Serial.print(r.error_q4 / 16.0, 2);
+  Serial.print(' ');
+  Serial.print(r.correction);
+  Serial.print(' ');
+  Serial.print(r.pwm_left * 2);
+  Serial.print(' ');
+  Serial.print(r.pwm_right * 2);
+  Serial.print(' ');
+  Serial.print(recovery_phase_names[min(r.mode & FR_MODE_PHASE, RECOVERY_PHASES - 1)]);
+  if (r.mode & FR_MODE_TURNING) Serial.print(F(" belok"));
+  if (r.mode & FR_MODE_SPEED_RUN) Serial.print(F(" speedrun"));
+  if (r.mode & FR_MODE_BRAKE) Serial.print(F(" rem"));
+  if (r.mode & FR_MODE_DONE) Serial.print(F(" selesai"));
+  Serial.println();
+}
+
+// Cetak rekaman RAM (beku atau yang sedang berjalan) atau salinan EEPROM sebagai teks,
+// waktu t_ms relatif terhadap frame terakhir
+void dumpFlightRecorder(bool fromEeprom) {
+  uint8_t cause = recorder.cause, count = recorder.count;
+  uint32_t triggerMs = recorder.trigger_ms;
+  if (fromEeprom && !fr_load_header(FR_EEPROM_BASE, eepromReadByte, &cause, &count, &triggerMs)) {
+    Serial.println(F("rekaman eeprom: kosong"));
+    return;
+  }
+  if (fromEeprom) Serial.print(F("rekaman eeprom: "));
+  else Serial.print(F("rekaman ram: "));
+  Serial.print(count);
+  Serial.print(F(" frame, pemicu "));
+  Serial.print(fr_cause_names[cause]);
+  if (cause != FR_CAUSE_NONE) {
+    Serial.print(F(" @ ms "));
+    Serial.print(triggerMs);
+  }
+  Serial.println();
+  Serial.println(F("t_ms sensor error koreksi pwm_kiri pwm_kanan mode"));
+  FlightRecord r;
+  long t = 0;
+  for (int i = 1; i < count; i++) {
+    if (fromEeprom) fr_load_record(FR_EEPROM_BASE, eepromReadByte, i, &r);
+    else r = *fr_at(&recorder, i);
+    t -= r.dt_ms;
+  }
+  for (int i = 0; i < count; i++) {
+    if (fromEeprom) fr_load_record(FR_EEPROM_BASE, eepromReadByte, i, &r);
+    else r = *fr_at(&recorder, i);
+    if (i > 0) t += r.dt_ms;
+    printFlightRecord(r, t);
   }
 }
 
@@ -134,34 +723,29 @@ void setMultiplexerChannel(int channel) {
 }
 
 void navigate() {
-  int weightedSum = 0;
-  int activeCount = 0;
-  for (int i = 0; i < 8; i++) {
-    if (sensorStates & (1 << i)) {
-      weightedSum += weights[i];
-      activeCount++;
-    }
-  }
-
-  if (activeCount > 0) {
-    error = weightedSum / (float)activeCount;
+  error = lineError();
+  if (sensorStates != 0) {
     if (error * lastError < 0) integral = 0;
-  } else {
-    error = lastError;
+    recovery_track(&recovery, -error / 7.0);
   }
 
   integral += error;
   derivative = error - lastError;
   float correction = Kp * error + Ki * integral + Kd * derivative;
+  pidCorrection = correction;
+  markStage(ST_PID);
 
-  int leftSpeed = constrain(BASE_SPEED - correction, 0, 255);
-  int rightSpeed = constrain(BASE_SPEED + correction, 0, 255);
+  unsigned long now = millis();
+  float cap = speedRun ? plannedSpeed() : BASE_SPEED;
+  float accel = speedRun ? ACCEL_MAX : TURN_ACCEL;
+  driveBase = min(cap, driveBase + accel * (now - lastNavigateMs) / 1000.0f);
+  lastNavigateMs = now;
+  int leftSpeed = constrain(driveBase - correction, 0, 255);
+  int rightSpeed = constrain(driveBase + correction, 0, 255);
 
-  analogWrite(motorKananMaju, rightSpeed);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMaju, leftSpeed);
-  analogWrite(motorKiriMundur, 0);
+  setWheelTargets(leftSpeed, rightSpeed);
   lastError = error;
+  markStage(ST_MOTOR);
 
   readyToSavePath = false;
   pendingPath = '\0';
@@ -172,23 +756,20 @@ void navigate() {
   if (sensorStates == 0b00011000 || sensorStates == 0b00010000 || sensorStates == 0b00001000) {
     moveStraight();
     wasOnLine = true;
-  } else if (sensorStates == 0b11111111 || sensorStates == 0b01111110 || sensorStates == 0b01111111 || sensorStates == 0b11111110) {
-    finishLine();
+  } else if (isFinishPattern(sensorStates)) {
+    pendingPath = finishLine();
+    readyToSavePath = true;
   } else if (sensorStates == 0b10011001 || sensorStates == 0b11011011 || sensorStates == 0b10010001 || sensorStates == 0b10001001 || sensorStates == 0b01011010 || sensorStates == 0b01011011 || sensorStates == 0b11011010 || sensorStates == 0b10010010 || sensorStates == 0b01010010 || sensorStates == 0b01011001) {
-    intersection4Way();
-    pendingPath = 'S';
+    pendingPath = intersection4Way();
     readyToSavePath = true;
   } else if (sensorStates == 0b10000001 || sensorStates == 0b01000010 || sensorStates == 0b11000011 || sensorStates == 0b01000011 || sensorStates == 0b11000010) {
-    intersection3WayT();
-    pendingPath = 'L';
+    pendingPath = intersection3WayT();
     readyToSavePath = true;
   } else if (sensorStates == 0b10011000 || sensorStates == 0b10010000 || sensorStates == 0b10001000 || sensorStates == 0b10000100 || sensorStates == 0b10001100 || sensorStates == 0b10110000 || sensorStates == 0b01010000 || sensorStates == 0b01011000 || sensorStates == 0b01001000 || sensorStates == 0b01011100 || sensorStates == 0b01001100 ) {
-    intersection3WayLeft();
-    pendingPath = 'L';
+    pendingPath = intersection3WayLeft();
     readyToSavePath = true;
   } else if (sensorStates == 0b00011001 || sensorStates == 0b00010001 || sensorStates == 0b00001001 || sensorStates == 0b00100001 || sensorStates == 0b00110001 || sensorStates == 0b00001101 || sensorStates == 0b00001010 || sensorStates == 0b00011010 || sensorStates == 0b00010010 || sensorStates == 0b00111010 || sensorStates == 0b00110010 ) {
-    intersection3WayRight();
-    pendingPath = 'S';
+    pendingPath = intersection3WayRight();
     readyToSavePath = true;
   } else if (((sensorStates & 0b11000000) > 0) && (sensorStates & 0b00011000) == 0) {
     turnLeft();
@@ -197,153 +778,930 @@ void navigate() {
     turnRight();
     justDidRightTurn = true;
   } else if (sensorStates == 0b00000000 && wasOnLine && !justDidUTurn) {
-    uTurn();
-    pendingPath = 'U';
-    readyToSavePath = true;
-    justDidUTurn = true;
+    if (recovery_lost_centered(&recovery) ? !probeGap() : !recoverLine()) {
+      uTurn();
+      deadEndPending = true;
+      pendingPath = 'U';
+      readyToSavePath = true;
+      justDidUTurn = true;
+    }
   } else {
     moveStraight();
   }
+  markStage(ST_KLASIFIKASI);
 
-  if (readyToSavePath && (pathlength < (sizeof(path) - 1)) && 
+  if (readyToSavePath && !speedRun && (pathlength < (sizeof(path) - 1)) && 
       (sensorStates == 0b00011000 || sensorStates == 0b00010000 || sensorStates == 0b00001000) &&
       pendingPath != '\0') {
     path[pathlength] = pendingPath;
     pathlength++;
     path[pathlength] = '\0';
-    Serial.print("Path ditambahkan: ");
-    Serial.println(path);
+    float segmentMm = distanceTravelled() - segmentStartMm;
+    segmentStartMm = distanceTravelled();
+    Serial.print(F("Path ditambahkan: "));
+    Serial.print(path);
+    Serial.print(F(" | segmen mm: "));
+    Serial.println(segmentMm, 0);
     readyToSavePath = false;
     pendingPath = '\0';
     justDidUTurn = false;
     justDidLeftTurn = false;
     justDidRightTurn = false;
   }
+  markStage(ST_SERIAL);
 
   updateOLEDDisplay();
+  markStage(ST_DISPLAY);
+}
+
+float lineError() {
+  int weightedSum = 0;
+  int activeCount = 0;
+  for (int i = 0; i < 8; i++) {
+    if (sensorStates & (1 << i)) {
+      weightedSum += weights[i];
+      activeCount++;
+    }
+  }
+  return activeCount > 0 ? weightedSum / (float)activeCount : lastError;
 }
 
 void updateOLEDDisplay() {
   display.clearDisplay();
   display.setCursor(0, 0);
-  display.print("Sensor: ");
+  display.print(F("Sensor: "));
   for (int i = 7; i >= 0; i--) {
     display.print(bitRead(sensorStates, i));
   }
   display.setCursor(0, 10);
-  display.print("Arah: ");
+  display.print(F("Arah: "));
   display.println(currentDirection);
   display.setCursor(0, 20);
-  display.print("Status: ");
+  display.print(F("Status: "));
   display.println(currentStatus);
   display.setCursor(0, 30);
-  display.print("Path: ");
+  display.print(F("Path: "));
   display.println(path);
+  display.setCursor(0, 40);
+  display.print(F("Baterai: "));
+  printBattery(display);
+  display.setCursor(0, 50);
+  display.print(F("CP: "));
+  display.print(checkpointsPassed);
+  display.print('/');
+  display.print(checkpointCount);
+  if (cpTaps) {
+    display.print(F(" mulai "));
+    display.print(cpTaps - 1);
+  }
   display.display();
 }
 
 void moveStraight() {
-  analogWrite(motorKananMaju, BASE_SPEED);
-  analogWrite(motorKiriMaju, BASE_SPEED);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMundur, 0);
-  currentDirection = "Lurus";
-  currentStatus = "Jalan";
+  setWheelTargets(driveBase, driveBase);
+  currentDirection = F("Lurus");
+  currentStatus = F("Jalan");
 }
 
 void turnRight() {
   isTurning = true;
-  Serial.println("Belok Kanan");
-  currentDirection = "Belok Kanan";
-  currentStatus = "Belok";
-  analogWrite(motorKananMaju, 0);
-  analogWrite(motorKiriMaju, BASE_SPEED / 1.6);
-  analogWrite(motorKananMundur, BASE_SPEED / 1.6);
-  analogWrite(motorKiriMundur, 0);
-  unsigned long timeout = millis() + 1200;
-  while (!((sensorStates & 0b00010000) || (sensorStates & 0b00001000)) && millis() < timeout) {
-    readSensors();
-  }
-  analogWrite(motorKananMaju, BASE_SPEED / 2);
-  analogWrite(motorKiriMaju, BASE_SPEED / 2);
-  delay(100);
+  Serial.println(F("Belok Kanan"));
+  currentDirection = F("Belok Kanan");
+  currentStatus = F("Belok");
+  profiledSpin(1, 90, true, 0b00011000, 1200);
   isTurning = false;
-  integral = 0;
+  cornerSinceNode = true;
+  turnHeading(1);
 }
 
 void turnLeft() {
   isTurning = true;
-  Serial.println("Belok Kiri");
-  currentDirection = "Belok Kiri";
-  currentStatus = "Belok";
-  analogWrite(motorKananMaju, BASE_SPEED / 1.6);
-  analogWrite(motorKiriMaju, 0);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMundur, BASE_SPEED / 1.6);
-  unsigned long timeout = millis() + 1200;
-  while (!((sensorStates & 0b00010000) || (sensorStates & 0b00001000)) && millis() < timeout) {
-    readSensors();
-  }
-  analogWrite(motorKananMaju, BASE_SPEED / 2);
-  analogWrite(motorKiriMaju, BASE_SPEED / 2);
-  delay(100);
+  Serial.println(F("Belok Kiri"));
+  currentDirection = F("Belok Kiri");
+  currentStatus = F("Belok");
+  profiledSpin(-1, 90, true, 0b00011000, 1200);
   isTurning = false;
-  integral = 0;
+  cornerSinceNode = true;
+  turnHeading(-1);
 }
 
 void uTurn() {
   isTurning = true;
-  Serial.println("U-Turn");
-  currentDirection = "U-Turn";
-  currentStatus = "Putar Balik";
-  analogWrite(motorKananMaju, BASE_SPEED / 1.6);
-  analogWrite(motorKiriMundur, BASE_SPEED / 1.6);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMaju, 0);
-  unsigned long timeout = millis() + 2000;
-  while (!((sensorStates & 0b00010000) || (sensorStates & 0b00001000)) && millis() < timeout) {
+  Serial.println(F("U-Turn"));
+  currentDirection = F("U-Turn");
+  currentStatus = F("Putar Balik");
+  profiledSpin(-1, 180, true, 0b00011000, 2000);
+  isTurning = false;
+  turnHeading(2);
+}
+
+bool recoverLine() {
+  isTurning = true;
+  currentStatus = F("Cari Garis");
+  recovery_begin(&recovery, millis() / 1000.0);
+  RecoveryPhase phase = recovery.phase;
+  while (sensorStates == 0) {
+    float l, r;
+    phase = recovery_step(&recovery, millis() / 1000.0, &l, &r);
+    if (phase == RECOVERY_GAVE_UP) break;
+    setWheelTargets(l * BASE_SPEED, r * BASE_SPEED);
     readSensors();
+    updateWheelSpeedLoop();
   }
-  analogWrite(motorKananMaju, BASE_SPEED / 3);
-  analogWrite(motorKiriMaju, BASE_SPEED / 3);
-  delay(100);
   isTurning = false;
+  if (sensorStates == 0) {
+    Serial.print(F("Garis tidak ditemukan, ms: "));
+    Serial.println(recovery.last_time * 1000, 0);
+    flightTrigger(FR_CAUSE_LOST);
+    return false;
+  }
+  recovery_end(&recovery, millis() / 1000.0);
   integral = 0;
+  Serial.print(F("Garis ditemukan ("));
+  Serial.print(recovery_phase_names[phase]);
+  Serial.print(F(") ms: "));
+  Serial.print(recovery.last_time * 1000, 0);
+  Serial.print(F(" | rata-rata: "));
+  Serial.print(recovery.total_time * 1000 / recovery.losses, 0);
+  Serial.print(F(" | maks: "));
+  Serial.println(recovery.max_time * 1000, 0);
+  return true;
 }
 
-void finishLine() {
-  Serial.println("Finish Line");
-  analogWrite(motorKananMaju, 0);
-  analogWrite(motorKiriMaju, 0);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMundur, 0);
-  currentStatus = "FINISH";
+// Garis hilang saat lurus: celah garis putus-putus atau jalan buntu. Maju
+// GAP_PROBE_MM; garis muncul lagi = celah. Buntu: mundur ke ujung garis lalu putar balik.
+bool probeGap() {
+  float start = distanceTravelled();
+  unsigned long timeout = millis() + 800;
+  setWheelTargets(BASE_SPEED / 2, BASE_SPEED / 2);
+  while (sensorStates == 0 && distanceTravelled() - start < GAP_PROBE_MM && millis() < timeout) {
+    readSensors();
+    updateWheelSpeedLoop();
+  }
+  if (sensorStates != 0) return true;
+
+  setWheelTargets(-BASE_SPEED / 2, -BASE_SPEED / 2);
+  timeout = millis() + 800;
+  while (distanceTravelled() > start && millis() < timeout) {
+    readSensors();
+    updateWheelSpeedLoop();
+  }
+  brakeWheels(FINISH_BRAKE_MS);
+  return false;
 }
 
-void intersection3WayRight() { performIntersectionTurn("Simpang 3R"); }
-void intersection3WayLeft()  { performIntersectionTurn("Simpang 3L"); }
-void intersection3WayT()     { performIntersectionTurn("Simpang 3T"); }
-void intersection4Way()      { performIntersectionTurn("Perempatan"); }
+bool isFinishPattern(int states) {
+  return states == 0b11111111 || states == 0b01111110 || states == 0b01111111 || states == 0b11111110;
+}
 
-void performIntersectionTurn(const char* intersectionType) {
+// Pola hitam semua: garis melintang simpang T/perempatan (selebar garis), palang
+// checkpoint (minimal CP_BAR_MIN_MM) atau kotak finish (masih hitam setelah
+// FINISH_PROBE_MM). Maju pelan sampai hitamnya habis, panjangnya menentukan jenisnya.
+// Simpang: poros roda kini lebih dekat ke titik simpang, sisanya di advanceToJunction().
+BlackArea probeBlack(uint8_t& exits) {
+  float start = distanceTravelled();
+  unsigned long timeout = millis() + 1200;
+  setWheelTargets(BASE_SPEED / 2, BASE_SPEED / 2);
+  while (isFinishPattern(sensorStates) && distanceTravelled() - start < FINISH_PROBE_MM && millis() < timeout) {
+    readSensors();
+    updateWheelSpeedLoop();
+  }
+  if (isFinishPattern(sensorStates)) return AREA_FINISH;
+  if (distanceTravelled() - start >= CP_BAR_MIN_MM) return AREA_CHECKPOINT;
+
+  probedMm = distanceTravelled() - start;
+  exits = EXIT_L | EXIT_R;
+  if (sensorStates & 0b00011000) exits |= EXIT_S;
+  return AREA_JUNCTION;
+}
+
+// Speed run dari start mencatat palang baru; eksplorasi dan speed run dari checkpoint hanya menghitung
+void passCheckpoint() {
+  checkpointMm = distanceTravelled();
+  if (!speedRun) return;
+  if (checkpointsPassed == checkpointCount && checkpointCount < MAX_CHECKPOINTS) {
+    checkpoints[checkpointCount].readpath = readpath;
+    checkpoints[checkpointCount].offsetMm = distanceTravelled() - segmentStartMm;
+    checkpointCount++;
+  }
+  checkpointsPassed++;
+  currentStatus = F("Checkpoint");
+  Serial.print(F("Checkpoint "));
+  Serial.print(checkpointsPassed);
+  Serial.print(F(" | simpang ke-"));
+  Serial.println(readpath);
+}
+
+// Tekan singkat: hentikan speed run yang sedang jalan, lalu pilih checkpoint awal
+// (1 kali = start, 2 kali = checkpoint 1, ...). Mulai setelah jeda CP_TAP_GAP_MS.
+void selectCheckpoint() {
+  if (speedRun) {
+    speedRun = false;
+    stopWheels();
+  }
+  cpTaps = cpTaps % (checkpointCount + 1) + 1;
+  lastTapMs = millis();
+  currentStatus = F("Pilih CP");
+  updateOLEDDisplay();
+}
+
+// Hasil: keputusan simpang jika pola ternyata simpang, selain itu '\0'
+char finishLine() {
+  bool arriving = !wheelsHeld;  // pola finish tetap terbaca selama robot diam di sana
+#if EXPLORE_TREMAUX
+  if (arriving && !speedRun && !explorationDone && distanceTravelled() - lastJunctionMm < FINISH_HOLDOFF_MM) {
+    moveStraight();
+    return '\0';
+  }
+#endif
+  if (arriving) {
+    // speed run dari checkpoint: robot diletakkan di atas palangnya
+    if (distanceTravelled() - checkpointMm < FINISH_PROBE_MM) {
+      moveStraight();
+      return '\0';
+    }
+    uint8_t exits;
+    BlackArea area = probeBlack(exits);
+    if (area == AREA_JUNCTION) return exits & EXIT_S ? intersection4Way() : intersection3WayT();
+    if (area == AREA_CHECKPOINT) {
+      passCheckpoint();
+      return '\0';
+    }
+  }
+#if EXPLORE_TREMAUX
+  if (!speedRun && !explorationDone) {
+    if (reachFinish()) return '\0';
+  }
+#endif
+  Serial.println(F("Finish Line"));
+  stopWheels();
+  if (arriving) flightTrigger(FR_CAUSE_FINISH);
+  currentStatus = F("FINISH");
+  return '\0';
+}
+
+char intersection3WayRight() { return performIntersectionTurn(F("Simpang 3R"), EXIT_S | EXIT_R, 'S'); }
+char intersection3WayLeft()  { return performIntersectionTurn(F("Simpang 3L"), EXIT_L | EXIT_S, 'L'); }
+char intersection3WayT()     { return performIntersectionTurn(F("Simpang 3T"), EXIT_L | EXIT_R, 'L'); }
+char intersection4Way()      { return performIntersectionTurn(F("Perempatan"), EXIT_L | EXIT_S | EXIT_R, 'S'); }
+
+char performIntersectionTurn(const __FlashStringHelper* intersectionType, uint8_t exits, char fixedChoice) {
+#if EXPLORE_TREMAUX
+  // pola simpang yang sama masih terbaca sesaat setelah keluar simpang
+  if (distanceTravelled() - lastJunctionMm < JUNCTION_HOLDOFF_MM) {
+    moveStraight();
+    return '\0';
+  }
   isTurning = true;
-  Serial.print("Menuju ");
+  Serial.print(F("Menuju "));
   Serial.println(intersectionType);
   currentDirection = intersectionType;
-  currentStatus = "Belok";
-
-  analogWrite(motorKananMaju, BASE_SPEED / 1.6);
-  analogWrite(motorKiriMaju, 0);
-  analogWrite(motorKananMundur, 0);
-  analogWrite(motorKiriMundur, BASE_SPEED / 1.6);
-  
-  unsigned long timeout = millis() + 1500;
-  while (!((sensorStates & 0b00010000) || (sensorStates & 0b00001000)) && millis() < timeout) {
-    readSensors();
+  currentStatus = F("Belok");
+
+  exits = advanceToJunction(exits, SENSOR_TO_AXLE_MM - probedMm);
+  probedMm = 0;
+  char choice = speedRun ? (readpath < pathlength ? path[readpath++] : 'S') : exploreJunction(exits, fixedChoice);
+  if (choice == '\0') {
+    // eksplorasi selesai di simpang ini: rem dari finishExploration tetap ditahan
+    isTurning = false;
+    return '\0';
   }
-  analogWrite(motorKananMaju, BASE_SPEED / 2);
-  analogWrite(motorKiriMaju, BASE_SPEED / 2);
-  delay(100);
+  takeExit(choice);
+  lastJunctionMm = distanceTravelled();
+  if (speedRun) segmentStartMm = lastJunctionMm;
   isTurning = false;
-  integral = 0;
+  return choice;
+#else
+  isTurning = true;
+  Serial.print(F("Menuju "));
+  Serial.println(intersectionType);
+  currentDirection = intersectionType;
+  currentStatus = F("Belok");
+
+  profiledSpin(-1, 90, true, 0b00011000, 1500);
+  isTurning = false;
+  return fixedChoice;
+#endif
+}
+
+// ========== EKSPLORASI TREMAUX ==========
+
+void resetExploration() {
+  memset(junctions, 0, sizeof(junctions));
+  for (int n = 0; n < MAX_JUNCTIONS; n++) {
+    for (int e = 0; e < 4; e++) junctions[n].next[e] = -1;
+  }
+  // simpang 0 = titik start, satu-satunya cabang ke utara
+  junctionCount = 1;
+  junctions[0].exits = bit(0);
+  heading = 0;
+  poseX = poseY = 0;
+  poseDistMm = lastNodeMm = distanceTravelled();
+  lastNode = 0;
+  lastExit = 0;
+  cornerSinceNode = false;
+  addMark(0, 0);
+  lastJunctionMm = -1000;
+  deadEndPending = false;
+  finishNode = -1;
+  explorationDone = false;
+  speedRun = false;
+}
+
+void updatePose() {
+  float d = distanceTravelled() - poseDistMm;
+  poseX += d * DX[heading];
+  poseY += d * DY[heading];
+  poseDistMm += d;
+}
+
+void turnHeading(int quarterTurns) {
+  updatePose();
+  heading = (heading + quarterTurns + 4) % 4;
+}
+
+int markOf(int n, int e) {
+  return (junctions[n].marks >> (2 * e)) & 0x03;
+}
+
+void addMark(int n, int e) {
+  if (markOf(n, e) < 2) junctions[n].marks += (1 << (2 * e));
+}
+
+int relToAbs(char c) {
+  if (c == 'L') return (heading + 3) % 4;
+  if (c == 'R') return (heading + 1) % 4;
+  if (c == 'U') return (heading + 2) % 4;
+  return heading;
+}
+
+char absToRel(int e, int h) {
+  const char rel[4] = {'S', 'R', 'U', 'L'};
+  return rel[(e - h + 4) % 4];
+}
+
+// Cari simpang di posisi sekarang; odometri dikoreksi ke posisi simpang yang sudah dikenal
+int findOrAddJunction(bool &isNew) {
+  updatePose();
+  for (int n = 0; n < junctionCount; n++) {
+    if (fabs(poseX - junctions[n].x) + fabs(poseY - junctions[n].y) < JUNCTION_MATCH_MM) {
+      poseX = junctions[n].x;
+      poseY = junctions[n].y;
+      isNew = false;
+      return n;
+    }
+  }
+  if (junctionCount >= MAX_JUNCTIONS) return -1;
+  int n = junctionCount++;
+  junctions[n].x = poseX;
+  junctions[n].y = poseY;
+  isNew = true;
+  return n;
+}
+
+void linkArrival(int n, int arrival) {
+  if (!deadEndPending && lastNode >= 0) {
+    float len = (distanceTravelled() - lastNodeMm) / 10.0;
+    uint8_t cm = len > 255 ? 255 : (uint8_t)len;
+    junctions[lastNode].next[lastExit] = n;
+    junctions[lastNode].lenCm[lastExit] = cm;
+    junctions[n].next[arrival] = lastNode;
+    junctions[n].lenCm[arrival] = cm;
+    if (cornerSinceNode) {
+      junctions[lastNode].exits |= bit(lastExit + 4);
+      junctions[n].exits |= bit(arrival + 4);
+    }
+  }
+  deadEndPending = false;
+  junctions[n].exits |= bit(arrival);
+  addMark(n, arrival);
+}
+
+void leaveJunction(int n, int e) {
+  addMark(n, e);
+  lastNode = n;
+  lastExit = e;
+  cornerSinceNode = false;
+  lastNodeMm = distanceTravelled();
+}
+
+// Jarak terpendek (cm) dari simpang source ke semua simpang lewat cabang yang sudah dilalui
+void shortestDistances(int source, uint16_t *dist, int8_t *prev, int8_t *prevExit) {
+  bool done[MAX_JUNCTIONS];
+  for (int n = 0; n < junctionCount; n++) {
+    dist[n] = 0xFFFF;
+    prev[n] = prevExit[n] = -1;
+    done[n] = false;
+  }
+  dist[source] = 0;
+  for (int k = 0; k < junctionCount; k++) {
+    int u = -1;
+    for (int n = 0; n < junctionCount; n++) {
+      if (!done[n] && dist[n] != 0xFFFF && (u < 0 || dist[n] < dist[u])) u = n;
+    }
+    if (u < 0) break;
+    done[u] = true;
+    for (int e = 0; e < 4; e++) {
+      int v = junctions[u].next[e];
+      if (v < 0) continue;
+      uint16_t d = dist[u] + junctions[u].lenCm[e];
+      if (d < dist[v]) {
+        dist[v] = d;
+        prev[v] = u;
+        prevExit[v] = e;
+      }
+    }
+  }
+}
+
+long manhattanCm(int a, int b) {
+  return (labs(junctions[a].x - junctions[b].x) + labs(junctions[a].y - junctions[b].y)) / 10;
+}
+
+// Cabang simpang n yang belum dijelajah hanya berguna jika batas bawah rute yang
+// memakainya masih lebih pendek dari rute terbaik. Cabang itu bisa jadi jalan pintas
+// sesudah n (start->n diketahui, n->finish minimal Manhattan) atau sebelum n
+// (start->n minimal Manhattan, n->finish diketahui).
+bool exitWorthExploring(int n, const uint16_t *fromStart, const uint16_t *toFinish) {
+  if (finishNode < 0 || fromStart[finishNode] == 0xFFFF) return true;
+  long best = fromStart[finishNode];
+  long viaAfter = fromStart[n] == 0xFFFF ? best : fromStart[n] + manhattanCm(n, finishNode);
+  long viaBefore = toFinish[n] == 0xFFFF ? best : manhattanCm(0, n) + toFinish[n];
+  return min(viaAfter, viaBefore) < best;
+}
+
+void routeDistances(uint16_t *fromStart, uint16_t *toFinish) {
+  int8_t prev[MAX_JUNCTIONS], prevExit[MAX_JUNCTIONS];
+  shortestDistances(0, fromStart, prev, prevExit);
+  if (finishNode >= 0) shortestDistances(finishNode, toFinish, prev, prevExit);
+  else memset(toFinish, 0xFF, sizeof(uint16_t) * MAX_JUNCTIONS);
+}
+
+bool explorationComplete() {
+  if (finishNode < 0) return false;
+  uint16_t fromStart[MAX_JUNCTIONS], toFinish[MAX_JUNCTIONS];
+  routeDistances(fromStart, toFinish);
+  if (fromStart[finishNode] == 0xFFFF) return false;
+  for (int n = 0; n < junctionCount; n++) {
+    for (int e = 0; e < 4; e++) {
+      if ((junctions[n].exits & bit(e)) && markOf(n, e) == 0 && exitWorthExploring(n, fromStart, toFinish)) return false;
+    }
+  }
+  return true;
+}
+
+// Aturan Trémaux: simpang lama yang dimasuki lewat cabang baru -> balik;
+// selain itu ambil cabang yang paling jarang dilewati (urutan kiri, lurus, kanan).
+char chooseExit(int n, uint8_t exits, bool isNew) {
+  int arrival = (heading + 2) % 4;
+  if (!isNew && markOf(n, arrival) == 1) return 'U';
+
+  uint16_t fromStart[MAX_JUNCTIONS], toFinish[MAX_JUNCTIONS];
+  routeDistances(fromStart, toFinish);
+
+  const char order[3] = {'L', 'S', 'R'};
+  const uint8_t bits[3] = {EXIT_L, EXIT_S, EXIT_R};
+  char best = '\0';
+  int bestMark = 2;
+  for (int k = 0; k < 3; k++) {
+    if (!(exits & bits[k])) continue;
+    int e = relToAbs(order[k]);
+    int m = markOf(n, e);
+    if (m == 0 && !exitWorthExploring(n, fromStart, toFinish)) m = 2;
+    if (m < bestMark) {
+      bestMark = m;
+      best = order[k];
+    }
+  }
+  if (best == '\0' && markOf(n, arrival) < 2) best = 'U';
+  return best;
+}
+
+char exploreJunction(uint8_t exits, char fixedChoice) {
+  bool isNew;
+  int n = findOrAddJunction(isNew);
+  if (n < 0) return fixedChoice;  // tabel penuh: kembali ke aturan tetap lama
+
+  int arrival = (heading + 2) % 4;
+  for (int k = 0; k < 3; k++) {
+    if (exits & (1 << k)) junctions[n].exits |= bit(relToAbs("LSR"[k]));
+  }
+  linkArrival(n, arrival);
+
+  char choice = '\0';
+  if (!explorationComplete()) choice = chooseExit(n, exits, isNew);
+  if (choice == '\0') {
+    finishExploration();
+    return '\0';
+  }
+  leaveJunction(n, relToAbs(choice));
+  return choice;
+}
+
+// Dipanggil saat pola finish terbaca. true = eksplorasi lanjut (robot sudah berbalik).
+bool reachFinish() {
+  bool isNew;
+  int n = findOrAddJunction(isNew);
+  if (n < 0) return false;
+  linkArrival(n, (heading + 2) % 4);
+  finishNode = n;
+  if (explorationComplete()) {
+    finishExploration();
+    return false;
+  }
+  Serial.println(F("Finish, cek rute lain"));
+  leaveJunction(n, (heading + 2) % 4);
+  spinByAngle(180);
+  turnHeading(2);
+  lastJunctionMm = distanceTravelled();
+  return true;
+}
+
+// Cabang simpang v yang dipakai saat datang dari u lewat cabang e milik u;
+// jika ada dua cabang ke u, yang panjangnya sama dengan u->v
+int arrivalSlot(int v, int u, int e) {
+  int slot = -1;
+  for (int a = 0; a < 4; a++) {
+    if (junctions[v].next[a] != u) continue;
+    if (junctions[v].lenCm[a] == junctions[u].lenCm[e]) return a;
+    if (slot < 0) slot = a;
+  }
+  return slot;
+}
+
+void finishExploration() {
+  uint16_t dist[MAX_JUNCTIONS];
+  int8_t prev[MAX_JUNCTIONS], prevExit[MAX_JUNCTIONS];
+  shortestDistances(0, dist, prev, prevExit);
+  explorationDone = true;
+  stopWheels();
+  flightTrigger(FR_CAUSE_FINISH);
+  currentStatus = F("Rute siap");
+  if (finishNode < 0 || dist[finishNode] == 0xFFFF) {
+    Serial.println(F("Eksplorasi selesai tanpa finish"));
+    return;
+  }
+  if (finishNode == 0) {
+    // Finish di simpul awal: rute kosong, speed run langsung ke segmen terakhir
+    pathlength = 0;
+    segmentCorners = 0;
+    segmentCm[0] = 0;
+    path[0] = '\0';
+    readpath = 0;
+    Serial.println(F("Eksplorasi selesai, finish di titik awal"));
+    return;
+  }
+
+  // Telusuri balik dari finish, lalu ubah arah absolut jadi belokan relatif L/S/R
+  int8_t chain[MAX_JUNCTIONS];
+  int len = 0;
+  for (int v = finishNode; v > 0 && len < MAX_JUNCTIONS; v = prev[v]) chain[len++] = v;
+  // Arah datang di tiap simpang diambil dari peta (cabang yang menuju simpang sebelumnya),
+  // bukan dari arah keluar simpang sebelumnya: belokan tunggal di antaranya mengubah heading.
+  pathlength = 0;
+  segmentCorners = 0;
+  for (int i = len - 1; i > 0 && pathlength < (int)sizeof(path) - 1; i--) {
+    int v = chain[i];
+    int e = prevExit[chain[i - 1]];
+    segmentCm[pathlength] = junctions[prev[v]].lenCm[prevExit[v]];
+    if (junctions[prev[v]].exits & bit(prevExit[v] + 4)) segmentCorners |= 1UL << pathlength;
+    path[pathlength++] = absToRel(e, (arrivalSlot(v, prev[v], prevExit[v]) + 2) % 4);
+  }
+  segmentCm[pathlength] = junctions[prev[chain[0]]].lenCm[prevExit[chain[0]]];
+  if (junctions[prev[chain[0]]].exits & bit(prevExit[chain[0]] + 4)) segmentCorners |= 1UL << pathlength;
+  path[pathlength] = '\0';
+  readpath = 0;
+  Serial.print(F("Eksplorasi selesai, rute optimal: "));
+  Serial.print(path);
+  Serial.print(F(" | panjang cm: "));
+  Serial.println(dist[finishNode]);
+}
+
+// fromCheckpoint 0 = dari start; selain itu robot diletakkan di atas palang checkpoint tersebut
+void startSpeedRun(int fromCheckpoint) {
+  fromCheckpoint = min(fromCheckpoint, checkpointCount);
+  const Checkpoint* cp = fromCheckpoint ? &checkpoints[fromCheckpoint - 1] : NULL;
+  heading = 0;
+  readpath = cp ? cp->readpath : 0;
+  checkpointsPassed = fromCheckpoint;
+  speedRun = true;
+  lastJunctionMm = -1000;
+  segmentStartMm = distanceTravelled() - (cp ? cp->offsetMm : 0);
+  checkpointMm = cp ? distanceTravelled() : -1000;
+  driveBase = 0;
+  wasOnLine = false;
+  currentStatus = F("Speed run");
+  Serial.print(F("Speed run: "));
+  Serial.print(path);
+  Serial.print(F(" | checkpoint "));
+  Serial.println(fromCheckpoint);
+  planSpeedRun();
+}
+
+// Kecepatan awal segmen k: diam di start, selain itu kecepatan keluar simpang sebelumnya
+float segmentEntrySpeed(int k) {
+  if (k == 0) return 0;
+  return path[k - 1] == 'S' ? JUNCTION_ENTRY : TURN_CREEP;
+}
+
+float segmentExitSpeed(int k) {
+  return k < pathlength ? JUNCTION_ENTRY : FINISH_ENTRY;
+}
+
+// Batas atas segmen k: SPEED_MAX, atau BASE_SPEED jika segmen berisi belokan tunggal
+float segmentCap(int k) {
+  return (segmentCorners >> k) & 1 ? BASE_SPEED : SPEED_MAX;
+}
+
+// Puncak segmen: titik temu kurva percepatan dari awal dan kurva pengereman ke akhir.
+// Hanya untuk log; saat jalan puncak ini tercapai sendiri lewat rampa ACCEL_MAX di navigate().
+float segmentPeak(int k) {
+  const float mmPerSecPerPwm = TICKS_PER_SEC_PER_PWM * MM_PER_TICK;
+  float len = max(segmentCm[k] * 10.0f - BRAKE_MARGIN_MM, 0.0f) / mmPerSecPerPwm;
+  float v0 = segmentEntrySpeed(k), v1 = segmentExitSpeed(k);
+  float peak = sqrt((2 * ACCEL_MAX * len + v0 * v0 + v1 * v1) / 2);
+  return constrain(peak, v1, segmentCap(k));
+}
+
+void planSpeedRun() {
+  Serial.print(F("Rencana kecepatan (cm:puncak, *=belokan):"));
+  for (int k = 0; k <= pathlength; k++) {
+    Serial.print(' ');
+    Serial.print(segmentCm[k]);
+    if ((segmentCorners >> k) & 1) Serial.print('*');
+    Serial.print(':');
+    Serial.print(segmentPeak(k), 0);
+  }
+  Serial.println();
+}
+
+// Batas kecepatan dasar sekarang: batas segmen, dan kurva pengereman ke simpang berikutnya
+float plannedSpeed() {
+  const float mmPerSecPerPwm = TICKS_PER_SEC_PER_PWM * MM_PER_TICK;
+  int k = min(readpath, pathlength);
+  float v1 = segmentExitSpeed(k);
+  float remaining = segmentCm[k] * 10.0f - BRAKE_MARGIN_MM - (distanceTravelled() - segmentStartMm);
+  float brake = sqrt(v1 * v1 + 2 * ACCEL_MAX * max(remaining, 0.0f) / mmPerSecPerPwm);
+  return min(segmentCap(k), brake);
+}
+
+// Maju sampai poros roda di simpang (sensor SENSOR_TO_AXLE_MM di depan), sambil
+// mencatat cabang samping yang sempat terlihat: simpang yang didekati miring
+// terbaca 3L/3R padahal perempatan. Lurus ditentukan dari sensor tengah di titik akhir.
+uint8_t advanceToJunction(uint8_t exits, float mm) {
+  setWheelTargets(BASE_SPEED / 2, BASE_SPEED / 2);
+  unsigned long timeout = millis() + 800;
+  float start = distanceTravelled();
+  while (distanceTravelled() - start < mm && millis() < timeout) {
+    readSensors();
+    if (sensorStates & 0b10000000) exits |= EXIT_L;
+    if (sensorStates & 0b00000001) exits |= EXIT_R;
+    updateWheelSpeedLoop();
+  }
+  readSensors();
+  if (sensorStates & 0b00111100) exits |= EXIT_S;
+  else exits &= ~EXIT_S;
+  return exits;
+}
+
+void takeExit(char choice) {
+  if (choice == 'L') spinToLine(-1);
+  else if (choice == 'R') spinToLine(1);
+  else if (choice == 'U') {
+    spinByAngle(180);
+    turnHeading(2);
+  } else {
+    // lurus: lewati simpang sampai sensor samping bersih
+    setWheelTargets(BASE_SPEED / 2, BASE_SPEED / 2);
+    unsigned long timeout = millis() + 400;
+    float start = distanceTravelled();
+    while ((sensorStates & 0b11000011) && distanceTravelled() - start < JUNCTION_HOLDOFF_MM && millis() < timeout) {
+      readSensors();
+      updateWheelSpeedLoop();
+    }
+  }
+}
+
+// Putar di tempat (-1 kiri, 1 kanan): lepas dulu dari garis sekarang, lalu berhenti di garis berikutnya.
+// Garis lurus di poros simpang bisa sedikit di samping sensor tengah, jadi harus lepas dari pita lebar.
+void spinToLine(int dir) {
+  profiledSpin(dir, 90, true, 0b00111100, 1800);
+  turnHeading(dir);
+}
+
+// Putar di tempat sebesar sudut tertentu dari encoder (+ = kanan)
+void spinByAngle(float degrees) {
+  profiledSpin(degrees > 0 ? 1 : -1, fabs(degrees), false, 0, 2000);
+}
+
+// Putar di tempat (+1 kanan, -1 kiri) dengan profil kecepatan trapesium.
+// oldLine: sensor yang harus bersih dulu (lepas dari garis lama) sebelum garis di tengah dihitung.
+// Sudut dari encoder membatasi pengereman (v^2 = 2·a·sisa); untuk stopAtLine
+// kecepatan juga turun ke TURN_CREEP begitu sensor pendekat (IR sebelah
+// tengah di sisi putaran) melihat garis baru, lalu berhenti saat garis di tengah.
+// Serah terima ke PID tanpa jeda buta: integral dipertahankan, lastError
+// disamakan dengan posisi garis sekarang, dan driveBase naik lagi bertahap.
+bool profiledSpin(int dir, float degrees, bool stopAtLine, int oldLine, unsigned long timeoutMs) {
+  const int center = 0b00011000;
+  const int approach = dir > 0 ? 0b00000100 : 0b00100000;
+  const float mmPerSecPerPwm = TICKS_PER_SEC_PER_PWM * MM_PER_TICK;
+  brakeWheels(TURN_BRAKE_MS);  // buang momentum maju dulu, putaran mulai dari diam
+  long l0 = readEncoder(KIRI), r0 = readEncoder(KANAN);
+  float arcMm = degrees * PI / 180.0 * TRACK_WIDTH_MM / 2;
+  bool leftOldLine = !(sensorStates & oldLine);
+  bool slowing = false;
+  bool reached = false;
+  float v = 0;
+  unsigned long start = millis();
+  unsigned long last = start;
+
+  while (millis() - start < timeoutMs) {
+    readSensors();
+    if (stopAtLine) {
+      if (!(sensorStates & oldLine)) leftOldLine = true;
+      else if (leftOldLine && (sensorStates & center)) {
+        reached = true;
+        break;
+      }
+      if (leftOldLine && (sensorStates & approach)) slowing = true;
+    }
+    float turned = (labs(readEncoder(KIRI) - l0) + labs(readEncoder(KANAN) - r0)) * 0.5 * MM_PER_TICK;
+    if (!stopAtLine && turned >= arcMm) {
+      reached = true;
+      break;
+    }
+
+    unsigned long now = millis();
+    float dt = (now - last) / 1000.0;
+    last = now;
+    float remaining = max(arcMm - turned, 0.0f) / mmPerSecPerPwm;
+    float vMax = sqrt(2 * TURN_ACCEL * remaining);
+    if (stopAtLine) vMax = max(vMax, TURN_CREEP);  // garis bisa lebih jauh dari sudut nominal
+    if (slowing) vMax = min(vMax, TURN_CREEP);
+    v = min(constrain(v + TURN_ACCEL * dt, TURN_CREEP, TURN_PEAK), vMax);
+    setWheelTargets(dir * v, -dir * v);
+    updateWheelSpeedLoop();
+  }
+
+  lastError = lineError();
+  driveBase = TURN_CREEP;
+  lastNavigateMs = millis();
+  setWheelTargets(driveBase, driveBase);
+  return reached;
+}
+
+void setupEncoders() {
+  const int pins[4] = {encKiriA, encKiriB, encKananA, encKananB};
+  for (int i = 0; i < 4; i++) {
+    pinMode(pins[i], INPUT_PULLUP);
+    encoderPort[i] = portInputRegister(digitalPinToPort(pins[i]));
+    encoderMask[i] = digitalPinToBitMask(pins[i]);
+    *digitalPinToPCMSK(pins[i]) |= bit(digitalPinToPCMSKbit(pins[i]));
+    PCICR |= bit(digitalPinToPCICRbit(pins[i]));
+  }
+  for (int w = 0; w < 2; w++) {
+    encoderState[w] = ((*encoderPort[2 * w] & encoderMask[2 * w]) ? 2 : 0) |
+                      ((*encoderPort[2 * w + 1] & encoderMask[2 * w + 1]) ? 1 : 0);
+  }
+  lastWheelLoopUs = lastSpeedSampleUs = micros();
+}
+
+static inline void encoderUpdate(uint8_t w) {
+  uint8_t a = (*encoderPort[2 * w] & encoderMask[2 * w]) ? 2 : 0;
+  uint8_t b = (*encoderPort[2 * w + 1] & encoderMask[2 * w + 1]) ? 1 : 0;
+  uint8_t state = ((encoderState[w] << 2) | a | b) & 0x0F;
+  encoderTicks[w] += quadTable[state];
+  encoderState[w] = state;
+}
+
+ISR(PCINT0_vect) { encoderUpdate(KIRI); }   // D8, D12
+ISR(PCINT1_vect) { encoderUpdate(KANAN); }  // A1, A2
+ISR(PCINT2_vect) { button_isr(&button, readButton(), (uint16_t)millis()); }  // D7
+
+// Tombol EXTRA lewat pin-change interrupt, tepi diantrikan dengan waktunya
+void setupButton() {
+  pinMode(BUTTON_EXTRA, INPUT_PULLUP);
+  buttonPort = portInputRegister(digitalPinToPort(BUTTON_EXTRA));
+  buttonMask = digitalPinToBitMask(BUTTON_EXTRA);
+  button_init(&button, 1, readButton(), (uint16_t)millis());
+  button.long_ms = 1000;
+  *digitalPinToPCMSK(BUTTON_EXTRA) |= bit(digitalPinToPCMSKbit(BUTTON_EXTRA));
+  PCICR |= bit(digitalPinToPCICRbit(BUTTON_EXTRA));
+}
+
+long readEncoder(int w) {
+  noInterrupts();
+  long ticks = encoderTicks[w];
+  interrupts();
+  return ticks * encoderDir[w];
+}
+
+float distanceTravelled() {
+  return (readEncoder(KIRI) + readEncoder(KANAN)) * 0.5 * MM_PER_TICK;
+}
+
+// Semua keluaran motor lewat sini, duty dikompensasi tegangan baterai
+void writeMotors(int leftDuty, int rightDuty) {
+  motor_drive(&motorKiri, battery_duty(&battery, leftDuty));
+  motor_drive(&motorKanan, battery_duty(&battery, rightDuty));
+}
+
+// Baca tegangan baterai tiap BATTERY_SAMPLE_MS, dipanggil dari loop roda
+// supaya tetap jalan selama manuver belok yang blocking
+void pollBattery() {
+  static unsigned long lastSample = 0;
+  if (millis() - lastSample < BATTERY_SAMPLE_MS) return;
+  lastSample = millis();
+  battery.nominal_mv = batteryNominalMv;  // bisa diubah lewat tune_cli
+  battery_sample(&battery, analogRead(batteryPin));
+}
+
+// Tegangan (V) dan skala duty, mis. "7.21V x1.03"; "-" jika baterai tidak terbaca
+void printBattery(Print& out) {
+  if (!battery.present) {
+    out.print('-');
+    return;
+  }
+  out.print(battery.mv / 1000.0, 2);
+  out.print(F("V x"));
+  out.print(battery.scale_q8 / 256.0, 2);
+}
+
+void setWheelTargets(float leftSpeed, float rightSpeed) {
+  roda[KIRI].target = leftSpeed;
+  roda[KANAN].target = rightSpeed;
+  if (leftSpeed != 0 || rightSpeed != 0) wheelsHeld = false;
+  updateWheelSpeedLoop();
+}
+
+// Berhenti dengan rem aktif dan tahan rem sampai ada target baru
+void stopWheels() {
+  brakeWheels(FINISH_BRAKE_MS);
+  wheelsHeld = true;
+}
+
+// Rem aktif sampai kedua roda hampir diam menurut encoder (paling lama maxMs),
+// lalu loop roda mulai lagi dari nol. Motor tetap direm sampai target berikutnya.
+void brakeWheels(unsigned long maxMs) {
+  motor_brake(&motorKiri);
+  motor_brake(&motorKanan);
+  long l = readEncoder(KIRI), r = readEncoder(KANAN);
+  unsigned long start = millis();
+  while (millis() - start < maxMs) {
+    delay(BRAKE_SAMPLE_MS);
+    long l2 = readEncoder(KIRI), r2 = readEncoder(KANAN);
+    bool still = labs(l2 - l) + labs(r2 - r) <= BRAKE_STILL_TICKS;
+    l = l2;
+    r = r2;
+    if (still) break;
+  }
+  for (int w = 0; w < 2; w++) {
+    roda[w].target = 0;
+    roda[w].integral = 0;
+    roda[w].duty = 0;
+    roda[w].speed = 0;
+    roda[w].lastTicks = readEncoder(w);
+  }
+  lastWheelLoopUs = lastSpeedSampleUs = micros();
+}
+
+// Loop PI kecepatan roda di bawah PID garis: target dari PID, umpan balik dari encoder
+void updateWheelSpeedLoop() {
+  pollBattery();
+  unsigned long now = micros();
+  float dt = (now - lastWheelLoopUs) * 1e-6;
+  lastWheelLoopUs = now;
+  if (dt > 0.05) dt = 0.05;
+
+  if (now - lastSpeedSampleUs >= SPEED_SAMPLE_US) {
+    float sampleSec = (now - lastSpeedSampleUs) * 1e-6;
+    lastSpeedSampleUs = now;
+    for (int w = 0; w < 2; w++) {
+      long ticks = readEncoder(w);
+      float measured = (ticks - roda[w].lastTicks) / sampleSec / TICKS_PER_SEC_PER_PWM;
+      roda[w].lastTicks = ticks;
+      roda[w].speed += 0.5 * (measured - roda[w].speed);
+    }
+  }
+
+  for (int w = 0; w < 2; w++) {
+    Roda &r = roda[w];
+    if (r.target == 0) {
+      r.integral = 0;
+      r.duty = 0;
+      continue;
+    }
+#if USE_WHEEL_SPEED_LOOP
+    float e = r.target - r.speed;
+    float out = r.target + Kpw * e + r.integral;
+    // anti-windup: integral hanya jalan selama output belum jenuh ke arah yang sama
+    if (!((out >= 255 && e > 0) || (out <= -255 && e < 0))) {
+      r.integral += Kiw * e * dt;
+    }
+    r.duty = constrain((int)out, -255, 255);
+#else
+    r.duty = constrain((int)r.target, -255, 255);
+#endif
+  }
+  if (!wheelsHeld) writeMotors(roda[KIRI].duty, roda[KANAN].duty);
 }
@@ -0,0 +1,217 @@
+// ===============================================================
+// line_recovery.h
+// Mesin pencarian garis saat garis hilang, dipakai bersama oleh
+// controller Webots (line_follower.c, kode webot line maze.c) dan
+// firmware (line_maze1.c). Hanya C biasa, tanpa I/O.
+//
+// Posisi garis: -1 = paling kiri, 0 = tengah, +1 = paling kanan.
+// Keluaran: perintah roda kiri/kanan ternormalisasi (-1..1), dikali
+// BASE_SPEED oleh pemanggil. Waktu dalam detik.
+//
+// Urutan pencarian:
+//   1. LURUS   : garis hilang saat masih di tengah -> maju sebentar
+//                (celah garis putus-putus)
+//   2. SAPU_1  : putar ke sisi tempat garis terakhir terlihat
+//   3. SAPU_2  : putar balik ke sisi lain (2x lebih lama)
+//   4. SPIRAL  : busur maju yang makin lebar
+//   5. PUTAR   : menyerah, putar balik 180 derajat
+// ===============================================================
+#ifndef LINE_RECOVERY_H
+#define LINE_RECOVERY_H
+
+#include <math.h>
+
+#define RECOVERY_HISTORY 16
+
+typedef enum {
+  RECOVERY_IDLE,
+  RECOVERY_COAST,
+  RECOVERY_SWEEP_FIRST,
+  RECOVERY_SWEEP_BACK,
+  RECOVERY_ARC,
+  RECOVERY_UTURN,
+  RECOVERY_GAVE_UP,
+  RECOVERY_PHASES
+} RecoveryPhase;
+
+typedef struct {
+  // Parameter (diisi default oleh recovery_init, boleh diubah pemanggil)
+  float center_band;   // |posisi rata-rata| di bawah ini dianggap garis hilang di tengah
+  float coast_time;    // detik maju lurus dulu jika hilang di tengah (0 = lewati)
+  float sweep_time;    // detik sapuan pertama; sapuan balik 2x ini
+  float sweep_speed;   // kecepatan roda saat putar di tempat
+  float arc_time;      // detik maksimum spiral (0 = lewati)
+  float arc_speed;     // kecepatan maju saat spiral
+  float arc_turn;      // beda kecepatan roda awal spiral
+  float arc_growth;    // laju pelebaran spiral (1/detik)
+  float uturn_time;    // detik putar balik 180 derajat (0 = lewati)
+
+  // Riwayat posisi garis
+  float history[RECOVERY_HISTORY];
+  unsigned char head;
+  unsigned char count;
+
+  // Keadaan pencarian
+  RecoveryPhase phase;
+  float start;
+  float phase_start;
+  signed char side;    // +1 kanan, -1 kiri
+
+  // Instrumentasi
+  unsigned int losses;
+  unsigned int failures;
+  unsigned int found_in[RECOVERY_PHASES];
+  float last_time;
+  float max_time;
+  float total_time;
+} LineRecovery;
+
+static const char *const recovery_phase_names[RECOVERY_PHASES] = {
+  "-", "LURUS", "SAPU_1", "SAPU_2", "SPIRAL", "PUTAR", "MENYERAH"
+};
+
+static inline void recovery_init(LineRecovery *r) {
+  unsigned char i;
+  r->center_band = 0.15f;
+  r->coast_time = 0.15f;
+  r->sweep_time = 0.35f;
+  r->sweep_speed = 0.6f;
+  r->arc_time = 2.0f;
+  r->arc_speed = 0.5f;
+  r->arc_turn = 0.6f;
+  r->arc_growth = 1.5f;
+  r->uturn_time = 0.9f;
+  r->head = r->count = 0;
+  r->phase = RECOVERY_IDLE;
+  r->start = r->phase_start = 0;
+  r->side = 1;
+  r->losses = r->failures = 0;
+  for (i = 0; i < RECOVERY_PHASES; i++) r->found_in[i] = 0;
+  r->last_time = r->max_time = r->total_time = 0;
+}
+
+// Dipanggil setiap langkah selama garis masih terlihat
+static inline void recovery_track(LineRecovery *r, float position) {
+  r->history[r->head] = position;
+  r->head = (r->head + 1) % RECOVERY_HISTORY;
+  if (r->count < RECOVERY_HISTORY) r->count++;
+}
+
+// Posisi rata-rata terbobot, sampel terbaru paling berat
+static inline float recovery_trend(const LineRecovery *r) {
+  float sum = 0, wsum = 0;
+  unsigned char k;
+  for (k = 0; k < r->count; k++) {
+    unsigned char idx = (r->head + RECOVERY_HISTORY - 1 - k) % RECOVERY_HISTORY;
+    float w = (float)(r->count - k);
+    sum += w * r->history[idx];
+    wsum += w;
+  }
+  return wsum > 0 ? sum / wsum : 0;
+}
+
+// true jika garis hilang saat robot masih lurus di atasnya (ujung buntu / celah)
+static inline int recovery_lost_centered(const LineRecovery *r) {
+  return fabsf(recovery_trend(r)) < r->center_band;
+}
+
+static inline int recovery_active(const LineRecovery *r) {
+  return r->phase != RECOVERY_IDLE && r->phase != RECOVERY_GAVE_UP;
+}
+
+static inline void recovery_enter(LineRecovery *r, RecoveryPhase p, float now) {
+  r->phase = p;
+  r->phase_start = now;
+}
+
+static inline void recovery_begin(LineRecovery *r, float now) {
+  float trend = recovery_trend(r);
+  r->side = trend >= 0 ? 1 : -1;
+  r->start = now;
+  r->losses++;
+  recovery_enter(r, recovery_lost_centered(r) && r->coast_time > 0 ? RECOVERY_COAST : RECOVERY_SWEEP_FIRST, now);
+}
+
+// Garis ditemukan lagi: catat waktu pemulihan
+static inline void recovery_end(LineRecovery *r, float now) {
+  float dt = now - r->start;
+  if (!recovery_active(r)) return;
+  r->found_in[r->phase]++;
+  r->last_time = dt;
+  r->total_time += dt;
+  if (dt > r->max_time) r->max_time = dt;
+  r->phase = RECOVERY_IDLE;
+  r->count = 0;
+}
+
+// Satu langkah pencarian. Mengembalikan fase yang sedang berjalan;
+// RECOVERY_GAVE_UP berarti pencarian selesai tanpa menemukan garis.
+static inline RecoveryPhase recovery_step(LineRecovery *r, float now, float *left, float *right) {
+  float t = now - r->phase_start;
+  float s = (float)r->side;
+  for (;;) {
+    switch (r->phase) {
+      case RECOVERY_COAST:
+        if (t < r->coast_time) {
+          *left = *right = 1.0f;
+          return r->phase;
+        }
+        recovery_enter(r, RECOVERY_SWEEP_FIRST, now);
+        t = 0;
+        continue;
+
+      case RECOVERY_SWEEP_FIRST:
+        if (t < r->sweep_time) {
+          *left = s * r->sweep_speed;
+          *right = -s * r->sweep_speed;
+          return r->phase;
+        }
+        recovery_enter(r, RECOVERY_SWEEP_BACK, now);
+        t = 0;
+        continue;
+
+      case RECOVERY_SWEEP_BACK:
+        if (t < 2 * r->sweep_time) {
+          *left = -s * r->sweep_speed;
+          *right = s * r->sweep_speed;
+          return r->phase;
+        }
+        recovery_enter(r, r->arc_time > 0 ? RECOVERY_ARC : RECOVERY_UTURN, now);
+        t = 0;
+        continue;
+
+      case RECOVERY_ARC:
+        if (t < r->arc_time) {
+          // spiral ke arah sisi pertama, jari-jari membesar seiring waktu
+          float turn = r->arc_turn / (1.0f + r->arc_growth * t);
+          *left = r->arc_speed + s * turn;
+          *right = r->arc_speed - s * turn;
+          return r->phase;
+        }
+        recovery_enter(r, RECOVERY_UTURN, now);
+        t = 0;
+        continue;
+
+      case RECOVERY_UTURN:
+        if (t < r->uturn_time) {
+          *left = s * r->sweep_speed;
+          *right = -s * r->sweep_speed;
+          return r->phase;
+        }
+        r->failures++;
+        r->total_time += now - r->start;
+        r->last_time = now - r->start;
+        if (r->last_time > r->max_time) r->max_time = r->last_time;
+        r->phase = RECOVERY_GAVE_UP;
+        r->count = 0;
+        *left = *right = 0;
+        return r->phase;
+
+      default:
+        *left = *right = 0;
+        return r->phase;
+    }
+  }
+}
+
+#endif
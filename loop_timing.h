@@ -0,0 +1,78 @@
+// ===============================================================
+// loop_timing.h
+// Histogram waktu per tahap loop (sensing, PID, motor, display, ...)
+// berbasis micros(), cukup ringan untuk dipanggil tiap loop di AVR.
+// Dipakai oleh line_follower1.c, line_maze1.c dan UI.c; nama tahap dan
+// cara menampilkan hasilnya diatur masing-masing sketch.
+//
+// Bin histogram per oktaf: bin 0 = 0..1 us, bin b = 2^b .. 2^(b+1)-1 us,
+// bin terakhir menampung >= 2^(LOOP_TIMING_BINS-1) us. Hitungan 8 bit;
+// jika satu bin penuh semua bin dibagi dua, jadi histogram selalu
+// mencerminkan sampel terbaru. Persentil diinterpolasi linier di dalam bin.
+// ===============================================================
+#ifndef LOOP_TIMING_H
+#define LOOP_TIMING_H
+
+#include <stdint.h>
+
+#define LOOP_TIMING_BINS 16
+
+typedef struct {
+  uint32_t min;
+  uint32_t max;
+  uint16_t count;
+  uint8_t bins[LOOP_TIMING_BINS];
+} StageTiming;
+
+static inline void timing_reset(StageTiming *t) {
+  uint8_t b;
+  t->min = 0xFFFFFFFFUL;
+  t->max = 0;
+  t->count = 0;
+  for (b = 0; b < LOOP_TIMING_BINS; b++) t->bins[b] = 0;
+}
+
+static inline uint8_t timing_bin(uint32_t us) {
+  uint8_t b = 0;
+  while (us > 1 && b < LOOP_TIMING_BINS - 1) {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+static inline void timing_record(StageTiming *t, uint32_t us) {
+  uint8_t b = timing_bin(us);
+  if (us < t->min) t->min = us;
+  if (us > t->max) t->max = us;
+  if (t->count < 0xFFFF) t->count++;
+  if (t->bins[b] == 0xFF) {
+    uint8_t k;
+    for (k = 0; k < LOOP_TIMING_BINS; k++) t->bins[k] >>= 1;
+  }
+  t->bins[b]++;
+}
+
+// Persentil (0..100) dalam us; 0 jika belum ada sampel
+static inline uint32_t timing_percentile(const StageTiming *t, uint8_t pct) {
+  uint16_t total = 0, seen = 0;
+  uint32_t want;
+  uint8_t b;
+  for (b = 0; b < LOOP_TIMING_BINS; b++) total += t->bins[b];
+  if (total == 0) return 0;
+  want = ((uint32_t)total * pct + 99) / 100;
+  for (b = 0; b < LOOP_TIMING_BINS; b++) {
+    if (t->bins[b] && seen + t->bins[b] >= want) {
+      uint32_t lo = b ? (1UL << b) : 0;
+      uint32_t hi = (b == LOOP_TIMING_BINS - 1) ? t->max : (2UL << b) - 1;
+      uint32_t v = lo + (hi - lo) * (want - seen) / t->bins[b];
+      if (v > t->max) v = t->max;
+      if (v < t->min) v = t->min;
+      return v;
+    }
+    seen += t->bins[b];
+  }
+  return t->max;
+}
+
+#endif
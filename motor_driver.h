@@ -0,0 +1,133 @@
+// ===============================================================
+// motor_driver.h
+// Driver H-bridge dua input (IN/IN, mis. DRV8833/TB6612 tanpa pin PWM)
+// dengan PWM Timer1 ~20 kHz, dipakai oleh line_follower1.c, line_maze1.c
+// dan UI.c sebagai pengganti analogWrite langsung ke pin motor.
+//
+// Tiga keadaan per motor:
+//   motor_drive(m, duty)  duty bertanda -255..255 (+ = maju), 0 = coast
+//   motor_coast(m)        kedua input LOW, motor berputar bebas
+//   motor_brake(m)        kedua input HIGH, lilitan dihubung singkat (rem aktif)
+//
+// Timer1 diset phase-correct PWM dengan TOP = ICR1 = MOTOR_PWM_TOP,
+// prescaler 1: 16 MHz / (2 x 400) = 20 kHz (di atas jangkauan dengar, arus
+// motor lebih rata di kecepatan rendah). Hanya pin 9 (OC1A) dan 10 (OC1B)
+// yang bisa; Timer0 dipakai millis() dan Timer2 dipakai tone() serta pin 3
+// (select mux), jadi keduanya tidak diubah. Di ketiga sketch tiap motor
+// punya tepat satu input di pin 9/10, input lainnya digital biasa:
+//   - arah ke pin PWM:     pin PWM = duty, pin lain LOW  (drive/coast)
+//   - arah ke pin digital: pin digital HIGH, pin PWM = 255 - duty (drive/brake)
+// Jika tidak ada input di pin 9/10, kembali ke analogWrite seperti dulu.
+//
+// Setelah motor_timer_init() jangan panggil analogWrite/digitalWrite ke pin
+// 9/10: fungsi Arduino itu mengembalikan Timer1 ke mode 8 bit bawaan.
+// Di host (ARDUINO_HOST) semua keluaran lewat analogWrite/digitalWrite
+// supaya hook arduino_host.h tetap melihat duty 0..255.
+// ===============================================================
+#ifndef MOTOR_DRIVER_H
+#define MOTOR_DRIVER_H
+
+#ifndef ARDUINO_HOST
+#include <Arduino.h>
+#endif
+
+#define MOTOR_PWM_TOP 400  // ICR1, 20 kHz pada 16 MHz
+
+#define MOTOR_COAST 0
+#define MOTOR_BRAKE 1
+#define MOTOR_DRIVE 2
+
+typedef struct {
+  uint8_t in_fwd;           // input yang HIGH saat maju
+  uint8_t in_rev;
+  uint8_t fast_pin;         // pin di Timer1 (9/10), 0 = tidak ada
+  volatile uint16_t *ocr;   // OCR1A/OCR1B untuk fast_pin
+  uint8_t state;
+  int duty;                 // duty terakhir yang diminta (-255..255)
+} MotorBridge;
+
+// Timer1: phase-correct PWM, TOP = ICR1, prescaler 1. Keluaran OC1A/OC1B
+// tersambung permanen; 0% / 100% cukup dengan OCR = 0 / TOP.
+static inline void motor_timer_init(void) {
+#ifndef ARDUINO_HOST
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  ICR1 = MOTOR_PWM_TOP;
+  OCR1A = 0;
+  OCR1B = 0;
+  TCCR1A = _BV(COM1A1) | _BV(COM1B1) | _BV(WGM11);
+  TCCR1B = _BV(WGM13) | _BV(CS10);
+#endif
+}
+
+static inline void motor_pin_pwm(const MotorBridge *m, uint8_t duty) {
+#ifdef ARDUINO_HOST
+  analogWrite(m->fast_pin, duty);
+#else
+  *m->ocr = (uint16_t)(((uint32_t)duty * MOTOR_PWM_TOP + 127) / 255);
+#endif
+}
+
+static inline void motor_pin_level(const MotorBridge *m, uint8_t pin, uint8_t level) {
+  if (pin == m->fast_pin) motor_pin_pwm(m, level ? 255 : 0);
+  else digitalWrite(pin, level);
+}
+
+static inline void motor_coast(MotorBridge *m) {
+  motor_pin_level(m, m->in_fwd, LOW);
+  motor_pin_level(m, m->in_rev, LOW);
+  m->state = MOTOR_COAST;
+  m->duty = 0;
+}
+
+static inline void motor_brake(MotorBridge *m) {
+  motor_pin_level(m, m->in_fwd, HIGH);
+  motor_pin_level(m, m->in_rev, HIGH);
+  m->state = MOTOR_BRAKE;
+  m->duty = 0;
+}
+
+static inline void motor_drive(MotorBridge *m, int duty) {
+  uint8_t from, to, mag;
+  if (duty == 0) {
+    motor_coast(m);
+    return;
+  }
+  if (duty > 255) duty = 255;
+  if (duty < -255) duty = -255;
+  from = duty > 0 ? m->in_fwd : m->in_rev;  // input yang HIGH untuk arah ini
+  to = duty > 0 ? m->in_rev : m->in_fwd;
+  mag = (uint8_t)(duty > 0 ? duty : -duty);
+  if (m->fast_pin == from) {
+    digitalWrite(to, LOW);
+    motor_pin_pwm(m, mag);
+  } else if (m->fast_pin == to) {
+    digitalWrite(from, HIGH);
+    motor_pin_pwm(m, (uint8_t)(255 - mag));
+  } else {
+    analogWrite(to, 0);
+    analogWrite(from, mag);
+  }
+  m->state = MOTOR_DRIVE;
+  m->duty = duty;
+}
+
+// Pin jadi OUTPUT, cari input yang ada di Timer1, lalu coast.
+// Panggil motor_timer_init() sekali sebelum atau sesudahnya.
+static inline void motor_init(MotorBridge *m, uint8_t in_fwd, uint8_t in_rev) {
+  m->in_fwd = in_fwd;
+  m->in_rev = in_rev;
+  m->fast_pin = 0;
+  m->ocr = 0;
+  if (in_fwd == 9 || in_fwd == 10) m->fast_pin = in_fwd;
+  else if (in_rev == 9 || in_rev == 10) m->fast_pin = in_rev;
+#ifndef ARDUINO_HOST
+  if (m->fast_pin) m->ocr = m->fast_pin == 9 ? &OCR1A : &OCR1B;
+#endif
+  pinMode(in_fwd, OUTPUT);
+  pinMode(in_rev, OUTPUT);
+  motor_coast(m);
+}
+
+#endif
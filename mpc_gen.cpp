@@ -0,0 +1,617 @@
+// ===============================================================
+// mpc_gen.cpp
+// Tool PC: membangun kontroler MPC kemudi eksplisit dari model ARX
+// dan menuliskannya sebagai tabel PROGMEM (mpc_table.h) untuk
+// line_follower1.c. Di AVR tinggal mencari region lalu satu perkalian
+// matriks-vektor per tick, tanpa solver QP.
+//
+// Data identifikasi:
+//   -l log   log serial line_follower1 dengan steer 2 (PID + dither PRBS),
+//            y = ERR, u = R - L. Satuan sudah satuan sketch.
+//   -m file  data U/Y1/Y2 di kode_matlab_ARX.m (default jika -l tidak ada).
+//            Data ini tidak mengukur respons kemudi: gain input kecil dan
+//            MPC-nya sama dengan hukum linear yang dipotong.
+//
+// Kompilasi:  g++ -O2 -o mpc_gen mpc_gen.cpp
+// Pakai:      ./mpc_gen [-l steer_id.log | -m kode_matlab_ARX.m] [-o mpc_table.h] [-N horizon]
+//                       [-q Q] [-r R] [-d Rdelta] [-u umax] [-e skala_error] [-p pwm_per_u]
+//   mpc_table.h sekarang: ./mpc_gen -l steer_id.log -N 6 -r 1e-4 -d 1e-3
+//   -N  horizon prediksi (default 4, jumlah region <= 3^N)
+//   -q  bobot error kuadrat (1), -r bobot u kuadrat (0.001), -d bobot perubahan u (0.005)
+//   -u  batas |u| dalam satuan input ARX (default 140 untuk -l, 7 untuk -m)
+//   -e  satuan output ARX per satuan error sketch (default 1 untuk -l, 3 untuk -m)
+//   -p  PWM koreksi per satuan input ARX (default 1 untuk -l, 20 untuk -m)
+//
+// Model (sama dengan arx(data, [2 2 1]) di MATLAB, data dikurangi rata-rata):
+//   y(k) = -a1 y(k-1) - a2 y(k-2) + b1 u(k-1) + b2 u(k-2)
+// Satu langkah model = satu tick kontrol. State x = [y(k), y(k-1), u(k-1)].
+//
+// Biaya: sum q*y^2 + r*u^2 + d*(u - u_sebelumnya)^2 selama N langkah,
+// ditambah biaya akhir dari Riccati (tanpa batas MPC = LQR). Batas |u| <= umax.
+// Untuk tiap pola aktif (bebas / batas atas / batas bawah per langkah)
+// solusi KKT affine terhadap x; region = himpunan x yang memenuhi
+// kelayakan primal dan dual. Region kosong dibuang dengan sampling grid,
+// sisanya diurutkan dari yang paling sering dipakai.
+// ===============================================================
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+typedef std::vector<double> Vec;
+typedef std::vector<Vec> Mat;
+
+static const int NX = 3;
+
+static Mat zeros(int r, int c) { return Mat(r, Vec(c, 0.0)); }
+
+static Mat mul(const Mat& a, const Mat& b) {
+  Mat c = zeros(a.size(), b[0].size());
+  for (size_t i = 0; i < a.size(); i++)
+    for (size_t k = 0; k < b.size(); k++)
+      for (size_t j = 0; j < b[0].size(); j++) c[i][j] += a[i][k] * b[k][j];
+  return c;
+}
+
+static Mat transpose(const Mat& a) {
+  Mat t = zeros(a[0].size(), a.size());
+  for (size_t i = 0; i < a.size(); i++)
+    for (size_t j = 0; j < a[0].size(); j++) t[j][i] = a[i][j];
+  return t;
+}
+
+static Mat add(const Mat& a, const Mat& b) {
+  Mat c = a;
+  for (size_t i = 0; i < a.size(); i++)
+    for (size_t j = 0; j < a[0].size(); j++) c[i][j] += b[i][j];
+  return c;
+}
+
+// Invers Gauss-Jordan dengan pivot parsial; false jika singular
+static bool invert(Mat a, Mat& inv) {
+  int n = a.size();
+  inv = zeros(n, n);
+  for (int i = 0; i < n; i++) inv[i][i] = 1;
+  for (int c = 0; c < n; c++) {
+    int p = c;
+    for (int r = c + 1; r < n; r++)
+      if (fabs(a[r][c]) > fabs(a[p][c])) p = r;
+    if (fabs(a[p][c]) < 1e-12) return false;
+    std::swap(a[c], a[p]);
+    std::swap(inv[c], inv[p]);
+    double d = a[c][c];
+    for (int j = 0; j < n; j++) {
+      a[c][j] /= d;
+      inv[c][j] /= d;
+    }
+    for (int r = 0; r < n; r++) {
+      if (r == c || a[r][c] == 0) continue;
+      double f = a[r][c];
+      for (int j = 0; j < n; j++) {
+        a[r][j] -= f * a[c][j];
+        inv[r][j] -= f * inv[c][j];
+      }
+    }
+  }
+  return true;
+}
+
+// ========== DATA ARX ==========
+static bool readArray(const std::string& text, const char* name, Vec& out) {
+  std::string key = std::string("\n") + name + " = [";
+  size_t at = text.find(key);
+  if (at == std::string::npos) return false;
+  const char* p = text.c_str() + at + key.size();
+  while (*p && *p != ']') {
+    char* end;
+    double v = strtod(p, &end);
+    if (end == p) {
+      p++;
+      continue;
+    }
+    out.push_back(v);
+    p = end;
+  }
+  return !out.empty();
+}
+
+// Log serial line_follower1 (baris "ERR: e | L: l | R: r ..."): y = error,
+// u = R - L = koreksi setelah constrain(), dalam PWM
+static bool readLog(const char* file, Vec& u, Vec& y) {
+  FILE* f = fopen(file, "r");
+  if (!f) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    float e;
+    int l, r;
+    if (sscanf(line, "ERR: %f | L: %d | R: %d", &e, &l, &r) != 3) continue;
+    y.push_back(e);
+    u.push_back(r - l);
+  }
+  fclose(f);
+  return y.size() > 10;
+}
+
+// Kuadrat terkecil untuk theta = [a1 a2 b1 b2]
+static bool fitArx(const Vec& u, const Vec& y, double theta[4], double& rms) {
+  Mat ata = zeros(4, 4);
+  Vec aty(4, 0.0);
+  int n = y.size();
+  for (int k = 2; k < n; k++) {
+    double phi[4] = {-y[k - 1], -y[k - 2], u[k - 1], u[k - 2]};
+    for (int i = 0; i < 4; i++) {
+      aty[i] += phi[i] * y[k];
+      for (int j = 0; j < 4; j++) ata[i][j] += phi[i] * phi[j];
+    }
+  }
+  Mat inv;
+  if (!invert(ata, inv)) return false;
+  for (int i = 0; i < 4; i++) {
+    theta[i] = 0;
+    for (int j = 0; j < 4; j++) theta[i] += inv[i][j] * aty[j];
+  }
+  double sse = 0;
+  for (int k = 2; k < n; k++) {
+    double e = y[k] + theta[0] * y[k - 1] + theta[1] * y[k - 2] - theta[2] * u[k - 1] - theta[3] * u[k - 2];
+    sse += e * e;
+  }
+  rms = sqrt(sse / (n - 2));
+  return true;
+}
+
+// ========== MPC ==========
+struct Problem {
+  int N;
+  double umax;
+  Mat A, B;      // x+ = A x + B u
+  Mat Q, R, S;   // biaya tahap x'Qx + u'Ru + 2x'Su
+  Mat P;         // biaya akhir (Riccati)
+  Mat Muu, Mux;  // J = U'Muu U + 2 x'Mux' U + ...
+  Mat Kinf;      // LQR tanpa batas, u = Kinf x
+};
+
+struct Region {
+  Mat H;         // H x <= h
+  Vec h;
+  double K[NX];  // u0 = K x + k
+  double k;
+  long hits;
+  std::string pattern;
+};
+
+static void riccati(Problem& pr) {
+  Mat P = pr.Q;
+  Mat At = transpose(pr.A), Bt = transpose(pr.B), St = transpose(pr.S);
+  for (int it = 0; it < 5000; it++) {
+    Mat BtPB = add(mul(mul(Bt, P), pr.B), pr.R);
+    Mat BtPA = add(mul(mul(Bt, P), pr.A), St);
+    Mat inv;
+    invert(BtPB, inv);
+    Mat K = mul(inv, BtPA);  // u = -K x
+    Mat next = add(mul(mul(At, P), pr.A), pr.Q);
+    Mat corr = mul(transpose(BtPA), K);
+    double diff = 0;
+    for (int i = 0; i < NX; i++)
+      for (int j = 0; j < NX; j++) {
+        next[i][j] -= corr[i][j];
+        diff = std::max(diff, fabs(next[i][j] - P[i][j]));
+      }
+    P = next;
+    pr.Kinf = K;
+    if (diff < 1e-10) break;
+  }
+  for (int j = 0; j < NX; j++) pr.Kinf[0][j] = -pr.Kinf[0][j];
+  pr.P = P;
+}
+
+// Bentuk kondensasi: z = [x; U], x_i = L_i z, u_i = E_i z
+static void condense(Problem& pr) {
+  int n = NX + pr.N;
+  Mat M = zeros(n, n);
+  Mat L = zeros(NX, n);
+  for (int i = 0; i < NX; i++) L[i][i] = 1;
+  for (int i = 0; i <= pr.N; i++) {
+    const Mat& W = (i == pr.N) ? pr.P : pr.Q;
+    M = add(M, mul(mul(transpose(L), W), L));
+    if (i == pr.N) break;
+    Mat E = zeros(1, n);
+    E[0][NX + i] = 1;
+    M = add(M, mul(mul(transpose(E), pr.R), E));
+    Mat cross = mul(mul(transpose(L), pr.S), E);
+    M = add(M, add(cross, transpose(cross)));
+    L = add(mul(pr.A, L), mul(pr.B, E));
+  }
+  pr.Muu = zeros(pr.N, pr.N);
+  pr.Mux = zeros(pr.N, NX);
+  for (int i = 0; i < pr.N; i++) {
+    for (int j = 0; j < pr.N; j++) pr.Muu[i][j] = M[NX + i][NX + j];
+    for (int j = 0; j < NX; j++) pr.Mux[i][j] = M[NX + i][j];
+  }
+}
+
+// Region untuk satu pola: s[i] = 0 bebas, +1 di batas atas, -1 di batas bawah
+static bool buildRegion(const Problem& pr, const std::vector<int>& s, Region& reg) {
+  int N = pr.N;
+  std::vector<int> f, a;
+  for (int i = 0; i < N; i++) (s[i] ? a : f).push_back(i);
+
+  // U = G x + g
+  Mat G = zeros(N, NX);
+  Vec g(N, 0.0);
+  for (int i : a) g[i] = s[i] * pr.umax;
+  if (!f.empty()) {
+    Mat Mff = zeros(f.size(), f.size()), inv;
+    for (size_t i = 0; i < f.size(); i++)
+      for (size_t j = 0; j < f.size(); j++) Mff[i][j] = pr.Muu[f[i]][f[j]];
+    if (!invert(Mff, inv)) return false;
+    for (size_t i = 0; i < f.size(); i++) {
+      for (size_t j = 0; j < f.size(); j++) {
+        for (int c = 0; c < NX; c++) G[f[i]][c] -= inv[i][j] * pr.Mux[f[j]][c];
+        for (int idx : a) g[f[i]] -= inv[i][j] * pr.Muu[f[j]][idx] * g[idx];
+      }
+    }
+  }
+
+  reg.H.clear();
+  reg.h.clear();
+  reg.pattern.clear();
+  for (int i = 0; i < N; i++) {
+    reg.pattern += s[i] > 0 ? '+' : s[i] < 0 ? '-' : '0';
+    if (s[i] == 0) {
+      // -umax <= G_i x + g_i <= umax
+      reg.H.push_back(G[i]);
+      reg.h.push_back(pr.umax - g[i]);
+      Vec neg(NX);
+      for (int c = 0; c < NX; c++) neg[c] = -G[i][c];
+      reg.H.push_back(neg);
+      reg.h.push_back(pr.umax + g[i]);
+    } else {
+      // pengali >= 0  <=>  s_i * (Muu_i U + Mux_i x) <= 0
+      Vec row(NX, 0.0);
+      double c0 = 0;
+      for (int c = 0; c < NX; c++) {
+        row[c] = pr.Mux[i][c];
+        for (int j = 0; j < N; j++) row[c] += pr.Muu[i][j] * G[j][c];
+        row[c] *= s[i];
+      }
+      for (int j = 0; j < N; j++) c0 += pr.Muu[i][j] * g[j];
+      reg.H.push_back(row);
+      reg.h.push_back(-s[i] * c0);
+    }
+  }
+  for (int c = 0; c < NX; c++) reg.K[c] = G[0][c];
+  reg.k = g[0];
+  reg.hits = 0;
+  return true;
+}
+
+static bool inside(const Region& r, const double x[NX], double tol) {
+  for (size_t i = 0; i < r.H.size(); i++) {
+    double v = 0;
+    for (int c = 0; c < NX; c++) v += r.H[i][c] * x[c];
+    if (v > r.h[i] + tol) return false;
+  }
+  return true;
+}
+
+// Sama persis dengan pencarian di firmware: region pertama yang memuat x,
+// jika tidak ada (di luar semua region karena pembulatan) pakai LQR yang dibatasi
+static double explicitLaw(const std::vector<Region>& regs, const Problem& pr, const double x[NX], int* which) {
+  for (size_t r = 0; r < regs.size(); r++) {
+    if (!inside(regs[r], x, 1e-4)) continue;
+    if (which) *which = r;
+    double u = regs[r].k;
+    for (int c = 0; c < NX; c++) u += regs[r].K[c] * x[c];
+    return std::max(-pr.umax, std::min(pr.umax, u));
+  }
+  if (which) *which = -1;
+  double u = 0;
+  for (int c = 0; c < NX; c++) u += pr.Kinf[0][c] * x[c];
+  return std::max(-pr.umax, std::min(pr.umax, u));
+}
+
+// QP referensi: proyeksi gradien, hanya untuk memeriksa tabel
+static double solveQp(const Problem& pr, const double x[NX]) {
+  int N = pr.N;
+  Vec U(N, 0.0), lin(N, 0.0);
+  double L = 0;
+  for (int i = 0; i < N; i++) {
+    for (int c = 0; c < NX; c++) lin[i] += pr.Mux[i][c] * x[c];
+    double row = 0;
+    for (int j = 0; j < N; j++) row += fabs(pr.Muu[i][j]);
+    L = std::max(L, row);
+  }
+  for (int it = 0; it < 20000; it++) {
+    double moved = 0;
+    for (int i = 0; i < N; i++) {
+      double grad = lin[i];
+      for (int j = 0; j < N; j++) grad += pr.Muu[i][j] * U[j];
+      double v = std::max(-pr.umax, std::min(pr.umax, U[i] - grad / L));
+      moved = std::max(moved, fabs(v - U[i]));
+      U[i] = v;
+    }
+    if (moved < 1e-10) break;
+  }
+  return U[0];
+}
+
+static void step(const Problem& pr, double x[NX], double u) {
+  double y = pr.A[0][0] * x[0] + pr.A[0][1] * x[1] + pr.A[0][2] * x[2] + pr.B[0][0] * u;
+  x[1] = x[0];
+  x[0] = y;
+  x[2] = u;
+}
+
+// Simulasi loop tertutup dari error awal y0: langkah sampai |y| < 5% y0 dan overshoot
+static void simulate(const Problem& pr, const std::vector<Region>* regs, double y0, int& settle, double& overshoot) {
+  double x[NX] = {y0, y0, 0};
+  settle = -1;
+  overshoot = 0;
+  for (int k = 0; k < 200; k++) {
+    double u;
+    if (regs) {
+      u = explicitLaw(*regs, pr, x, NULL);
+    } else {
+      u = 0;
+      for (int c = 0; c < NX; c++) u += pr.Kinf[0][c] * x[c];
+      u = std::max(-pr.umax, std::min(pr.umax, u));
+    }
+    step(pr, x, u);
+    if (x[0] * y0 < 0) overshoot = std::max(overshoot, fabs(x[0]) / fabs(y0));
+    if (fabs(x[0]) >= 0.05 * fabs(y0)) settle = -1;
+    else if (settle < 0) settle = k + 1;
+  }
+}
+
+// Literal float C: 7 -> "7.0f", 0.5 -> "0.5f"
+static std::string lit(double v) {
+  char b[32];
+  snprintf(b, sizeof(b), "%.7g", v);
+  std::string out = b;
+  if (out.find_first_of(".e") == std::string::npos) out += ".0";
+  return out + "f";
+}
+
+static void usage() {
+  fprintf(stderr,
+          "pakai: mpc_gen [-l steer_id.log | -m kode_matlab_ARX.m] [-o mpc_table.h] [-N horizon] [-q Q] [-r R] [-d Rdelta]\n"
+          "               [-u umax] [-e skala_error] [-p pwm_per_u]\n");
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  const char* mfile = "kode_matlab_ARX.m";
+  const char* logFile = NULL;
+  const char* outFile = "mpc_table.h";
+  Problem pr;
+  pr.N = 4;
+  pr.umax = 0;
+  double q = 1.0, r = 0.001, rd = 0.005;
+  double errorScale = 0, pwmPerU = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] || i + 1 >= argc) usage();
+    const char* v = argv[++i];
+    switch (argv[i - 1][1]) {
+      case 'm': mfile = v; break;
+      case 'l': logFile = v; break;
+      case 'o': outFile = v; break;
+      case 'N': pr.N = atoi(v); break;
+      case 'q': q = atof(v); break;
+      case 'r': r = atof(v); break;
+      case 'd': rd = atof(v); break;
+      case 'u': pr.umax = atof(v); break;
+      case 'e': errorScale = atof(v); break;
+      case 'p': pwmPerU = atof(v); break;
+      default: usage();
+    }
+  }
+  // Default satuan: data MATLAB perlu skala ke sketch, log sudah dalam satuan sketch
+  if (pr.umax == 0) pr.umax = logFile ? 140 : 7;
+  if (errorScale == 0) errorScale = logFile ? 1.0 : 3.0;
+  if (pwmPerU == 0) pwmPerU = logFile ? 1.0 : 20.0;
+  if (pr.N < 1 || pr.N > 8 || pr.umax <= 0) usage();
+
+  Vec u, y;
+  if (logFile) {
+    // Data loop tertutup dari robot: satuan sudah satuan sketch
+    if (!readLog(logFile, u, y)) {
+      fprintf(stderr, "%s: baris ERR/L/R tidak ditemukan\n", logFile);
+      return 1;
+    }
+  } else {
+    // Langkah 1: data dan sinkronisasi, seperti di skrip MATLAB
+    FILE* f = fopen(mfile, "r");
+    if (!f) {
+      fprintf(stderr, "tidak bisa membuka %s\n", mfile);
+      return 1;
+    }
+    std::string text = "\n";
+    char buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, got);
+    fclose(f);
+    Vec U, Y1, Y2;
+    if (!readArray(text, "U", U) || !readArray(text, "Y1", Y1) || !readArray(text, "Y2", Y2)) {
+      fprintf(stderr, "%s: array U/Y1/Y2 tidak ditemukan\n", mfile);
+      return 1;
+    }
+    size_t n = std::min(U.size(), std::min(Y1.size(), Y2.size()));
+    for (size_t k = 0; k < n; k++) {
+      u.push_back(U[k]);
+      y.push_back((Y1[k] + Y2[k]) / 2);
+    }
+  }
+  size_t n = y.size();
+  double um = 0, ym = 0;
+  for (size_t k = 0; k < n; k++) {
+    um += u[k] / n;
+    ym += y[k] / n;
+  }
+  for (size_t k = 0; k < n; k++) {
+    u[k] -= um;
+    y[k] -= ym;
+  }
+
+  // Langkah 2: ARX [2 2 1]
+  double th[4], rms;
+  if (!fitArx(u, y, th, rms)) {
+    fprintf(stderr, "data ARX singular\n");
+    return 1;
+  }
+  double dcGain = (th[2] + th[3]) / (1 + th[0] + th[1]);
+  printf("ARX: %zu sampel, a1=%.4f a2=%.4f b1=%.4f b2=%.4f, rms residu %.2f, gain DC %.3f\n",
+         n, th[0], th[1], th[2], th[3], rms, dcGain);
+
+  pr.A = zeros(NX, NX);
+  pr.A[0][0] = -th[0];
+  pr.A[0][1] = -th[1];
+  pr.A[0][2] = th[3];
+  pr.A[1][0] = 1;
+  pr.B = zeros(NX, 1);
+  pr.B[0][0] = th[2];
+  pr.B[2][0] = 1;
+  pr.Q = zeros(NX, NX);
+  pr.Q[0][0] = q;
+  pr.Q[2][2] = rd;
+  pr.R = zeros(1, 1);
+  pr.R[0][0] = r + rd;
+  pr.S = zeros(NX, 1);
+  pr.S[2][0] = -rd;
+
+  riccati(pr);
+  condense(pr);
+  printf("LQR tanpa batas: u = %.4f y + %.4f y1 + %.4f u1\n", pr.Kinf[0][0], pr.Kinf[0][1], pr.Kinf[0][2]);
+
+  // Semua pola aktif 3^N
+  std::vector<Region> regs;
+  int patterns = 1;
+  for (int i = 0; i < pr.N; i++) patterns *= 3;
+  for (int p = 0; p < patterns; p++) {
+    std::vector<int> s(pr.N);
+    for (int i = 0, v = p; i < pr.N; i++, v /= 3) s[i] = v % 3 - 1;
+    Region reg;
+    if (buildRegion(pr, s, reg)) regs.push_back(reg);
+  }
+
+  // Sampling ruang state: |y|, |y1| sampai error maksimum, |u1| <= umax
+  double ybox = 7.0 * errorScale;
+  const int G = 41;
+  long samples = 0;
+  for (int i = 0; i < G; i++)
+    for (int j = 0; j < G; j++)
+      for (int k = 0; k < G; k++) {
+        double x[NX] = {ybox * (2.0 * i / (G - 1) - 1), ybox * (2.0 * j / (G - 1) - 1),
+                        pr.umax * (2.0 * k / (G - 1) - 1)};
+        samples++;
+        for (Region& reg : regs)
+          if (inside(reg, x, 1e-9)) reg.hits++;
+      }
+  regs.erase(std::remove_if(regs.begin(), regs.end(), [](const Region& r) { return r.hits == 0; }), regs.end());
+  std::stable_sort(regs.begin(), regs.end(), [](const Region& a, const Region& b) { return a.hits > b.hits; });
+  printf("%zu region dari %d pola (grid %ld titik)\n", regs.size(), patterns, samples);
+
+  // Periksa tabel terhadap QP langsung di titik acak
+  srand(1);
+  double worst = 0;
+  int misses = 0;
+  for (int t = 0; t < 20000; t++) {
+    double x[NX];
+    for (int c = 0; c < NX; c++) x[c] = (c == 2 ? pr.umax : ybox) * (2.0 * rand() / RAND_MAX - 1);
+    int which;
+    double ue = explicitLaw(regs, pr, x, &which);
+    if (which < 0) misses++;
+    worst = std::max(worst, fabs(ue - solveQp(pr, x)));
+  }
+  printf("cek 20000 titik acak: selisih maks vs QP %.2e, di luar region %d\n", worst, misses);
+
+  // Bedanya dengan hukum linear yang dipotong constrain(): kalau nol, MPC tidak berguna
+  int differ = 0;
+  double widest = 0;
+  for (int t = 0; t < 20000; t++) {
+    double x[NX];
+    for (int c = 0; c < NX; c++) x[c] = (c == 2 ? pr.umax : ybox) * (2.0 * rand() / RAND_MAX - 1);
+    double ul = 0;
+    for (int c = 0; c < NX; c++) ul += pr.Kinf[0][c] * x[c];
+    ul = std::max(-pr.umax, std::min(pr.umax, ul));
+    double d = fabs(explicitLaw(regs, pr, x, NULL) - ul);
+    if (d > 0.01 * pr.umax) differ++;
+    widest = std::max(widest, d);
+  }
+  printf("beda dari linear+constrain (> 1%% umax) di %.1f%% titik, maks %.1f\n", differ / 200.0, widest);
+
+  // Bandingkan dengan hukum linear yang dipotong constrain() seperti PID sekarang
+  for (double e0 = 2; e0 <= 7; e0 += 2.5) {
+    int sm, sc;
+    double om, oc;
+    simulate(pr, &regs, e0 * errorScale, sm, om);
+    simulate(pr, NULL, e0 * errorScale, sc, oc);
+    printf("error awal %.1f: MPC settle %d tick overshoot %.0f%% | linear+constrain settle %d tick overshoot %.0f%%\n",
+           e0, sm, om * 100, sc, oc * 100);
+  }
+
+  // Tanda: koreksi positif di sketch mengurangi error (seperti Kp > 0),
+  // jadi y model = -error * skala jika gain DC positif. Model dari log
+  // sudah memakai tanda sketch.
+  double ySign = logFile || dcGain < 0 ? 1.0 : -1.0;
+  size_t rows = 2 * pr.N;
+
+  FILE* o = fopen(outFile, "w");
+  if (!o) {
+    fprintf(stderr, "tidak bisa menulis %s\n", outFile);
+    return 1;
+  }
+  fprintf(o, "// ===============================================================\n");
+  fprintf(o, "// %s - DIBUAT OLEH mpc_gen.cpp, jangan diedit manual.\n", outFile);
+  fprintf(o, "// Kontroler MPC kemudi eksplisit untuk line_follower1.c.\n");
+  fprintf(o, "// ARX dari %s: a1=%.4f a2=%.4f b1=%.4f b2=%.4f (gain DC %.3f)\n", logFile ? logFile : mfile,
+          th[0], th[1], th[2], th[3], dcGain);
+  fprintf(o, "// Horizon %d, q=%g r=%g d=%g, |u| <= %g, %zu region\n", pr.N, q, r, rd, pr.umax, regs.size());
+  fprintf(o, "//\n");
+  fprintf(o, "// State x = {y, y sebelumnya, u sebelumnya} dengan y = error * MPC_Y_PER_ERROR.\n");
+  fprintf(o, "// Region r berlaku jika mpcRows[r][i] . x <= mpcRowLimit[r][i] untuk semua\n");
+  fprintf(o, "// baris i; maka u = mpcGain[r] . x + mpcOffset[r]. Baris dengan koefisien\n");
+  fprintf(o, "// dan batas nol adalah pengisi. Tidak ada region cocok -> pakai mpcFallback.\n");
+  fprintf(o, "// ===============================================================\n");
+  fprintf(o, "#ifndef MPC_TABLE_H\n#define MPC_TABLE_H\n\n");
+  fprintf(o, "#define MPC_REGIONS %zu\n", regs.size());
+  fprintf(o, "#define MPC_ROWS %zu\n", rows);
+  fprintf(o, "#define MPC_U_MAX %s\n", lit(pr.umax).c_str());
+  fprintf(o, "#define MPC_Y_PER_ERROR %s\n", lit(ySign * errorScale).c_str());
+  fprintf(o, "#define MPC_PWM_PER_U %s\n\n", lit(pwmPerU).c_str());
+  fprintf(o, "const float mpcRows[MPC_REGIONS][MPC_ROWS][3] PROGMEM = {\n");
+  for (const Region& reg : regs) {
+    fprintf(o, "  { // %s\n", reg.pattern.c_str());
+    for (size_t i = 0; i < rows; i++) {
+      if (i < reg.H.size())
+        fprintf(o, "    {%s, %s, %s},\n", lit(reg.H[i][0]).c_str(), lit(reg.H[i][1]).c_str(), lit(reg.H[i][2]).c_str());
+      else
+        fprintf(o, "    {0, 0, 0},\n");
+    }
+    fprintf(o, "  },\n");
+  }
+  fprintf(o, "};\n\n");
+  fprintf(o, "const float mpcRowLimit[MPC_REGIONS][MPC_ROWS] PROGMEM = {\n");
+  for (const Region& reg : regs) {
+    fprintf(o, "  {");
+    for (size_t i = 0; i < rows; i++) fprintf(o, "%s%s", i ? ", " : "", lit(i < reg.h.size() ? reg.h[i] : 0.0).c_str());
+    fprintf(o, "},\n");
+  }
+  fprintf(o, "};\n\n");
+  fprintf(o, "const float mpcGain[MPC_REGIONS][3] PROGMEM = {\n");
+  for (const Region& reg : regs) fprintf(o, "  {%s, %s, %s},\n", lit(reg.K[0]).c_str(), lit(reg.K[1]).c_str(), lit(reg.K[2]).c_str());
+  fprintf(o, "};\n\n");
+  fprintf(o, "const float mpcOffset[MPC_REGIONS] PROGMEM = {\n");
+  for (const Region& reg : regs) fprintf(o, "  %s,\n", lit(reg.k).c_str());
+  fprintf(o, "};\n\n");
+  fprintf(o, "const float mpcFallback[3] PROGMEM = {%s, %s, %s};\n\n", lit(pr.Kinf[0][0]).c_str(),
+          lit(pr.Kinf[0][1]).c_str(), lit(pr.Kinf[0][2]).c_str());
+  fprintf(o, "#endif\n");
+  fclose(o);
+  printf("ditulis %s (%zu byte flash)\n", outFile, regs.size() * (rows * 4 + 4) * 4 + 12);
+  return 0;
+}
@@ -0,0 +1,290 @@
+// ===============================================================
+// mpc_table.h - DIBUAT OLEH mpc_gen.cpp, jangan diedit manual.
+// Kontroler MPC kemudi eksplisit untuk line_follower1.c.
+// ARX dari steer_id.log: a1=-0.6673 a2=-0.4356 b1=-0.0081 b2=-0.0030 (gain DC 0.108)
+// Horizon 6, q=1 r=1e-05 d=0.0001, |u| <= 140, 15 region
+//
+// State x = {y, y sebelumnya, u sebelumnya} dengan y = error * MPC_Y_PER_ERROR.
+// Region r berlaku jika mpcRows[r][i] . x <= mpcRowLimit[r][i] untuk semua
+// baris i; maka u = mpcGain[r] . x + mpcOffset[r]. Baris dengan koefisien
+// dan batas nol adalah pengisi. Tidak ada region cocok -> pakai mpcFallback.
+// ===============================================================
+#ifndef MPC_TABLE_H
+#define MPC_TABLE_H
+
+#define MPC_REGIONS 15
+#define MPC_ROWS 12
+#define MPC_U_MAX 140.0f
+#define MPC_Y_PER_ERROR 1.0f
+#define MPC_PWM_PER_U 1.0f
+
+const float mpcRows[MPC_REGIONS][MPC_ROWS][3] PROGMEM = {
+  { // 000000
+    {39.65588f, 18.54038f, 0.1231257f},
+    {-39.65588f, -18.54038f, -0.1231257f},
+    {37.09591f, 13.57839f, -0.1434069f},
+    {-37.09591f, -13.57839f, 0.1434069f},
+    {20.68169f, 7.907595f, -0.1659877f},
+    {-20.68169f, -7.907595f, 0.1659877f},
+    {8.456003f, 2.813505f, -0.1031345f},
+    {-8.456003f, -2.813505f, 0.1031345f},
+    {1.639142f, 0.4964573f, -0.04651044f},
+    {-1.639142f, -0.4964573f, 0.04651044f},
+    {-0.7827989f, -0.3954277f, -0.01228086f},
+    {0.7827989f, 0.3954277f, 0.01228086f},
+  },
+  { // --0000
+    {0.01939644f, 0.008769065f, 3.966145e-05f},
+    {0.01795027f, 0.006890475f, -4.741227e-05f},
+    {47.30188f, 19.60281f, -0.1348839f},
+    {-47.30188f, -19.60281f, 0.1348839f},
+    {41.73601f, 16.69725f, -0.1148911f},
+    {-41.73601f, -16.69725f, 0.1148911f},
+    {23.49375f, 9.456004f, -0.06506527f},
+    {-23.49375f, -9.456004f, 0.06506527f},
+    {9.325754f, 3.68343f, -0.0253451f},
+    {-9.325754f, -3.68343f, 0.0253451f},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ++0000
+    {-0.01939644f, -0.008769065f, -3.966145e-05f},
+    {-0.01795027f, -0.006890475f, 4.741227e-05f},
+    {47.30188f, 19.60281f, -0.1348839f},
+    {-47.30188f, -19.60281f, 0.1348839f},
+    {41.73601f, 16.69725f, -0.1148911f},
+    {-41.73601f, -16.69725f, 0.1148911f},
+    {23.49375f, 9.456004f, -0.06506527f},
+    {-23.49375f, -9.456004f, 0.06506527f},
+    {9.325754f, 3.68343f, -0.0253451f},
+    {-9.325754f, -3.68343f, 0.0253451f},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ---000
+    {0.02854367f, 0.01255985f, 1.357763e-05f},
+    {0.02171155f, 0.00844922f, -5.813774e-05f},
+    {0.01886798f, 0.007819258f, -5.380308e-05f},
+    {51.16549f, 20.60501f, -0.1417798f},
+    {-51.16549f, -20.60501f, 0.1417798f},
+    {44.54604f, 18.18048f, -0.125097f},
+    {-44.54604f, -18.18048f, 0.125097f},
+    {25.13246f, 10.23403f, -0.07041877f},
+    {-25.13246f, -10.23403f, 0.07041877f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // +++000
+    {-0.02854367f, -0.01255985f, -1.357763e-05f},
+    {-0.02171155f, -0.00844922f, 5.813774e-05f},
+    {-0.01886798f, -0.007819258f, 5.380308e-05f},
+    {51.16549f, 20.60501f, -0.1417798f},
+    {-51.16549f, -20.60501f, 0.1417798f},
+    {44.54604f, 18.18048f, -0.125097f},
+    {-44.54604f, -18.18048f, 0.125097f},
+    {25.13246f, 10.23403f, -0.07041877f},
+    {-25.13246f, -10.23403f, 0.07041877f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ----00
+    {0.03914686f, 0.0168299f, -1.580387e-05f},
+    {0.03160592f, 0.01243381f, -8.55551e-05f},
+    {0.02293648f, 0.009457694f, -6.50769e-05f},
+    {0.02040912f, 0.008219019f, -5.655377e-05f},
+    {54.74572f, 22.28803f, -0.1533604f},
+    {-54.74572f, -22.28803f, 0.1533604f},
+    {47.9043f, 19.40455f, -0.1335196f},
+    {-47.9043f, -19.40455f, 0.1335196f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ++++00
+    {-0.03914686f, -0.0168299f, 1.580387e-05f},
+    {-0.03160592f, -0.01243381f, 8.55551e-05f},
+    {-0.02293648f, -0.009457694f, 6.50769e-05f},
+    {-0.02040912f, -0.008219019f, 5.655377e-05f},
+    {54.74572f, 22.28803f, -0.1533604f},
+    {-54.74572f, -22.28803f, 0.1533604f},
+    {47.9043f, 19.40455f, -0.1335196f},
+    {-47.9043f, -19.40455f, 0.1335196f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // -----0
+    {0.05132867f, 0.02178934f, -4.992902e-05f},
+    {0.04295106f, 0.01705263f, -0.0001173365f},
+    {0.0335232f, 0.01376775f, -9.47337e-05f},
+    {0.0247623f, 0.009991282f, -6.874843e-05f},
+    {0.02183722f, 0.008890347f, -6.117307e-05f},
+    {58.81769f, 23.8476f, -0.1640916f},
+    {-58.81769f, -23.8476f, 0.1640916f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // +++++0
+    {-0.05132867f, -0.02178934f, 4.992902e-05f},
+    {-0.04295106f, -0.01705263f, 0.0001173365f},
+    {-0.0335232f, -0.01376775f, 9.47337e-05f},
+    {-0.0247623f, -0.009991282f, 6.874843e-05f},
+    {-0.02183722f, -0.008890347f, 6.117307e-05f},
+    {58.81769f, 23.8476f, -0.1640916f},
+    {-58.81769f, -23.8476f, 0.1640916f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ------
+    {0.0653713f, 0.02748292f, -8.910562e-05f},
+    {0.05603894f, 0.02235911f, -0.0001538495f},
+    {0.04571218f, 0.01870976f, -0.0001287389f},
+    {0.03613646f, 0.01460293f, -0.0001004804f},
+    {0.02651419f, 0.01078662f, -7.422104e-05f},
+    {0.02346146f, 0.009512437f, -6.545357e-05f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // ++++++
+    {-0.0653713f, -0.02748292f, 8.910562e-05f},
+    {-0.05603894f, -0.02235911f, 0.0001538495f},
+    {-0.04571218f, -0.01870976f, 0.0001287389f},
+    {-0.03613646f, -0.01460293f, 0.0001004804f},
+    {-0.02651419f, -0.01078662f, 7.422104e-05f},
+    {-0.02346146f, -0.009512437f, 6.545357e-05f},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+    {0, 0, 0},
+  },
+  { // -00000
+    {0.01581811f, 0.007395471f, 4.911294e-05f},
+    {45.00118f, 17.27436f, -0.1188622f},
+    {-45.00118f, -17.27436f, 0.1188622f},
+    {38.33103f, 16.15922f, -0.1111891f},
+    {-38.33103f, -16.15922f, 0.1111891f},
+    {21.70767f, 9.00908f, -0.06199006f},
+    {-21.70767f, -9.00908f, 0.06199006f},
+    {8.455862f, 3.683491f, -0.02534552f},
+    {-8.455862f, -3.683491f, 0.02534552f},
+    {1.590192f, 0.7140209f, -0.004913065f},
+    {-1.590192f, -0.7140209f, 0.004913065f},
+    {0, 0, 0},
+  },
+  { // +00000
+    {-0.01581811f, -0.007395471f, -4.911294e-05f},
+    {45.00118f, 17.27436f, -0.1188622f},
+    {-45.00118f, -17.27436f, 0.1188622f},
+    {38.33103f, 16.15922f, -0.1111891f},
+    {-38.33103f, -16.15922f, 0.1111891f},
+    {21.70767f, 9.00908f, -0.06199006f},
+    {-21.70767f, -9.00908f, 0.06199006f},
+    {8.455862f, 3.683491f, -0.02534552f},
+    {-8.455862f, -3.683491f, 0.02534552f},
+    {1.590192f, 0.7140209f, -0.004913065f},
+    {-1.590192f, -0.7140209f, 0.004913065f},
+    {0, 0, 0},
+  },
+  { // 0-0000
+    {46.76819f, 21.14374f, 0.09563063f},
+    {-46.76819f, -21.14374f, -0.09563063f},
+    {0.01423144f, 0.005209201f, -5.501647e-05f},
+    {24.62858f, 9.352295f, -0.1812458f},
+    {-24.62858f, -9.352295f, 0.1812458f},
+    {21.95828f, 7.75581f, -0.1553322f},
+    {-21.95828f, -7.75581f, 0.1553322f},
+    {12.33898f, 4.412971f, -0.08787432f},
+    {-12.33898f, -4.412971f, 0.08787432f},
+    {4.924554f, 1.693662f, -0.03434458f},
+    {-4.924554f, -1.693662f, 0.03434458f},
+    {0, 0, 0},
+  },
+  { // 0+0000
+    {46.76819f, 21.14374f, 0.09563063f},
+    {-46.76819f, -21.14374f, -0.09563063f},
+    {-0.01423144f, -0.005209201f, 5.501647e-05f},
+    {24.62858f, 9.352295f, -0.1812458f},
+    {-24.62858f, -9.352295f, 0.1812458f},
+    {21.95828f, 7.75581f, -0.1553322f},
+    {-21.95828f, -7.75581f, 0.1553322f},
+    {12.33898f, 4.412971f, -0.08787432f},
+    {-12.33898f, -4.412971f, 0.08787432f},
+    {4.924554f, 1.693662f, -0.03434458f},
+    {-4.924554f, -1.693662f, 0.03434458f},
+    {0, 0, 0},
+  },
+};
+
+const float mpcRowLimit[MPC_REGIONS][MPC_ROWS] PROGMEM = {
+  {140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f, 140.0f},
+  {-0.06919531f, -0.06697612f, 44.2192f, 235.7808f, 18.48689f, 261.5131f, 59.82502f, 220.175f, 102.7595f, 177.2405f, 0.0f, 0.0f},
+  {-0.06919531f, -0.06697612f, 235.7808f, 44.2192f, 261.5131f, 18.48689f, 220.175f, 59.82502f, 177.2405f, 102.7595f, 0.0f, 0.0f},
+  {-0.1147906f, -0.08572456f, -0.0940493f, -28.51529f, 308.5153f, -45.11216f, 325.1122f, 23.96946f, 256.0305f, 0.0f, 0.0f, 0.0f},
+  {-0.1147906f, -0.08572456f, -0.0940493f, 308.5153f, -28.51529f, 325.1122f, -45.11216f, 256.0305f, 23.96946f, 0.0f, 0.0f, 0.0f},
+  {-0.1787252f, -0.1453852f, -0.1185813f, -0.123062f, -106.6137f, 386.6137f, -113.3391f, 393.3391f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.1787252f, -0.1453852f, -0.1185813f, -0.123062f, 386.6137f, -106.6137f, 393.3391f, -113.3391f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.264753f, -0.2255044f, -0.1933446f, -0.1538041f, -0.1542142f, -190.4094f, 470.4094f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.264753f, -0.2255044f, -0.1933446f, -0.1538041f, -0.1542142f, 470.4094f, -190.4094f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.3770625f, -0.3301781f, -0.2908291f, -0.2447718f, -0.1916195f, -0.187639f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.3770625f, -0.3301781f, -0.2908291f, -0.2447718f, -0.1916195f, -0.187639f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+  {-0.05584382f, 112.0914f, 167.9086f, 77.69126f, 202.3087f, 93.21669f, 186.7833f, 115.9344f, 164.0656f, 131.6225f, 148.3775f, 0.0f},
+  {-0.05584382f, 167.9086f, 112.0914f, 202.3087f, 77.69126f, 186.7833f, 93.21669f, 164.0656f, 115.9344f, 148.3775f, 131.6225f, 0.0f},
+  {113.1581f, 166.8419f, -0.05370945f, 125.1044f, 154.8956f, 89.04238f, 190.9576f, 99.6188f, 180.3812f, 118.4604f, 161.5396f, 0.0f},
+  {166.8419f, 113.1581f, -0.05370945f, 154.8956f, 125.1044f, 190.9576f, 89.04238f, 180.3812f, 99.6188f, 161.5396f, 118.4604f, 0.0f},
+};
+
+const float mpcGain[MPC_REGIONS][3] PROGMEM = {
+  {39.65588f, 18.54038f, 0.1231257f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {0.0f, 0.0f, 0.0f},
+  {46.76819f, 21.14374f, 0.09563063f},
+  {46.76819f, 21.14374f, 0.09563063f},
+};
+
+const float mpcOffset[MPC_REGIONS] PROGMEM = {
+  0.0f,
+  -140.0f,
+  140.0f,
+  -140.0f,
+  140.0f,
+  -140.0f,
+  140.0f,
+  -140.0f,
+  140.0f,
+  -140.0f,
+  140.0f,
+  -140.0f,
+  140.0f,
+  26.84189f,
+  -26.84189f,
+};
+
+const float mpcFallback[3] PROGMEM = {39.65588f, 18.54038f, 0.1231257f};
+
+#endif
@@ -0,0 +1,351 @@
+// ===============================================================
+// oled_pages.h
+// Driver SSD1306 128x64 (I2C) tanpa framebuffer penuh, pengganti
+// Adafruit_SSD1306 di line_follower1.c, line_maze1.c dan UI.c.
+//
+// Perintah gambar (teks, kotak, garis, titik) hanya dicatat ke daftar
+// kecil. display() lalu menggambar layar per page 8 baris, 16 kolom
+// sekaligus, dan langsung mengirim potongan itu lewat I2C. RAM yang
+// dipakai ~OLED_ITEMS*5 + OLED_TEXT + 16 byte, bukan 1 KB buffer.
+//
+// API sama dengan subset Adafruit yang dipakai sketch: begin, clearDisplay,
+// display, dim, setCursor, setTextSize, setTextColor, print/println (Print),
+// drawPixel, drawLine, drawRect, fillRect. Bedanya: gambar baru tampil
+// setelah display(), dan isi layar tidak bisa dibaca balik.
+// Jika daftar penuh perintah berikutnya dibuang dan dihitung di dropped.
+// ===============================================================
+#ifndef OLED_PAGES_H
+#define OLED_PAGES_H
+
+#ifndef ARDUINO_HOST
+#include <Arduino.h>
+#include <Wire.h>
+#endif
+
+#ifndef SSD1306_SWITCHCAPVCC
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#endif
+
+#ifndef OLED_ITEMS
+#define OLED_ITEMS 40      // jumlah perintah gambar per layar
+#endif
+#ifndef OLED_TEXT
+#define OLED_TEXT 176      // jumlah karakter teks per layar
+#endif
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64
+#define OLED_STRIP 16      // kolom per transfer I2C (buffer Wire 32 byte)
+
+// Font 5x7 ASCII 0x20..0x7E, satu byte per kolom, bit 0 = baris atas
+static const uint8_t oledFont[95][5] PROGMEM = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+  {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+  {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+  {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+  {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+  {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+  {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+  {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+  {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+  {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+  {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+  {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+  {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+  {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+  {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+  {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+  {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+  {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+  {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+  {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+  {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+  {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+  {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+  {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+  {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+class SSD1306Pages : public Print {
+ public:
+  using Print::write;
+
+  enum { ITEM_FILL, ITEM_LINE, ITEM_TEXT };
+
+  // kind: bit 0-1 jenis, bit 2-3 warna, bit 4-5 ukuran teks - 1, bit 6 latar teks
+  struct Item {
+    uint8_t kind;
+    uint8_t x, y;
+    uint8_t a, b;   // FILL: lebar, tinggi; LINE: x1, y1; TEXT: awal dan panjang di text[]
+  };
+
+  unsigned int dropped;  // perintah yang dibuang karena daftar penuh
+
+  SSD1306Pages(uint8_t address = 0x3C) : dropped(0), addr(address) { clearDisplay(); }
+
+  bool begin(uint8_t vcc = SSD1306_SWITCHCAPVCC, uint8_t address = 0x3C) {
+    addr = address;
+    Wire.begin();
+    Wire.setClock(400000);
+    static const uint8_t init[] PROGMEM = {
+      0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+      0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0xAF,
+    };
+    Wire.beginTransmission(addr);
+    Wire.write((uint8_t)0x00);
+    bool ok = Wire.endTransmission() == 0;
+    for (uint8_t i = 0; i < sizeof(init); i++) {
+      uint8_t c = pgm_read_byte(&init[i]);
+      if (c == 0x14 && vcc != SSD1306_SWITCHCAPVCC) c = 0x10;  // charge pump mati untuk VCC luar
+      command(c);
+    }
+    clearDisplay();
+    display();
+    return ok;
+  }
+
+  void clearDisplay() {
+    count = 0;
+    textUsed = 0;
+    cursorX = cursorY = 0;
+    textOpen = false;
+  }
+
+  void setCursor(int x, int y) {
+    cursorX = x;
+    cursorY = y;
+    textOpen = false;
+  }
+
+  void setTextSize(uint8_t s) {
+    textSize = s < 1 ? 1 : (s > 4 ? 4 : s);
+    textOpen = false;
+  }
+
+  void setTextColor(uint16_t c) {
+    textColor = c;
+    textBg = false;
+    textOpen = false;
+  }
+
+  // Latar teks hanya didukung sebagai kebalikan warna teks (teks putih di atas hitam atau sebaliknya)
+  void setTextColor(uint16_t c, uint16_t bg) {
+    textColor = c;
+    textBg = bg != c;
+    textOpen = false;
+  }
+
+  void dim(bool on) {
+    command(0x81);
+    command(on ? 0x00 : 0xCF);
+  }
+
+  void drawPixel(int x, int y, uint16_t color) { fillRect(x, y, 1, 1, color); }
+
+  void fillRect(int x, int y, int w, int h, uint16_t color) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > OLED_WIDTH) w = OLED_WIDTH - x;
+    if (y + h > OLED_HEIGHT) h = OLED_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
+    add(ITEM_FILL, color, x, y, w, h);
+  }
+
+  void drawRect(int x, int y, int w, int h, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y + 1, 1, h - 2, color);
+    fillRect(x + w - 1, y + 1, 1, h - 2, color);
+  }
+
+  void drawLine(int x0, int y0, int x1, int y1, uint16_t color) {
+    if (y0 == y1) fillRect(min(x0, x1), y0, abs(x1 - x0) + 1, 1, color);
+    else if (x0 == x1) fillRect(x0, min(y0, y1), 1, abs(y1 - y0) + 1, color);
+    else if (x0 >= 0 && x1 >= 0 && y0 >= 0 && y1 >= 0 && x0 < OLED_WIDTH && x1 < OLED_WIDTH &&
+             y0 < OLED_HEIGHT && y1 < OLED_HEIGHT)
+      add(ITEM_LINE, color, x0, y0, x1, y1);
+  }
+
+  size_t write(uint8_t c) {
+    if (c == '\n') {
+      cursorX = 0;
+      cursorY += 8 * textSize;
+      textOpen = false;
+      return 1;
+    }
+    if (c == '\r') return 1;
+    if (cursorX + 6 * textSize > OLED_WIDTH) {  // wrap seperti Adafruit
+      cursorX = 0;
+      cursorY += 8 * textSize;
+      textOpen = false;
+    }
+    if (cursorX < 0 || cursorY < 0 || cursorY >= OLED_HEIGHT) {
+      cursorX += 6 * textSize;
+      return 1;
+    }
+    if (textUsed >= OLED_TEXT || (!textOpen && count >= OLED_ITEMS)) {
+      dropped++;
+      cursorX += 6 * textSize;
+      return 1;
+    }
+    if (!textOpen) {
+      add(ITEM_TEXT, textColor, cursorX, cursorY, textUsed, 0);
+      items[count - 1].kind |= (uint8_t)(((textSize - 1) << 4) | (textBg ? 0x40 : 0));
+      textOpen = true;
+    }
+    text[textUsed++] = (char)c;
+    items[count - 1].b++;
+    cursorX += 6 * textSize;
+    return 1;
+  }
+
+  // Gambar semua page dan kirim ke layar; daftar perintah tetap (panggil clearDisplay untuk layar baru)
+  void display() {
+    command(0x21);
+    command(0);
+    command(OLED_WIDTH - 1);
+    command(0x22);
+    command(0);
+    command(OLED_HEIGHT / 8 - 1);
+    for (uint8_t page = 0; page < OLED_HEIGHT / 8; page++) {
+      for (uint8_t x0 = 0; x0 < OLED_WIDTH; x0 += OLED_STRIP) {
+        renderStrip(page, x0);
+        Wire.beginTransmission(addr);
+        Wire.write((uint8_t)0x40);
+        Wire.write(strip, OLED_STRIP);
+        Wire.endTransmission();
+      }
+    }
+  }
+
+  // Satu potongan 16 kolom x 8 baris ke strip[] (dipisah supaya bisa diuji tanpa layar)
+  void renderStrip(uint8_t page, uint8_t x0) {
+    uint8_t top = page * 8;
+    memset(strip, 0, OLED_STRIP);
+    for (uint8_t i = 0; i < count; i++) {
+      const Item& it = items[i];
+      uint8_t type = it.kind & 0x03;
+      uint8_t color = (it.kind >> 2) & 0x03;
+      if (type == ITEM_FILL) {
+        if (it.x >= x0 + OLED_STRIP || it.x + it.a <= x0) continue;
+        if (it.y >= top + 8 || it.y + it.b <= top) continue;
+        uint8_t mask = rowMask(top, it.y, it.y + it.b);
+        uint8_t from = max(it.x, x0), to = min(it.x + it.a, x0 + OLED_STRIP);
+        for (uint8_t x = from; x < to; x++) apply(x - x0, mask, mask, color, false);
+      } else if (type == ITEM_LINE) {
+        drawLineStrip(it, top, x0, color);
+      } else {
+        drawTextStrip(it, top, x0, color);
+      }
+    }
+  }
+
+  uint8_t strip[OLED_STRIP];
+
+ private:
+  Item items[OLED_ITEMS];
+  char text[OLED_TEXT];
+  uint8_t count;
+  uint8_t textUsed;
+  int cursorX, cursorY;
+  uint8_t textSize = 1;
+  uint8_t textColor = SSD1306_WHITE;
+  bool textBg = false;
+  bool textOpen;
+  uint8_t addr;
+
+  void command(uint8_t c) {
+    Wire.beginTransmission(addr);
+    Wire.write((uint8_t)0x00);
+    Wire.write(c);
+    Wire.endTransmission();
+  }
+
+  void add(uint8_t type, uint16_t color, uint8_t x, uint8_t y, uint8_t a, uint8_t b) {
+    textOpen = false;
+    if (count >= OLED_ITEMS) {
+      dropped++;
+      return;
+    }
+    Item& it = items[count++];
+    it.kind = type | ((color & 0x03) << 2);
+    it.x = x;
+    it.y = y;
+    it.a = a;
+    it.b = b;
+  }
+
+  // Bit baris [y0, y1) yang jatuh di page mulai baris top
+  static uint8_t rowMask(uint8_t top, int y0, int y1) {
+    uint8_t mask = 0;
+    for (uint8_t r = 0; r < 8; r++)
+      if (top + r >= y0 && top + r < y1) mask |= 1 << r;
+    return mask;
+  }
+
+  // bits = piksel menyala, cover = area yang ditimpa latar (jika opaque)
+  void apply(uint8_t col, uint8_t bits, uint8_t cover, uint8_t color, bool opaque) {
+    uint8_t& b = strip[col];
+    if (opaque) {
+      if (color == SSD1306_BLACK) b = (b | cover) & ~bits;
+      else b = (b & ~cover) | bits;
+    } else if (color == SSD1306_WHITE) {
+      b |= bits;
+    } else if (color == SSD1306_BLACK) {
+      b &= ~bits;
+    } else {
+      b ^= bits;
+    }
+  }
+
+  void drawLineStrip(const Item& it, uint8_t top, uint8_t x0, uint8_t color) {
+    int x = it.x, y = it.y, x1 = it.a, y1 = it.b;
+    int dx = abs(x1 - x), sx = x < x1 ? 1 : -1;
+    int dy = -abs(y1 - y), sy = y < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+      if (x >= x0 && x < x0 + OLED_STRIP && y >= top && y < top + 8) apply(x - x0, 1 << (y - top), 0, color, false);
+      if (x == x1 && y == y1) break;
+      int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x += sx; }
+      if (e2 <= dx) { err += dx; y += sy; }
+    }
+  }
+
+  void drawTextStrip(const Item& it, uint8_t top, uint8_t x0, uint8_t color) {
+    uint8_t size = ((it.kind >> 4) & 0x03) + 1;
+    bool opaque = it.kind & 0x40;
+    int cell = 6 * size;
+    if (it.y >= top + 8 || it.y + 8 * size <= top) return;
+    if (it.x >= x0 + OLED_STRIP || it.x + it.b * cell <= x0) return;
+    uint8_t cover = rowMask(top, it.y, it.y + 8 * size);
+    int first = x0 > it.x ? (x0 - it.x) / cell : 0;
+    for (int n = first; n < it.b; n++) {
+      int cx = it.x + n * cell;
+      if (cx >= x0 + OLED_STRIP) break;
+      uint8_t ch = (uint8_t)text[it.a + n];
+      if (ch < 0x20 || ch > 0x7E) ch = '?';
+      for (int col = max(cx, (int)x0); col < min(cx + cell, x0 + OLED_STRIP); col++) {
+        uint8_t gx = (col - cx) / size;
+        uint8_t glyph = gx < 5 ? pgm_read_byte(&oledFont[ch - 0x20][gx]) : 0;
+        uint8_t bits = 0;
+        for (uint8_t r = 0; r < 8; r++) {
+          int gy = top + r - it.y;
+          if (gy >= 0 && gy < 8 * size && (glyph >> (gy / size)) & 1) bits |= 1 << r;
+        }
+        apply(col - x0, bits, cover, color, opaque);
+      }
+    }
+  }
+};
+
+#endif
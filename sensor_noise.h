@@ -0,0 +1,70 @@
+// ===============================================================
+// sensor_noise.h
+// Derau sensor IR yang bisa diulang (seed tetap), untuk benchmark
+// Webots. Supervisor benchmark (benchmark_supervisor.c) memberi
+// argumen controller:
+//
+//   --seed=<n>     seed generator (xorshift32)
+//   --noise=<s>    simpangan baku relatif, mis. 0.05 = 5% dari nilai
+//
+// Tanpa argumen derau nol, jadi controller berjalan seperti biasa.
+// Derau DistanceSensor bawaan Webots tidak dipakai karena seed-nya
+// hanya bisa diatur per world, bukan per run.
+// ===============================================================
+#ifndef SENSOR_NOISE_H
+#define SENSOR_NOISE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  uint32_t state;
+  double sigma;
+  double spare;      // sampel Gauss kedua dari Box-Muller
+  int has_spare;
+} SensorNoise;
+
+static inline void noise_init(SensorNoise *n, int argc, char **argv) {
+  int i;
+  n->state = 1;
+  n->sigma = 0;
+  n->has_spare = 0;
+  for (i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--seed=", 7) == 0) n->state = (uint32_t)strtoul(argv[i] + 7, NULL, 10);
+    else if (strncmp(argv[i], "--noise=", 8) == 0) n->sigma = atof(argv[i] + 8);
+  }
+  if (n->state == 0) n->state = 1;  // xorshift macet di nol
+}
+
+static inline double noise_uniform(SensorNoise *n) {
+  uint32_t x = n->state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  n->state = x;
+  return (x + 0.5) / 4294967296.0;  // (0, 1)
+}
+
+static inline double noise_gauss(SensorNoise *n) {
+  double r, a;
+  if (n->has_spare) {
+    n->has_spare = 0;
+    return n->spare;
+  }
+  r = sqrt(-2.0 * log(noise_uniform(n)));
+  a = 6.283185307179586 * noise_uniform(n);
+  n->spare = r * sin(a);
+  n->has_spare = 1;
+  return r * cos(a);
+}
+
+// Nilai sensor dengan derau relatif, tidak pernah negatif
+static inline double noise_apply(SensorNoise *n, double value) {
+  if (n->sigma <= 0) return value;
+  value *= 1.0 + n->sigma * noise_gauss(n);
+  return value < 0 ? 0 : value;
+}
+
+#endif
@@ -0,0 +1,187 @@
+// ===============================================================
+// sil_webots.cpp
+// Controller Webots software-in-the-loop: firmware Arduino asli
+// (line_maze1.c, atau line_follower1.c) dijalankan apa adanya di atas
+// arduino_host.h, dan hook I/O-nya diteruskan ke device robot Webots:
+//
+//   analogRead(analogPin)   -> ir1..ir8 sesuai kanal mux (selectPins),
+//                              dengan emitter dipulsa bila SENSOR_PULSED
+//   analogWrite/digitalWrite pin motor (lewat motor_driver.h)
+//                           -> motorkiri / motorkanan, duty bersih
+//                              (input maju - input mundur) x maxVelocity
+//   encoderTicks[]          <- position sensor roda (jika ada di world)
+//   millis()/micros()       =  waktu simulasi: setiap jam virtual melewati
+//                              satu basic time step, wb_robot_step() dipanggil
+//   Serial                  -> console Webots (stdout)
+//
+// Dengan begitu loop() firmware bisa diuji di lintasan simulasi (mode
+// fast) tanpa flash dan tanpa baterai. Tidak ada logika firmware yang
+// disalin; yang disimulasikan hanya pin dan waktunya.
+//
+// Kompilasi (folder controllers/sil_webots/ di project Webots):
+//   W=$WEBOTS_HOME; g++ -O2 -Wno-narrowing -I<repo> -I$W/include/controller/c
+//     -o sil_webots sil_webots.cpp -L$W/lib/controller -lController
+//   firmware lain: -DSIL_FIRMWARE='"line_follower1.c"' -DSIL_ENCODERS=0
+//   tanpa Webots (benchmark/sil.txt): g++ -O2 -Wno-narrowing -Iwebots_host -I.
+//     -o sil_maze sil_webots.cpp webots_host.cpp
+//
+// Pemetaan nilai IR: lookup table distance sensor di world memberi nilai
+// tinggi di atas garis (THRESHOLD 300 di controller Webots), sedangkan ADC
+// robot memberi nilai rendah di atas garis. SIL_IR_FLOOR/SIL_IR_LINE
+// (nilai Webots) dipetakan linear ke SIL_ADC_FLOOR/SIL_ADC_LINE, sesuaikan
+// dengan world supaya threshold firmware berada di antara keduanya.
+// Kecepatan: duty 255 = maxVelocity motor di world; TICKS_PER_SEC_PER_PWM
+// dan MM_PER_TICK firmware perlu cocok dengan robot simulasi supaya
+// feedforward loop roda dan odometri benar.
+// ===============================================================
+#include "arduino_host.h"
+
+#ifndef SIL_FIRMWARE
+#define SIL_FIRMWARE "line_maze1.c"
+#endif
+#ifndef SIL_ENCODERS
+#define SIL_ENCODERS 1   // firmware punya encoderTicks[] (line_maze1.c)
+#endif
+#include SIL_FIRMWARE
+
+#include <webots/robot.h>
+#include <webots/motor.h>
+#include <webots/distance_sensor.h>
+#include <webots/position_sensor.h>
+
+#define SIL_IR_FLOOR 100.0      // nilai Webots di lantai
+#define SIL_IR_LINE 900.0       // nilai Webots tepat di atas garis
+#define SIL_ADC_FLOOR 950.0     // ADC robot di lantai (emitter nyala)
+#define SIL_ADC_LINE 300.0      // ADC robot di atas garis
+#define SIL_ADC_AMBIENT 40      // ADC saat emitter mati
+#define SIL_WHEEL_RADIUS_MM 20.0
+
+static WbDeviceTag irSensors[8];
+static WbDeviceTag motors[2];          // KIRI, KANAN
+static WbDeviceTag wheelSensors[2];
+static double maxVelocity[2];
+static double wheelStartMm[2];         // posisi roda saat controller mulai
+static uint8_t pinLevel[32];           // duty terakhir per pin, digital HIGH = 255
+static uint64_t nextStepUs = 0;
+static int stepMs = 32;
+
+static int silMuxChannel() {
+  int ch = 0;
+  for (int i = 0; i < 3; i++) {
+    if (pinLevel[selectPins[i]]) ch |= 1 << i;
+  }
+  return ch;
+}
+
+static int silAnalogRead(uint8_t pin) {
+  if (pin != analogPin) return 0;  // pin baterai dll: 0 = tidak terpasang, kompensasi mati
+#if SENSOR_PULSED
+  if (!pinLevel[emitterPin]) return SIL_ADC_AMBIENT;
+  const int ambient = SIL_ADC_AMBIENT;
+#else
+  const int ambient = 0;
+#endif
+  double v = wb_distance_sensor_get_value(irSensors[silMuxChannel()]);
+  double k = (v - SIL_IR_FLOOR) / (SIL_IR_LINE - SIL_IR_FLOOR);
+  double adc = SIL_ADC_FLOOR + constrain(k, 0.0, 1.0) * (SIL_ADC_LINE - SIL_ADC_FLOOR);
+  return constrain((int)adc + ambient, 0, 1023);
+}
+
+static void silDigitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(pinLevel)) pinLevel[pin] = value ? 255 : 0;
+}
+
+static void silAnalogWrite(uint8_t pin, int value) {
+  if (pin < sizeof(pinLevel)) pinLevel[pin] = (uint8_t)constrain(value, 0, 255);
+}
+
+// Frame biner TRACE_RECORD harus lewat utuh (termasuk byte 0x0D), jadi
+// stdout controller bisa langsung diputar ulang dengan trace_replay
+static void silSerialWrite(uint8_t c) {
+#if defined(TRACE_RECORD) && TRACE_RECORD
+  putchar(c);
+#else
+  if (c != '\r') putchar(c);
+#endif
+}
+
+// Duty bersih H-bridge: drive/coast dan drive/brake sama-sama memberi
+// rata-rata tegangan (fwd - rev) / 255; rem (keduanya HIGH) = 0
+static void silApplyMotors() {
+  const MotorBridge* bridge[2] = {&motorKiri, &motorKanan};
+  for (int w = 0; w < 2; w++) {
+    int duty = pinLevel[bridge[w]->in_fwd] - pinLevel[bridge[w]->in_rev];
+    wb_motor_set_velocity(motors[w], duty / 255.0 * maxVelocity[w]);
+  }
+}
+
+static void silReadEncoders() {
+#if SIL_ENCODERS
+  for (int w = 0; w < 2; w++) {
+    if (!wheelSensors[w]) continue;
+    double mm = wb_position_sensor_get_value(wheelSensors[w]) * SIL_WHEEL_RADIUS_MM - wheelStartMm[w];
+    encoderTicks[w] = lround(mm / MM_PER_TICK) * encoderDir[w];
+  }
+#endif
+}
+
+static void silStep() {
+  silApplyMotors();
+  if (wb_robot_step(stepMs) == -1) {
+    fflush(stdout);
+    wb_robot_cleanup();
+    exit(0);
+  }
+  silReadEncoders();
+}
+
+// Jam virtual firmware maju (delay, delayMicroseconds): jalankan simulasi
+// sampai waktu simulasi menyusul
+static void silAdvance(uint64_t) {
+  while (hostClockUs >= nextStepUs) {
+    silStep();
+    nextStepUs += (uint64_t)stepMs * 1000;
+  }
+}
+
+int main() {
+  wb_robot_init();
+  stepMs = (int)wb_robot_get_basic_time_step();
+  const char* motorNames[2] = {"motorkiri", "motorkanan"};
+  for (int w = 0; w < 2; w++) {
+    motors[w] = wb_robot_get_device(motorNames[w]);
+    wb_motor_set_position(motors[w], INFINITY);
+    wb_motor_set_velocity(motors[w], 0.0);
+    maxVelocity[w] = wb_motor_get_max_velocity(motors[w]);
+    wheelSensors[w] = wb_motor_get_position_sensor(motors[w]);
+    if (wheelSensors[w]) wb_position_sensor_enable(wheelSensors[w], stepMs);
+  }
+  for (int i = 0; i < 8; i++) {
+    char name[4] = {'i', 'r', (char)('1' + i), 0};
+    irSensors[i] = wb_robot_get_device(name);
+    wb_distance_sensor_enable(irSensors[i], stepMs);
+  }
+  if (SIL_ENCODERS && (!wheelSensors[0] || !wheelSensors[1])) {
+    printf("SIL: motor tanpa PositionSensor, encoder firmware tetap 0\n");
+  }
+
+  // tombol dan pin input lain tidak ditekan (pull-up)
+  for (int p = 0; p < 3; p++) *portInputRegister(p) = 0xFF;
+  hostHooks.analogRead = silAnalogRead;
+  hostHooks.digitalWrite = silDigitalWrite;
+  hostHooks.analogWrite = silAnalogWrite;
+  hostHooks.serialWrite = silSerialWrite;
+
+  silStep();  // nilai sensor pertama baru ada setelah satu step
+  // Sudut roda tidak ikut di-reset saat supervisor memindah robot; encoder
+  // firmware mulai dari 0 seperti setelah reset board
+  for (int w = 0; w < 2; w++) {
+    if (wheelSensors[w]) wheelStartMm[w] = wb_position_sensor_get_value(wheelSensors[w]) * SIL_WHEEL_RADIUS_MM;
+  }
+  silReadEncoders();
+  hostClockUs = (uint64_t)stepMs * 1000;
+  nextStepUs = 2 * hostClockUs;
+  hostHooks.advanceUs = silAdvance;
+  setup();
+  for (;;) loop();
+}
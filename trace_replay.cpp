@@ -0,0 +1,205 @@
+// ===============================================================
+// trace_replay.cpp
+// Memutar ulang trace sensorStates (hasil TRACE_RECORD di line_maze1.c)
+// melalui navigate() asli dari line_maze1.c, lalu mencetak path[] dan
+// urutan manuver yang dihasilkan. Tidak ada logika navigasi yang
+// disalin: sketch-nya di-include apa adanya di atas arduino_host.h.
+//
+// Kompilasi:  g++ -O2 -Wno-narrowing -o trace_replay trace_replay.cpp
+//             (-Wno-narrowing: sama seperti -fpermissive pada toolchain Arduino)
+// Pakai:      ./trace_replay [-q] [-v] [-n ulang] run1.trc [run2.trc ...]
+//   -q  satu baris ringkasan per trace
+//   -v  seluruh log Serial firmware (bukan hanya manuver)
+//   -n  ulangi setiap trace N kali (untuk profiling / benchmark)
+//
+// File trace boleh berupa tangkapan mentah port Serial: teks log
+// diabaikan, hanya frame biner yang dipakai:
+//   0xA4, states, dt(16), dTick kiri(16), dTick kanan(16)  -> 8 byte
+//   0xA5, states, dt(16)                                     -> 4 byte (format lama, tanpa encoder)
+// Tick encoder dimasukkan ke encoderTicks[] sketch supaya odometri
+// (jarak segmen, peta simpang eksplorasi) sama dengan di robot.
+// Keputusan navigate() (pendingPath tiap loop: L/S/R/U di simpang dan
+// buntu) dikumpulkan per trace. Jika ada <trace>.expect berisi urutan
+// keputusan yang diharapkan (mis. "LLSL"), hasilnya dibandingkan dan
+// exit code != 0 bila ada yang tidak cocok.
+//
+// Uji regresi: trace rekaman SIL di benchmark/ (cara merekam lihat
+// benchmark/maze_finish.trk), dijalankan dari root repo:
+//   ./trace_replay -q benchmark/*.trc
+// ===============================================================
+#include "arduino_host.h"
+#define TRACE_REPLAY 1
+#include "line_maze1.c"
+
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <time.h>
+
+#define TRACE_SYNC_V1 0xA5
+
+struct TraceFrame {
+  uint64_t tUs;
+  uint8_t states;
+  int16_t dTick[2];
+};
+
+struct SerialEvent {
+  unsigned long ms;
+  std::string text;
+};
+
+static std::vector<TraceFrame> frames;
+static size_t frameIdx = 0;
+static std::vector<SerialEvent> events;
+static std::string serialLine;
+
+int traceReplayNextFrame() {
+  static int last = 0;
+  if (frameIdx >= frames.size()) {
+    // Trace habis di tengah manuver: lompatkan jam supaya semua timeout lewat
+    hostClockUs += 3600ULL * 1000000ULL;
+    return last;
+  }
+  const TraceFrame& f = frames[frameIdx++];
+  if (hostClockUs < f.tUs) hostClockUs = f.tUs;
+  encoderTicks[KIRI] += f.dTick[KIRI];
+  encoderTicks[KANAN] += f.dTick[KANAN];
+  last = f.states;
+  return last;
+}
+
+static void serialSink(uint8_t c) {
+  if (c == '\r') return;
+  if (c == '\n') {
+    events.push_back({millis(), serialLine});
+    serialLine.clear();
+    return;
+  }
+  serialLine += (char)c;
+}
+
+static bool loadTrace(const char* file, std::vector<TraceFrame>& out) {
+  FILE* fp = fopen(file, "rb");
+  if (!fp) return false;
+  std::vector<uint8_t> buf;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+  fclose(fp);
+
+  out.clear();
+  uint64_t t = 0;
+  for (size_t i = 0; i + 3 < buf.size();) {
+    size_t len = buf[i] == TRACE_SYNC ? 8 : (buf[i] == TRACE_SYNC_V1 ? 4 : 0);
+    if (len == 0 || i + len > buf.size()) {
+      i++;  // teks log biasa (selalu ASCII < 0x80)
+      continue;
+    }
+    TraceFrame f;
+    t += (uint64_t)(buf[i + 2] | (buf[i + 3] << 8)) * 1000;
+    f.tUs = t;
+    f.states = buf[i + 1];
+    f.dTick[KIRI] = f.dTick[KANAN] = 0;
+    if (len == 8) {
+      f.dTick[KIRI] = (int16_t)(buf[i + 4] | (buf[i + 5] << 8));
+      f.dTick[KANAN] = (int16_t)(buf[i + 6] | (buf[i + 7] << 8));
+    }
+    out.push_back(f);
+    i += len;
+  }
+  return true;
+}
+
+static bool readExpect(const char* file, std::string& expect) {
+  std::string name = std::string(file) + ".expect";
+  FILE* fp = fopen(name.c_str(), "r");
+  if (!fp) return false;
+  char line[256] = "";
+  if (fgets(line, sizeof(line), fp)) {
+    line[strcspn(line, "\r\n \t")] = '\0';
+  }
+  fclose(fp);
+  expect = line;
+  return true;
+}
+
+// Jalankan satu trace dari keadaan awal sketch; dipanggil di proses anak
+// sehingga semua variabel global firmware mulai bersih setiap kali.
+static int runTrace(const char* file, bool quiet, bool verbose, bool print) {
+  hostHooks.serialWrite = serialSink;
+  setup();
+  std::string decisions;
+  while (frameIdx < frames.size()) {
+    loop();
+    if (pendingPath) decisions += pendingPath;
+  }
+
+  std::string expect;
+  bool hasExpect = readExpect(file, expect);
+  bool pass = !hasExpect || expect == decisions;
+  if (!print) return pass ? 0 : 1;
+
+  printf("%s: %zu frame, %.2f s, keputusan=%s path=%s", file, frames.size(),
+         frames.empty() ? 0.0 : frames.back().tUs / 1e6, decisions.c_str(), path);
+  if (hasExpect) printf(" [%s, harapan %s]", pass ? "PASS" : "FAIL", expect.c_str());
+  printf("\n");
+  if (!quiet) {
+    for (size_t i = 0; i < events.size(); i++) {
+      const std::string& e = events[i].text;
+      if (!verbose && (e.compare(0, 4, "Path") == 0)) continue;
+      printf("  [%8lu ms] %s\n", events[i].ms, e.c_str());
+    }
+  }
+  return pass ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  bool quiet = false, verbose = false;
+  long repeat = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, "qvn:")) != -1) {
+    if (opt == 'q') quiet = true;
+    else if (opt == 'v') verbose = true;
+    else if (opt == 'n') repeat = atol(optarg);
+    else {
+      fprintf(stderr, "pakai: %s [-q] [-v] [-n ulang] trace...\n", argv[0]);
+      return 2;
+    }
+  }
+  if (optind >= argc || repeat < 1) {
+    fprintf(stderr, "pakai: %s [-q] [-v] [-n ulang] trace...\n", argv[0]);
+    return 2;
+  }
+
+  int failed = 0;
+  long runs = 0;
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (int a = optind; a < argc; a++) {
+    if (!loadTrace(argv[a], frames)) {
+      fprintf(stderr, "%s: tidak bisa dibaca\n", argv[a]);
+      failed++;
+      continue;
+    }
+    for (long r = 0; r < repeat; r++) {
+      fflush(stdout);
+      pid_t pid = fork();
+      if (pid == 0) {
+        int rc = runTrace(argv[a], quiet, verbose, r == 0);
+        fflush(stdout);
+        _exit(rc);
+      }
+      int status = 0;
+      waitpid(pid, &status, 0);
+      if (r == 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) failed++;
+      runs++;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+  if (runs > 1) {
+    printf("%ld replay dalam %.3f s (%.0f trace/s), %d gagal\n", runs, sec, runs / sec, failed);
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,352 @@
+// ===============================================================
+// tune_cli.cpp
+// Tool PC untuk live tuning line_follower1.c / line_maze1.c lewat port
+// Serial memakai protokol di tune_protocol.h, tanpa flash ulang.
+//
+// Kompilasi:  g++ -O2 -o tune_cli tune_cli.cpp
+// Pakai:      ./tune_cli -p /dev/ttyUSB0 [-b baud] [-w detik] [-v] [-f skrip] perintah...
+//   -p  port Serial robot
+//   -b  baud (default 9600; line_maze1 dengan TRACE_RECORD memakai 115200)
+//   -w  tunggu setelah port dibuka, Arduino reset saat DTR (default 2 detik)
+//   -v  tampilkan semua log teks robot, bukan hanya saat wait/sweep
+//   -f  jalankan perintah dari file (satu perintah per baris, # komentar)
+//
+// Perintah:
+//   list                                   daftar parameter, batas dan nilainya
+//   get NAMA                               baca satu parameter
+//   set NAMA NILAI                         ubah parameter (dibatasi min/max di robot)
+//   commit                                 simpan semua parameter ke EEPROM robot
+//   stats [reset]                          cetak tabel waktu per tahap loop (min/p50/p99/maks),
+//                                          reset = kosongkan histogram setelahnya
+//   dump [eeprom]                          cetak rekaman perekam kejadian (line_maze1): buffer RAM,
+//                                          atau salinan EEPROM dari pemicu terakhir
+//   wait DETIK                             tunggu sambil mencetak log robot
+//   sweep NAMA AWAL AKHIR LANGKAH DETIK    coba tiap nilai selama DETIK, log robot diberi
+//                                          label [NAMA=nilai]; nilai awal dikembalikan di akhir
+//
+// Contoh:
+//   ./tune_cli -p /dev/ttyUSB0 set BASE_SPEED 70 sweep Kp 8 14 1 5 > kp.log
+// ===============================================================
+#include "tune_protocol.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct Param {
+  uint8_t id;
+  uint8_t type;
+  float min, max, value;
+};
+
+static int port = -1;
+static bool verbose = false;
+static bool logText = false;
+static std::string label;
+static std::string textLine;
+static TuneParser parser;
+static std::map<std::string, Param> params;
+static std::vector<std::string> order;
+
+static long nowMs() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000L + t.tv_nsec / 1000000L;
+}
+
+static speed_t baudFlag(long baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+  }
+}
+
+static bool openPort(const char* dev, long baud) {
+  speed_t speed = baudFlag(baud);
+  if (!speed) {
+    fprintf(stderr, "baud %ld tidak didukung\n", baud);
+    return false;
+  }
+  port = open(dev, O_RDWR | O_NOCTTY);
+  if (port < 0) {
+    fprintf(stderr, "%s: %s\n", dev, strerror(errno));
+    return false;
+  }
+  struct termios tio;
+  tcgetattr(port, &tio);
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 1;
+  tcsetattr(port, TCSANOW, &tio);
+  tcflush(port, TCIOFLUSH);
+  return true;
+}
+
+static void writeByte(uint8_t b) {
+  if (write(port, &b, 1) != 1) perror("write");
+}
+
+static void textByte(uint8_t c) {
+  if (c == '\r') return;
+  if (c != '\n') {
+    textLine += (char)c;
+    return;
+  }
+  if (logText || verbose) {
+    if (!label.empty()) printf("[%s] ", label.c_str());
+    printf("%s\n", textLine.c_str());
+    fflush(stdout);
+  }
+  textLine.clear();
+}
+
+// Baca port sampai frame dengan cmd `want` datang (atau ERROR), atau waktu habis.
+// want = 0: baca saja sampai waktu habis. Frame LIST dicatat ke params.
+static bool pump(long ms, uint8_t want, TuneParser* reply) {
+  long deadline = nowMs() + ms;
+  while (nowMs() < deadline) {
+    uint8_t buf[64];
+    int n = read(port, buf, sizeof(buf));
+    for (int i = 0; i < n; i++) {
+      bool inFrame = parser.state != 0 || buf[i] == TUNE_SYNC_ROBOT;
+      int r = tune_feed(&parser, buf[i]);
+      if (!inFrame) {
+        if (buf[i] < 0x80) textByte(buf[i]);
+        continue;
+      }
+      if (r <= 0) continue;
+      if (parser.cmd == (TUNE_CMD_LIST | TUNE_REPLY) && parser.len >= 14) {
+        Param p;
+        p.id = parser.payload[0];
+        p.type = parser.payload[1];
+        memcpy(&p.min, parser.payload + 2, 4);
+        memcpy(&p.max, parser.payload + 6, 4);
+        memcpy(&p.value, parser.payload + 10, 4);
+        std::string name((const char*)parser.payload + 14, parser.len - 14);
+        if (!params.count(name)) order.push_back(name);
+        params[name] = p;
+        if (want == parser.cmd) deadline = nowMs() + 300;  // tunggu frame LIST berikutnya
+        continue;
+      }
+      if (want && (parser.cmd == want || parser.cmd == TUNE_CMD_ERROR)) {
+        if (reply) *reply = parser;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static bool request(uint8_t cmd, const uint8_t* payload, uint8_t len, TuneParser* reply, long timeoutMs = 500) {
+  for (int attempt = 0; attempt < 3; attempt++) {
+    tune_send(writeByte, TUNE_SYNC_HOST, cmd, payload, len);
+    if (pump(timeoutMs, cmd | TUNE_REPLY, reply)) {
+      if (reply->cmd == TUNE_CMD_ERROR) {
+        fprintf(stderr, "robot menolak perintah 0x%02X (error %d)\n", reply->payload[1], reply->payload[0]);
+        return false;
+      }
+      return true;
+    }
+  }
+  fprintf(stderr, "tidak ada balasan untuk perintah 0x%02X\n", cmd);
+  return false;
+}
+
+static bool loadList() {
+  params.clear();
+  order.clear();
+  tune_send(writeByte, TUNE_SYNC_HOST, TUNE_CMD_LIST, NULL, 0);
+  pump(1000, TUNE_CMD_LIST | TUNE_REPLY, NULL);
+  if (params.empty()) fprintf(stderr, "robot tidak membalas LIST (baud? firmware?)\n");
+  return !params.empty();
+}
+
+static const Param* findParam(const std::string& name) {
+  if (params.empty() && !loadList()) return NULL;
+  std::map<std::string, Param>::const_iterator it = params.find(name);
+  if (it == params.end()) {
+    fprintf(stderr, "parameter '%s' tidak ada\n", name.c_str());
+    return NULL;
+  }
+  return &it->second;
+}
+
+static bool getParam(const std::string& name, float& value) {
+  const Param* p = findParam(name);
+  if (!p) return false;
+  TuneParser reply;
+  if (!request(TUNE_CMD_GET, &p->id, 1, &reply)) return false;
+  memcpy(&value, reply.payload + 1, 4);
+  return true;
+}
+
+static bool setParam(const std::string& name, float value, float& applied) {
+  const Param* p = findParam(name);
+  if (!p) return false;
+  uint8_t payload[5];
+  payload[0] = p->id;
+  memcpy(payload + 1, &value, 4);
+  TuneParser reply;
+  if (!request(TUNE_CMD_SET, payload, 5, &reply)) return false;
+  memcpy(&applied, reply.payload + 1, 4);
+  return true;
+}
+
+static void waitLogging(double sec) {
+  logText = true;
+  pump((long)(sec * 1000), 0, NULL);
+  logText = false;
+}
+
+// Jalankan satu perintah mulai dari args[i]; i maju melewati argumennya
+static bool runCommand(const std::vector<std::string>& args, size_t& i) {
+  const std::string& cmd = args[i++];
+  size_t need = cmd == "get" ? 1 : cmd == "set" ? 2 : cmd == "wait" ? 1 : cmd == "sweep" ? 5 : 0;
+  if (i + need > args.size()) {
+    fprintf(stderr, "'%s' butuh %zu argumen\n", cmd.c_str(), need);
+    return false;
+  }
+
+  if (cmd == "list") {
+    if (!loadList()) return false;
+    for (size_t k = 0; k < order.size(); k++) {
+      const Param& p = params[order[k]];
+      printf("%-12s %12.4f  [%g .. %g]%s\n", order[k].c_str(), p.value, p.min, p.max,
+             p.type == TUNE_INT ? " int" : "");
+    }
+  } else if (cmd == "get") {
+    float v;
+    if (!getParam(args[i], v)) return false;
+    printf("%s = %.4f\n", args[i].c_str(), v);
+  } else if (cmd == "set") {
+    float applied;
+    if (!setParam(args[i], (float)atof(args[i + 1].c_str()), applied)) return false;
+    printf("%s = %.4f\n", args[i].c_str(), applied);
+  } else if (cmd == "commit") {
+    TuneParser reply;
+    if (!request(TUNE_CMD_COMMIT, NULL, 0, &reply)) return false;
+    printf("commit: %d parameter disimpan ke EEPROM\n", reply.payload[0]);
+  } else if (cmd == "stats") {
+    uint8_t reset = (i < args.size() && args[i] == "reset") ? 1 : 0;
+    TuneParser reply;
+    logText = true;
+    bool ok = request(TUNE_CMD_STATS, &reset, 1, &reply, 2000);
+    logText = false;
+    if (!ok) return false;
+    i += reset;
+  } else if (cmd == "dump") {
+    uint8_t fromEeprom = (i < args.size() && args[i] == "eeprom") ? 1 : 0;
+    TuneParser reply;
+    logText = true;
+    bool ok = request(TUNE_CMD_DUMP, &fromEeprom, 1, &reply, 3000);
+    logText = false;
+    if (!ok) return false;
+    i += fromEeprom;
+  } else if (cmd == "wait") {
+    waitLogging(atof(args[i].c_str()));
+  } else if (cmd == "sweep") {
+    const std::string& name = args[i];
+    float from = atof(args[i + 1].c_str()), to = atof(args[i + 2].c_str());
+    float step = fabsf((float)atof(args[i + 3].c_str()));
+    double dwell = atof(args[i + 4].c_str());
+    float original;
+    if (step <= 0 || !getParam(name, original)) {
+      if (step <= 0) fprintf(stderr, "sweep: langkah harus > 0\n");
+      return false;
+    }
+    int steps = (int)floorf(fabsf(to - from) / step + 1e-4f);
+    float dir = to >= from ? 1 : -1;
+    for (int k = 0; k <= steps; k++) {
+      float applied;
+      if (!setParam(name, from + dir * step * k, applied)) break;
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%s=%g", name.c_str(), applied);
+      label = buf;
+      printf("== %s ==\n", buf);
+      waitLogging(dwell);
+    }
+    label.clear();
+    float applied;
+    setParam(name, original, applied);
+    printf("== %s kembali ke %g ==\n", name.c_str(), applied);
+  } else {
+    fprintf(stderr, "perintah tidak dikenal: %s\n", cmd.c_str());
+    return false;
+  }
+  i += need;
+  return true;
+}
+
+static bool readScript(const char* file, std::vector<std::string>& args) {
+  FILE* fp = fopen(file, "r");
+  if (!fp) {
+    fprintf(stderr, "%s: %s\n", file, strerror(errno));
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), fp)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) args.push_back(tok);
+  }
+  fclose(fp);
+  return true;
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr, "pakai: %s -p port [-b baud] [-w detik] [-v] [-f skrip] perintah...\n", prog);
+}
+
+int main(int argc, char** argv) {
+  const char* dev = NULL;
+  const char* script = NULL;
+  long baud = 9600;
+  double resetWait = 2.0;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:b:w:vf:")) != -1) {
+    if (opt == 'p') dev = optarg;
+    else if (opt == 'b') baud = atol(optarg);
+    else if (opt == 'w') resetWait = atof(optarg);
+    else if (opt == 'v') verbose = true;
+    else if (opt == 'f') script = optarg;
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  std::vector<std::string> args;
+  if (script && !readScript(script, args)) return 2;
+  for (int a = optind; a < argc; a++) args.push_back(argv[a]);
+  if (!dev || args.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (!openPort(dev, baud)) return 1;
+  tune_parser_init(&parser, TUNE_SYNC_ROBOT);
+  pump((long)(resetWait * 1000), 0, NULL);
+
+  for (size_t i = 0; i < args.size();) {
+    if (!runCommand(args, i)) {
+      close(port);
+      return 1;
+    }
+  }
+  close(port);
+  return 0;
+}
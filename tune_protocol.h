@@ -0,0 +1,267 @@
+// ===============================================================
+// tune_protocol.h
+// Protokol biner kecil untuk membaca/mengubah parameter robot lewat
+// Serial saat robot berjalan. Dipakai oleh firmware (line_follower1.c,
+// line_maze1.c) dan tool PC tune_cli.cpp. Hanya C biasa; semua I/O
+// lewat pointer fungsi dari pemanggil.
+//
+// Di AVR tabel TuneParam (nama ikut di dalamnya) harus PROGMEM: entri
+// dibaca satu per satu dengan memcpy_P, jadi tidak memakan SRAM.
+//
+// Frame:  sync, len, cmd, payload[len], crc8(len, cmd, payload)
+//   sync 0xA6 = PC -> robot, 0xA7 = robot -> PC. Keduanya >= 0x80 sehingga
+//   tidak tertukar dengan teks log (ASCII) di port yang sama; frame trace
+//   0xA4 dan byte acak lain tersaring oleh len dan CRC.
+//   Angka float 32 bit little endian (sama di AVR dan PC).
+//
+// Perintah (balasan = cmd | 0x80):
+//   LIST   -                 -> satu frame per parameter: id, tipe, min, max, nilai, nama
+//   GET    id                -> id, nilai
+//   SET    id, nilai         -> id, nilai yang dipakai (sudah dibatasi min/max)
+//   COMMIT -                 -> jumlah parameter yang disimpan ke EEPROM
+//   STATS  [reset]           -> robot mencetak tabel waktu loop sebagai teks,
+//                               lalu balasan kosong (ditangani sketch, bukan tune_handle)
+//   DUMP   [eeprom]          -> robot mencetak rekaman flight_recorder.h sebagai teks
+//                               (RAM, atau salinan EEPROM jika eeprom != 0), lalu balasan kosong
+//   ERROR  (hanya balasan)   -> kode error, cmd asal
+// ===============================================================
+#ifndef TUNE_PROTOCOL_H
+#define TUNE_PROTOCOL_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define TUNE_SYNC_HOST 0xA6
+#define TUNE_SYNC_ROBOT 0xA7
+#define TUNE_MAX_PAYLOAD 32
+
+#define TUNE_CMD_LIST 0x01
+#define TUNE_CMD_GET 0x02
+#define TUNE_CMD_SET 0x03
+#define TUNE_CMD_COMMIT 0x04
+#define TUNE_CMD_STATS 0x05
+#define TUNE_CMD_DUMP 0x06
+#define TUNE_REPLY 0x80
+#define TUNE_CMD_ERROR 0xFF
+
+#define TUNE_ERR_CRC 1
+#define TUNE_ERR_CMD 2
+#define TUNE_ERR_ID 3
+#define TUNE_ERR_LEN 4
+
+#define TUNE_INT 0
+#define TUNE_FLOAT 1
+
+#define TUNE_EEPROM_MAGIC 0x54
+#define TUNE_NAME_MAX 12  // termasuk '\0'
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define TUNE_READ_TABLE memcpy_P
+#else
+#define TUNE_READ_TABLE memcpy
+#endif
+
+typedef struct {
+  char name[TUNE_NAME_MAX];
+  uint8_t type;
+  void *ptr;
+  float min;
+  float max;
+} TuneParam;
+
+typedef struct {
+  uint8_t sync;   // byte sync yang diterima parser ini
+  uint8_t state;
+  uint8_t len;
+  uint8_t cmd;
+  uint8_t pos;
+  uint8_t crc;
+  uint8_t payload[TUNE_MAX_PAYLOAD];
+} TuneParser;
+
+static inline uint8_t tune_crc8(uint8_t crc, uint8_t b) {
+  uint8_t i;
+  crc ^= b;
+  for (i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  return crc;
+}
+
+static inline void tune_parser_init(TuneParser *p, uint8_t sync) {
+  p->sync = sync;
+  p->state = 0;
+}
+
+// Masukkan satu byte. 1 = frame lengkap dan valid (cmd/payload/len siap),
+// -1 = CRC salah, 0 = belum lengkap.
+static inline int tune_feed(TuneParser *p, uint8_t b) {
+  switch (p->state) {
+    case 0:
+      if (b == p->sync) p->state = 1;
+      return 0;
+    case 1:
+      if (b > TUNE_MAX_PAYLOAD) {
+        p->state = (b == p->sync) ? 1 : 0;
+        return 0;
+      }
+      p->len = b;
+      p->pos = 0;
+      p->crc = tune_crc8(0, b);
+      p->state = 2;
+      return 0;
+    case 2:
+      p->cmd = b;
+      p->crc = tune_crc8(p->crc, b);
+      p->state = p->len ? 3 : 4;
+      return 0;
+    case 3:
+      p->payload[p->pos++] = b;
+      p->crc = tune_crc8(p->crc, b);
+      if (p->pos >= p->len) p->state = 4;
+      return 0;
+    default:
+      p->state = 0;
+      return b == p->crc ? 1 : -1;
+  }
+}
+
+static inline void tune_send(void (*write)(uint8_t), uint8_t sync, uint8_t cmd, const uint8_t *payload, uint8_t len) {
+  uint8_t crc = tune_crc8(0, len);
+  uint8_t i;
+  crc = tune_crc8(crc, cmd);
+  write(sync);
+  write(len);
+  write(cmd);
+  for (i = 0; i < len; i++) {
+    write(payload[i]);
+    crc = tune_crc8(crc, payload[i]);
+  }
+  write(crc);
+}
+
+// Salin entri i dari tabel parameter (flash di AVR)
+static inline void tune_entry(const TuneParam *params, uint8_t i, TuneParam *out) {
+  TUNE_READ_TABLE(out, &params[i], sizeof(TuneParam));
+}
+
+static inline float tune_get(const TuneParam *p) {
+  return p->type == TUNE_INT ? (float)*(int *)p->ptr : *(float *)p->ptr;
+}
+
+static inline float tune_set(const TuneParam *p, float v) {
+  if (v < p->min) v = p->min;
+  if (v > p->max) v = p->max;
+  if (p->type == TUNE_INT) *(int *)p->ptr = (int)(v < 0 ? v - 0.5f : v + 0.5f);
+  else *(float *)p->ptr = v;
+  return tune_get(p);
+}
+
+static inline void tune_error(void (*write)(uint8_t), uint8_t code, uint8_t cmd) {
+  uint8_t e[2];
+  e[0] = code;
+  e[1] = cmd;
+  tune_send(write, TUNE_SYNC_ROBOT, TUNE_CMD_ERROR, e, 2);
+}
+
+// Sisi robot: jalankan frame yang baru lengkap dari tune_feed()
+static inline void tune_handle(const TuneParser *f, const TuneParam *params, uint8_t count,
+                               void (*write)(uint8_t), void (*commit)(void)) {
+  uint8_t out[TUNE_MAX_PAYLOAD];
+  uint8_t id = f->len > 0 ? f->payload[0] : 0xFF;
+  TuneParam p;
+  float v;
+  uint8_t i, n;
+
+  switch (f->cmd) {
+    case TUNE_CMD_LIST:
+      for (i = 0; i < count; i++) {
+        tune_entry(params, i, &p);
+        out[0] = i;
+        out[1] = p.type;
+        memcpy(out + 2, &p.min, 4);
+        memcpy(out + 6, &p.max, 4);
+        v = tune_get(&p);
+        memcpy(out + 10, &v, 4);
+        n = (uint8_t)strnlen(p.name, TUNE_NAME_MAX);
+        memcpy(out + 14, p.name, n);
+        tune_send(write, TUNE_SYNC_ROBOT, TUNE_CMD_LIST | TUNE_REPLY, out, 14 + n);
+      }
+      return;
+
+    case TUNE_CMD_GET:
+    case TUNE_CMD_SET:
+      if (f->len != (f->cmd == TUNE_CMD_GET ? 1 : 5)) {
+        tune_error(write, TUNE_ERR_LEN, f->cmd);
+        return;
+      }
+      if (id >= count) {
+        tune_error(write, TUNE_ERR_ID, f->cmd);
+        return;
+      }
+      tune_entry(params, id, &p);
+      if (f->cmd == TUNE_CMD_SET) {
+        memcpy(&v, f->payload + 1, 4);
+        v = tune_set(&p, v);
+      } else {
+        v = tune_get(&p);
+      }
+      out[0] = id;
+      memcpy(out + 1, &v, 4);
+      tune_send(write, TUNE_SYNC_ROBOT, f->cmd | TUNE_REPLY, out, 5);
+      return;
+
+    case TUNE_CMD_COMMIT:
+      commit();
+      out[0] = count;
+      tune_send(write, TUNE_SYNC_ROBOT, TUNE_CMD_COMMIT | TUNE_REPLY, out, 1);
+      return;
+
+    default:
+      tune_error(write, TUNE_ERR_CMD, f->cmd);
+  }
+}
+
+// Simpan semua nilai ke EEPROM mulai alamat base: magic, jumlah, float..., crc
+static inline void tune_save(const TuneParam *params, uint8_t count, int base,
+                             void (*write)(int, uint8_t)) {
+  uint8_t crc = 0;
+  uint8_t i, k;
+  write(base, TUNE_EEPROM_MAGIC);
+  write(base + 1, count);
+  for (i = 0; i < count; i++) {
+    TuneParam p;
+    float v;
+    uint8_t b[4];
+    tune_entry(params, i, &p);
+    v = tune_get(&p);
+    memcpy(b, &v, 4);
+    for (k = 0; k < 4; k++) {
+      write(base + 2 + i * 4 + k, b[k]);
+      crc = tune_crc8(crc, b[k]);
+    }
+  }
+  write(base + 2 + count * 4, crc);
+}
+
+// Muat nilai dari EEPROM; 0 jika belum pernah disimpan atau daftar parameter berubah
+static inline int tune_load(const TuneParam *params, uint8_t count, int base,
+                            uint8_t (*read)(int)) {
+  uint8_t crc = 0;
+  int i;
+  if (read(base) != TUNE_EEPROM_MAGIC || read(base + 1) != count) return 0;
+  for (i = 0; i < count * 4; i++) crc = tune_crc8(crc, read(base + 2 + i));
+  if (crc != read(base + 2 + count * 4)) return 0;
+  for (i = 0; i < count; i++) {
+    uint8_t b[4];
+    float v;
+    int k;
+    TuneParam p;
+    for (k = 0; k < 4; k++) b[k] = read(base + 2 + i * 4 + k);
+    memcpy(&v, b, 4);
+    tune_entry(params, (uint8_t)i, &p);
+    tune_set(&p, v);
+  }
+  return 1;
+}
+
+#endif
@@ -0,0 +1,500 @@
+// ===============================================================
+// webots_host.cpp
+// Pengganti Webots di PC: dunia kinematik kecil untuk menjalankan
+// benchmark_supervisor.c beserta controller robot (line_follower.c,
+// "kode webot line maze.c", sil_webots.cpp) tanpa Webots, mis. untuk
+// membuat benchmark/baseline.csv atau membandingkan dua versi controller.
+//
+// Ini bukan simulasi fisika: roda tidak slip, motor langsung mencapai
+// kecepatan perintah, dan sensor IR membaca lantai tepat di bawahnya
+// tanpa derau (derau benchmark datang dari sensor_noise.h di controller).
+// Angka dari sini hanya bisa dibandingkan dengan angka dari sini juga.
+//
+// Seperti di Webots, supervisor dan controller adalah proses terpisah.
+// Proses supervisor memegang dunia; saat field controller diganti atau
+// controller di-restart, dunia menjalankan <folder>/<nama controller>
+// dengan controllerArgs. Keduanya bergantian per langkah lewat pipe,
+// jadi hasilnya deterministik.
+//
+// Kompilasi (dari root repo, setelah mkdir bench):
+//   g++ -O2 -Iwebots_host -o bench/benchmark_supervisor -x c benchmark_supervisor.c -x c++ webots_host.cpp
+//   g++ -O2 -Iwebots_host -o bench/line_follower -x c line_follower.c -x c++ webots_host.cpp
+//   g++ -O2 -Iwebots_host -o bench/line_maze -x c "kode webot line maze.c" -x c++ webots_host.cpp
+// Pakai:
+//   bench/benchmark_supervisor --suite=benchmark/suite.txt [--perbarui]
+//
+// Lingkungan (opsional):
+//   WBHOST_CONTROLLERS  folder binary controller (default: folder binary supervisor)
+//   WBHOST_ARGS         argumen tambahan untuk controller, dipisah spasi (mis. --governor)
+//   WBHOST_STEP         basic time step dalam ms (default 8)
+//   WBHOST_IR_FLOOR     bacaan IR di lantai (default 100)
+//   WBHOST_IR_LINE      bacaan IR tepat di atas garis (default 900)
+//
+// Robot mengikuti konstanta di "kode webot line maze.c": roda r = 20 mm,
+// jarak roda 100 mm, kecepatan motor maks 20 rad/s, ir1..ir8 berjarak
+// 12 mm dalam satu baris 60 mm di depan poros, ir1 paling kanan. Lantai
+// terang dengan strip Box hitam yang di-import supervisor (DEF ROBOT).
+// ===============================================================
+#include "webots_host.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#define IR_COUNT 8
+#define WHEEL_RADIUS 0.02
+#define AXLE_TRACK 0.10
+#define MAX_VELOCITY 20.0
+#define SENSOR_AHEAD 0.06
+#define SENSOR_PITCH 0.012
+#define SENSOR_SPOT 0.003  // sigma titik baca IR di lantai (m)
+#define IR_MAX 1000.0
+
+enum { DEV_NONE, DEV_IR1, DEV_MOTOR = DEV_IR1 + IR_COUNT, DEV_WHEEL = DEV_MOTOR + 2, DEV_COUNT = DEV_WHEEL + 2 };
+
+// Satu langkah controller: permintaan ke dunia, lalu balasan setelah waktunya lewat
+struct StepRequest {
+  int ms;
+  double velocity[2];
+};
+
+struct StepReply {
+  double time;
+  double basicStep;
+  double ir[IR_COUNT];
+  double wheel[2];
+};
+
+struct Strip {
+  double x1, y1, x2, y2, width;
+};
+
+// ---------- keadaan ----------
+// remote = proses ini controller yang dijalankan dunia di proses lain
+static bool remote = false;
+static int toWorld = -1, fromWorld = -1;
+static StepReply lastReply;
+static double velocityCmd[2];
+
+// Dunia (hanya di proses supervisor)
+static int stepMs = 8;
+static long timeMs = 0;
+static double irFloor = 100, irLine = 900;
+static double robotX = 0, robotY = 0, robotZ = 0, robotYaw = 0;
+static double wheelAngle[2];
+static std::vector<Strip> strips;
+static std::string trackDef;
+static bool quitRequested = false;
+static int quitStatus = 0;
+
+static std::string controllerName;
+static std::vector<std::string> controllerArgs;
+static std::string controllersDir;
+static bool restartPending = false;
+static pid_t child = 0;
+static int toChild = -1, fromChild = -1;
+static bool childWaiting = false;  // anak sedang menunggu balasan langkahnya
+static long childWake = 0;
+
+static bool writeAll(int fd, const void *buf, size_t n) {
+  const char *p = (const char *)buf;
+  while (n > 0) {
+    ssize_t k = write(fd, p, n);
+    if (k <= 0) return false;
+    p += k;
+    n -= k;
+  }
+  return true;
+}
+
+static bool readAll(int fd, void *buf, size_t n) {
+  char *p = (char *)buf;
+  while (n > 0) {
+    ssize_t k = read(fd, p, n);
+    if (k <= 0) return false;
+    p += k;
+    n -= k;
+  }
+  return true;
+}
+
+// ========== DUNIA ==========
+
+static double segmentDistance(const Strip &s, double px, double py) {
+  double dx = s.x2 - s.x1, dy = s.y2 - s.y1, l2 = dx * dx + dy * dy;
+  double u = l2 > 0 ? ((px - s.x1) * dx + (py - s.y1) * dy) / l2 : 0;
+  if (u < 0) u = 0;
+  if (u > 1) u = 1;
+  return hypot(px - (s.x1 + u * dx), py - (s.y1 + u * dy));
+}
+
+static double normalCdf(double z) { return 0.5 * erfc(-z / sqrt(2.0)); }
+
+// Bagian titik baca yang menutupi garis (0..1), strip terdekat yang menang
+static double irValue(int i) {
+  double lateral = (i - (IR_COUNT - 1) / 2.0) * SENSOR_PITCH;  // + = kiri
+  double c = cos(robotYaw), s = sin(robotYaw);
+  double px = robotX + SENSOR_AHEAD * c - lateral * s;
+  double py = robotY + SENSOR_AHEAD * s + lateral * c;
+  double cover = 0;
+  for (const Strip &t : strips) {
+    double d = segmentDistance(t, px, py);
+    double k = normalCdf((t.width / 2 - d) / SENSOR_SPOT) - normalCdf((-t.width / 2 - d) / SENSOR_SPOT);
+    if (k > cover) cover = k;
+  }
+  return irFloor + (irLine - irFloor) * cover;
+}
+
+static void fillReply(StepReply *r) {
+  r->time = timeMs / 1000.0;
+  r->basicStep = stepMs;
+  for (int i = 0; i < IR_COUNT; i++) r->ir[i] = irValue(i);
+  r->wheel[0] = wheelAngle[0];
+  r->wheel[1] = wheelAngle[1];
+}
+
+static void integrate(double dt) {
+  double v = WHEEL_RADIUS * (velocityCmd[0] + velocityCmd[1]) / 2;
+  double w = WHEEL_RADIUS * (velocityCmd[1] - velocityCmd[0]) / AXLE_TRACK;  // kiri lebih cepat -> belok kanan
+  if (fabs(w) > 1e-9) {
+    double yaw = robotYaw + w * dt;
+    robotX += v / w * (sin(yaw) - sin(robotYaw));
+    robotY -= v / w * (cos(yaw) - cos(robotYaw));
+    robotYaw = yaw;
+  } else {
+    robotX += v * dt * cos(robotYaw);
+    robotY += v * dt * sin(robotYaw);
+  }
+  wheelAngle[0] += velocityCmd[0] * dt;
+  wheelAngle[1] += velocityCmd[1] * dt;
+}
+
+static void setVelocity(int w, double v) {
+  if (v > MAX_VELOCITY) v = MAX_VELOCITY;
+  if (v < -MAX_VELOCITY) v = -MAX_VELOCITY;
+  velocityCmd[w] = v;
+}
+
+// ========== CONTROLLER ANAK ==========
+
+static void closeChild() {
+  close(toChild);
+  close(fromChild);
+  toChild = fromChild = -1;
+  waitpid(child, NULL, 0);
+  child = 0;
+}
+
+static void killChild() {
+  if (!child) return;
+  kill(child, SIGKILL);
+  closeChild();
+}
+
+static void spawnChild() {
+  int down[2], up[2];
+  std::string path = controllersDir + "/" + controllerName;
+  std::vector<std::string> args = controllerArgs;
+  const char *extra = getenv("WBHOST_ARGS");
+  if (extra) {
+    std::string s(extra);
+    size_t a = 0;
+    while ((a = s.find_first_not_of(' ', a)) != std::string::npos) {
+      size_t b = s.find(' ', a);
+      args.push_back(s.substr(a, b == std::string::npos ? std::string::npos : b - a));
+      a = b;
+    }
+  }
+  if (pipe2(down, O_CLOEXEC) != 0 || pipe2(up, O_CLOEXEC) != 0) {
+    perror("[WBHOST] pipe");
+    exit(1);
+  }
+  fflush(stdout);
+  fflush(stderr);
+  child = fork();
+  if (child == 0) {
+    char fds[32];
+    std::vector<char *> argv;
+    fcntl(down[0], F_SETFD, 0);
+    fcntl(up[1], F_SETFD, 0);
+    snprintf(fds, sizeof(fds), "%d,%d", down[0], up[1]);
+    setenv("WBHOST_FD", fds, 1);
+    argv.push_back((char *)controllerName.c_str());
+    for (std::string &a : args) argv.push_back((char *)a.c_str());
+    argv.push_back(NULL);
+    execv(path.c_str(), argv.data());
+    fprintf(stderr, "[WBHOST] controller %s tidak bisa dijalankan\n", path.c_str());
+    _exit(127);
+  }
+  close(down[0]);
+  close(up[1]);
+  toChild = down[1];
+  fromChild = up[0];
+
+  // Controller baru mulai dengan motor diam dan bacaan sensor saat ini
+  velocityCmd[0] = velocityCmd[1] = 0;
+  StepReply r;
+  fillReply(&r);
+  childWaiting = false;
+  childWake = timeMs;
+  if (!writeAll(toChild, &r, sizeof(r))) closeChild();
+}
+
+// Kirim balasan langkah yang sudah jatuh tempo, lalu tunggu langkah berikutnya
+static void serveChild() {
+  StepRequest q;
+  if (childWaiting) {
+    StepReply r;
+    fillReply(&r);
+    if (!writeAll(toChild, &r, sizeof(r))) {
+      closeChild();
+      return;
+    }
+  }
+  if (!readAll(fromChild, &q, sizeof(q))) {  // controller selesai
+    closeChild();
+    return;
+  }
+  setVelocity(0, q.velocity[0]);
+  setVelocity(1, q.velocity[1]);
+  childWake = timeMs + (q.ms > stepMs ? (q.ms + stepMs - 1) / stepMs * stepMs : stepMs);
+  childWaiting = true;
+}
+
+// ========== ROBOT ==========
+
+void wb_robot_init(void) {
+  const char *fd = getenv("WBHOST_FD");
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  if (fd && sscanf(fd, "%d,%d", &fromWorld, &toWorld) == 2) {
+    remote = true;
+    if (!readAll(fromWorld, &lastReply, sizeof(lastReply))) exit(1);
+    return;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  if (getenv("WBHOST_STEP")) stepMs = atoi(getenv("WBHOST_STEP"));
+  if (stepMs <= 0) stepMs = 8;
+  if (getenv("WBHOST_IR_FLOOR")) irFloor = atof(getenv("WBHOST_IR_FLOOR"));
+  if (getenv("WBHOST_IR_LINE")) irLine = atof(getenv("WBHOST_IR_LINE"));
+  if (getenv("WBHOST_CONTROLLERS")) {
+    controllersDir = getenv("WBHOST_CONTROLLERS");
+  } else {
+    char exe[512];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    exe[n > 0 ? n : 0] = '\0';
+    char *slash = strrchr(exe, '/');
+    controllersDir = slash ? std::string(exe, slash - exe) : ".";
+  }
+}
+
+int wb_robot_step(int duration) {
+  if (remote) {
+    StepRequest q = {duration, {velocityCmd[0], velocityCmd[1]}};
+    if (!writeAll(toWorld, &q, sizeof(q)) || !readAll(fromWorld, &lastReply, sizeof(lastReply))) return -1;
+    return 0;
+  }
+  if (quitRequested) return -1;
+  if (restartPending) {
+    killChild();
+    if (!controllerName.empty()) spawnChild();
+    restartPending = false;
+  }
+  long target = timeMs + (duration > stepMs ? (duration + stepMs - 1) / stepMs * stepMs : stepMs);
+  while (timeMs < target) {
+    if (child && childWake <= timeMs) serveChild();
+    integrate(stepMs / 1000.0);
+    timeMs += stepMs;
+  }
+  return 0;
+}
+
+void wb_robot_cleanup(void) {
+  if (remote) {
+    close(toWorld);
+    close(fromWorld);
+    return;
+  }
+  killChild();
+  fflush(stdout);
+  if (quitRequested) exit(quitStatus);
+}
+
+double wb_robot_get_time(void) { return remote ? lastReply.time : timeMs / 1000.0; }
+
+double wb_robot_get_basic_time_step(void) { return remote ? lastReply.basicStep : stepMs; }
+
+WbDeviceTag wb_robot_get_device(const char *name) {
+  if (strncmp(name, "ir", 2) == 0 && name[2] >= '1' && name[2] < '1' + IR_COUNT && !name[3])
+    return DEV_IR1 + name[2] - '1';
+  if (strcmp(name, "motorkiri") == 0) return DEV_MOTOR;
+  if (strcmp(name, "motorkanan") == 0) return DEV_MOTOR + 1;
+  return DEV_NONE;
+}
+
+// ---------- motor / position_sensor ----------
+
+void wb_motor_set_position(WbDeviceTag, double) {}  // selalu mode kecepatan (posisi INFINITY)
+
+void wb_motor_set_velocity(WbDeviceTag tag, double velocity) {
+  if (tag >= DEV_MOTOR && tag < DEV_MOTOR + 2) setVelocity(tag - DEV_MOTOR, velocity);
+}
+
+double wb_motor_get_max_velocity(WbDeviceTag) { return MAX_VELOCITY; }
+
+WbDeviceTag wb_motor_get_position_sensor(WbDeviceTag tag) {
+  return tag >= DEV_MOTOR && tag < DEV_MOTOR + 2 ? DEV_WHEEL + tag - DEV_MOTOR : DEV_NONE;
+}
+
+void wb_position_sensor_enable(WbDeviceTag, int) {}
+
+double wb_position_sensor_get_value(WbDeviceTag tag) {
+  if (tag < DEV_WHEEL || tag >= DEV_COUNT) return NAN;
+  return remote ? lastReply.wheel[tag - DEV_WHEEL] : wheelAngle[tag - DEV_WHEEL];
+}
+
+// ---------- distance_sensor ----------
+
+void wb_distance_sensor_enable(WbDeviceTag, int) {}
+
+double wb_distance_sensor_get_value(WbDeviceTag tag) {
+  if (tag < DEV_IR1 || tag >= DEV_IR1 + IR_COUNT) return NAN;
+  return remote ? lastReply.ir[tag - DEV_IR1] : irValue(tag - DEV_IR1);
+}
+
+double wb_distance_sensor_get_min_value(WbDeviceTag) { return 0; }
+
+double wb_distance_sensor_get_max_value(WbDeviceTag) { return IR_MAX; }
+
+// ---------- camera ----------
+
+void wb_camera_enable(WbDeviceTag, int) {}
+const unsigned char *wb_camera_get_image(WbDeviceTag) { return NULL; }
+int wb_camera_get_width(WbDeviceTag) { return 0; }
+int wb_camera_get_height(WbDeviceTag) { return 0; }
+double wb_camera_get_fov(WbDeviceTag) { return 0; }
+
+// ========== SUPERVISOR ==========
+// Node dan field hanya alamat penanda; yang dikenal hanya yang dipakai
+// benchmark_supervisor.c: root.children, robot.{controller, controllerArgs,
+// translation, rotation} dan satu Group lintasan hasil import.
+
+static char nodeRoot, nodeRobot, nodeTrack;
+static char fieldChildren, fieldController, fieldArgs, fieldTranslation, fieldRotation;
+
+WbNodeRef wb_supervisor_node_get_root(void) { return remote ? NULL : (WbNodeRef)&nodeRoot; }
+
+WbNodeRef wb_supervisor_node_get_from_def(const char *def) {
+  const char *robot = getenv("WBHOST_ROBOT") ? getenv("WBHOST_ROBOT") : "ROBOT";
+  if (remote) return NULL;
+  if (strcmp(def, robot) == 0) return (WbNodeRef)&nodeRobot;
+  if (!trackDef.empty() && trackDef == def) return (WbNodeRef)&nodeTrack;
+  return NULL;
+}
+
+WbFieldRef wb_supervisor_node_get_field(WbNodeRef node, const char *name) {
+  if (node == (WbNodeRef)&nodeRoot && strcmp(name, "children") == 0) return (WbFieldRef)&fieldChildren;
+  if (node != (WbNodeRef)&nodeRobot) return NULL;
+  if (strcmp(name, "controller") == 0) return (WbFieldRef)&fieldController;
+  if (strcmp(name, "controllerArgs") == 0) return (WbFieldRef)&fieldArgs;
+  if (strcmp(name, "translation") == 0) return (WbFieldRef)&fieldTranslation;
+  if (strcmp(name, "rotation") == 0) return (WbFieldRef)&fieldRotation;
+  return NULL;
+}
+
+const double *wb_supervisor_node_get_position(WbNodeRef) {
+  static double p[3];
+  p[0] = robotX;
+  p[1] = robotY;
+  p[2] = robotZ;
+  return p;
+}
+
+const double *wb_supervisor_node_get_orientation(WbNodeRef) {
+  static double m[9];
+  double c = cos(robotYaw), s = sin(robotYaw);
+  double r[9] = {c, -s, 0, s, c, 0, 0, 0, 1};
+  memcpy(m, r, sizeof(m));
+  return m;
+}
+
+void wb_supervisor_node_remove(WbNodeRef node) {
+  if (node != (WbNodeRef)&nodeTrack) return;
+  strips.clear();
+  trackDef.clear();
+}
+
+void wb_supervisor_node_reset_physics(WbNodeRef) {}  // kinematik: tidak ada momentum
+
+void wb_supervisor_node_restart_controller(WbNodeRef) { restartPending = true; }
+
+int wb_supervisor_field_get_count(WbFieldRef field) {
+  return field == (WbFieldRef)&fieldArgs ? (int)controllerArgs.size() : -1;
+}
+
+void wb_supervisor_field_remove_mf(WbFieldRef field, int index) {
+  if (field == (WbFieldRef)&fieldArgs && index >= 0 && index < (int)controllerArgs.size())
+    controllerArgs.erase(controllerArgs.begin() + index);
+}
+
+void wb_supervisor_field_insert_mf_string(WbFieldRef field, int index, const char *value) {
+  if (field != (WbFieldRef)&fieldArgs) return;
+  if (index < 0 || index > (int)controllerArgs.size()) index = controllerArgs.size();
+  controllerArgs.insert(controllerArgs.begin() + index, value);
+}
+
+// Hanya Solid { translation x y z rotation 0 0 1 a ... Box { size l w h } }
+// yang dibaca: tiap Solid jadi satu strip garis
+void wb_supervisor_field_import_mf_node_from_string(WbFieldRef field, int, const char *s) {
+  const char *def = strstr(s, "DEF "), *p = s;
+  char name[64];
+  if (field != (WbFieldRef)&fieldChildren) return;
+  if (def && sscanf(def + 4, "%63s", name) == 1) trackDef = name;
+  while ((p = strstr(p, "Solid {")) != NULL) {
+    const char *t = strstr(p, "translation"), *r = strstr(p, "rotation"), *z = strstr(p, "size");
+    double tx, ty, tz, ax, ay, az, a, l, w, h;
+    if (!t || !r || !z || sscanf(t + 11, "%lf %lf %lf", &tx, &ty, &tz) != 3 ||
+        sscanf(r + 8, "%lf %lf %lf %lf", &ax, &ay, &az, &a) != 4 || sscanf(z + 4, "%lf %lf %lf", &l, &w, &h) != 3)
+      break;
+    if (az < 0) a = -a;
+    strips.push_back({tx - l / 2 * cos(a), ty - l / 2 * sin(a), tx + l / 2 * cos(a), ty + l / 2 * sin(a), w});
+    p = z;
+  }
+}
+
+const char *wb_supervisor_field_get_sf_string(WbFieldRef field) {
+  return field == (WbFieldRef)&fieldController ? controllerName.c_str() : "";
+}
+
+void wb_supervisor_field_set_sf_string(WbFieldRef field, const char *value) {
+  if (field != (WbFieldRef)&fieldController) return;
+  controllerName = value;
+  restartPending = true;
+}
+
+const double *wb_supervisor_field_get_sf_vec3f(WbFieldRef field) {
+  return field == (WbFieldRef)&fieldTranslation ? wb_supervisor_node_get_position(NULL) : NULL;
+}
+
+void wb_supervisor_field_set_sf_vec3f(WbFieldRef field, const double values[3]) {
+  if (field != (WbFieldRef)&fieldTranslation) return;
+  robotX = values[0];
+  robotY = values[1];
+  robotZ = values[2];
+}
+
+void wb_supervisor_field_set_sf_rotation(WbFieldRef field, const double values[4]) {
+  if (field == (WbFieldRef)&fieldRotation) robotYaw = values[2] < 0 ? -values[3] : values[3];
+}
+
+void wb_supervisor_simulation_quit(int status) {
+  quitRequested = true;
+  quitStatus = status;
+}
@@ -0,0 +1,81 @@
+// ===============================================================
+// webots_host.h
+// Deklarasi bagian API C Webots yang dipakai controller di repo ini
+// (robot, motor, distance_sensor, position_sensor, camera, supervisor).
+// Implementasinya webots_host.cpp: dunia kinematik kecil di PC untuk
+// menjalankan benchmark_supervisor.c dan controller tanpa Webots.
+//
+// Controller tetap menulis #include <webots/robot.h> dst; folder
+// webots_host/ berisi header-header itu dan semuanya menunjuk ke sini:
+//
+//   g++ -Iwebots_host ... controller.c webots_host.cpp
+// ===============================================================
+#ifndef WEBOTS_HOST_H
+#define WEBOTS_HOST_H
+
+#include <math.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned short WbDeviceTag;  // 0 = perangkat tidak ada
+typedef struct WbNodeStructPrivate *WbNodeRef;
+typedef struct WbFieldStructPrivate *WbFieldRef;
+
+// ---------- robot ----------
+void wb_robot_init(void);
+int wb_robot_step(int duration);
+void wb_robot_cleanup(void);
+double wb_robot_get_time(void);
+double wb_robot_get_basic_time_step(void);
+WbDeviceTag wb_robot_get_device(const char *name);
+
+// ---------- motor / position_sensor ----------
+void wb_motor_set_position(WbDeviceTag tag, double position);
+void wb_motor_set_velocity(WbDeviceTag tag, double velocity);
+double wb_motor_get_max_velocity(WbDeviceTag tag);
+WbDeviceTag wb_motor_get_position_sensor(WbDeviceTag tag);
+void wb_position_sensor_enable(WbDeviceTag tag, int sampling_period);
+double wb_position_sensor_get_value(WbDeviceTag tag);
+
+// ---------- distance_sensor ----------
+void wb_distance_sensor_enable(WbDeviceTag tag, int sampling_period);
+double wb_distance_sensor_get_value(WbDeviceTag tag);
+double wb_distance_sensor_get_min_value(WbDeviceTag tag);
+double wb_distance_sensor_get_max_value(WbDeviceTag tag);
+
+// ---------- camera (tidak ada di dunia host) ----------
+void wb_camera_enable(WbDeviceTag tag, int sampling_period);
+const unsigned char *wb_camera_get_image(WbDeviceTag tag);
+int wb_camera_get_width(WbDeviceTag tag);
+int wb_camera_get_height(WbDeviceTag tag);
+double wb_camera_get_fov(WbDeviceTag tag);
+#define wb_camera_image_get_gray(image, width, x, y) ((image)[4 * ((y) * (width) + (x))])
+
+// ---------- supervisor ----------
+WbNodeRef wb_supervisor_node_get_root(void);
+WbNodeRef wb_supervisor_node_get_from_def(const char *def);
+WbFieldRef wb_supervisor_node_get_field(WbNodeRef node, const char *name);
+const double *wb_supervisor_node_get_position(WbNodeRef node);
+const double *wb_supervisor_node_get_orientation(WbNodeRef node);
+void wb_supervisor_node_remove(WbNodeRef node);
+void wb_supervisor_node_reset_physics(WbNodeRef node);
+void wb_supervisor_node_restart_controller(WbNodeRef node);
+int wb_supervisor_field_get_count(WbFieldRef field);
+void wb_supervisor_field_remove_mf(WbFieldRef field, int index);
+void wb_supervisor_field_insert_mf_string(WbFieldRef field, int index, const char *value);
+void wb_supervisor_field_import_mf_node_from_string(WbFieldRef field, int position, const char *node_string);
+const char *wb_supervisor_field_get_sf_string(WbFieldRef field);
+void wb_supervisor_field_set_sf_string(WbFieldRef field, const char *value);
+const double *wb_supervisor_field_get_sf_vec3f(WbFieldRef field);
+void wb_supervisor_field_set_sf_vec3f(WbFieldRef field, const double values[3]);
+void wb_supervisor_field_set_sf_rotation(WbFieldRef field, const double values[4]);
+void wb_supervisor_simulation_quit(int status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,2 @@
+// Lihat webots_host.h (build host tanpa Webots)
+#include "../../webots_host.h"